@@ -0,0 +1,101 @@
+#include <ResRenderer.hpp>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace ResRenderer;
+
+//Records a 50k draw scene into one command list per thread, reports recording time per thread count,
+//and the cost of submitting the recorded lists.
+
+static const int Draws = 50000;
+static const int Repeats = 20;
+
+int main() {
+	Init();
+	Window window;
+	CreateResWindow(800, 600, "Benchmark", &window);
+
+	Mesh mesh;
+	CreateMesh(&mesh);
+	MeshData meshData;
+	MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 3, false);
+	float vertices[] = { 0.5f, -0.5f, 0.0f, -0.5f, -0.5f, 0.0f, 0.0f, 0.5f, 0.0f };
+	VertexIndex_t indicies[] = { 0, 1, 2 };
+	meshData.data = vertices;
+	meshData.dataSize = sizeof(vertices);
+	meshData.vertCount = 3;
+	meshData.indicies = indicies;
+	meshData.indiciesCount = 3;
+	UploadMeshData(mesh, &meshData);
+
+	Shader shader;
+	CreateShader(&shader);
+	CompileShader(shader, "", nullptr, 0, nullptr);
+	int location;
+	GetUniformLocation(shader, "_Tint", &location);
+
+	int maxThreads = static_cast<int>(thread::hardware_concurrency());
+	if (maxThreads <= 0)
+		maxThreads = 1;
+	vector<int> threadCounts;
+	for (int t = 1; t < maxThreads; t *= 2)
+		threadCounts.push_back(t);
+	threadCounts.push_back(maxThreads);
+
+	cout << "threads\trecord ms\tMdraws/s\tsubmit ms" << endl;
+	for (auto threads : threadCounts)
+	{
+		vector<CommandList> lists(threads);
+		for (auto& list : lists)
+			CreateCommandList(&list);
+
+		double recordSeconds = 0.0, submitSeconds = 0.0;
+		for (int repeat = 0; repeat < Repeats; repeat++)
+		{
+			atomic<int> ready(0);
+			vector<thread> workers;
+			auto start = chrono::steady_clock::now();
+			for (int t = 0; t < threads; t++)
+			{
+				workers.emplace_back([&, t] {
+					ready++;
+					while (ready.load() < threads) {}
+					auto list = lists[t];
+					ResetCommandList(list);
+					int begin = Draws * t / threads;
+					int end = Draws * (t + 1) / threads;
+					CmdUseShader(list, shader);
+					for (int i = begin; i < end; i++)
+					{
+						CmdSetUniformVec(list, shader, location, Color(static_cast<float>(i), 0.0f, 0.0f, 1.0f));
+						CmdDrawMesh(list, mesh);
+					}
+				});
+			}
+			for (auto& w : workers)
+				w.join();
+			auto recorded = chrono::steady_clock::now();
+			SubmitCommandLists(lists.data(), threads);
+			auto submitted = chrono::steady_clock::now();
+			recordSeconds += chrono::duration<double>(recorded - start).count();
+			submitSeconds += chrono::duration<double>(submitted - recorded).count();
+		}
+
+		cout << threads << "\t"
+			<< recordSeconds * 1000.0 / Repeats << "\t"
+			<< Draws * Repeats / recordSeconds / 1e6 << "\t"
+			<< submitSeconds * 1000.0 / Repeats << endl;
+
+		for (auto list : lists)
+			DestroyCommandList(list);
+	}
+
+	DestroyShader(shader);
+	DestroyMesh(mesh);
+	Terminate();
+	return 0;
+}
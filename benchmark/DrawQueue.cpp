@@ -0,0 +1,83 @@
+#include <ResRenderer.hpp>
+#include <ResRendererNull.hpp>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace ResRenderer;
+
+//Submits 100k draws spread over 50 shaders and 500 meshes in random order, directly and through a draw queue,
+//and reports state switches and time for both.
+
+static const int Draws = 100000;
+static const int Shaders = 50;
+static const int Meshes = 500;
+static const int Repeats = 10;
+
+struct Draw {
+	int shader;
+	int mesh;
+	float depth;
+};
+
+int main() {
+	Init();
+	Window window;
+	CreateResWindow(800, 600, "Benchmark", &window);
+
+	vector<Shader> shaders(Shaders);
+	for (auto& shader : shaders)
+		CreateShader(&shader);
+	vector<Mesh> meshes(Meshes);
+	for (auto& mesh : meshes)
+		CreateMesh(&mesh);
+
+	mt19937 random(1234);
+	uniform_int_distribution<int> shaderDist(0, Shaders - 1), meshDist(0, Meshes - 1);
+	uniform_real_distribution<float> depthDist(0.0f, 1.0f);
+	vector<Draw> draws(Draws);
+	for (auto& draw : draws)
+		draw = Draw{ shaderDist(random), meshDist(random), depthDist(random) };
+
+	double directSeconds = 0.0;
+	for (int repeat = 0; repeat < Repeats; repeat++)
+	{
+		auto start = chrono::steady_clock::now();
+		for (auto& draw : draws)
+		{
+			UseShader(shaders[draw.shader]);
+			DrawMesh(meshes[draw.mesh]);
+		}
+		directSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	}
+
+	DrawQueue queue;
+	CreateDrawQueue(&queue);
+	DrawQueueStats stats;
+	double queueSeconds = 0.0, sortMilliseconds = 0.0;
+	for (int repeat = 0; repeat < Repeats; repeat++)
+	{
+		auto start = chrono::steady_clock::now();
+		for (auto& draw : draws)
+			QueueDrawMesh(queue, nullptr, shaders[draw.shader], meshes[draw.mesh], draw.depth);
+		SubmitDrawQueue(queue, &stats);
+		queueSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		sortMilliseconds += stats.sortMilliseconds;
+	}
+	DestroyDrawQueue(queue);
+
+	cout << "mode\tshader switches\tmesh switches\tsort ms\ttotal ms" << endl;
+	cout << "unsorted\t" << stats.unsortedShaderSwitches << "\t" << stats.unsortedMeshSwitches << "\t0\t"
+		<< directSeconds * 1000.0 / Repeats << endl;
+	cout << "sorted\t" << stats.shaderSwitches << "\t" << stats.meshSwitches << "\t"
+		<< sortMilliseconds / Repeats << "\t" << queueSeconds * 1000.0 / Repeats << endl;
+
+	for (auto mesh : meshes)
+		DestroyMesh(mesh);
+	for (auto shader : shaders)
+		DestroyShader(shader);
+	Terminate();
+	return 0;
+}
@@ -0,0 +1,119 @@
+#include <ResRenderer.hpp>
+#include <ResRendererOpenGL.hpp>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace ResRenderer;
+
+//A grid animated on the CPU, uploaded and drawn every frame. Static meshes re-specify storage with
+//glBufferData each upload, dynamic meshes write into the persistently mapped streaming buffer.
+//Reports upload+draw time per frame and upload throughput.
+
+static const int Frames = 200;
+
+static const char* ShaderSource = ""
+	"VertData(pos, 0, vec3);\n"
+	"#ifdef VERTEX\n"
+	"vec4 vertex() { return vec4(pos, 1.0); }\n"
+	"#else\n"
+	"vec4 fragment() { return vec4(1.0); }\n"
+	"#endif\n";
+
+struct Wave {
+	vector<float> vertices;
+	vector<VertexIndex_t> indicies;
+	int side;
+
+	explicit Wave(int quads) : side(quads + 1) {
+		vertices.resize(side * side * 3);
+		for (int y = 0; y < quads; y++)
+		{
+			for (int x = 0; x < quads; x++)
+			{
+				VertexIndex_t i = y * side + x;
+				VertexIndex_t quad[] = { i, i + 1, i + side + 1, i, i + side + 1, i + side };
+				indicies.insert(indicies.end(), quad, quad + 6);
+			}
+		}
+	}
+
+	void Animate(int frame) {
+		for (int y = 0; y < side; y++)
+		{
+			for (int x = 0; x < side; x++)
+			{
+				auto v = &vertices[(y * side + x) * 3];
+				v[0] = x * 2.0f / (side - 1) - 1.0f;
+				v[1] = y * 2.0f / (side - 1) - 1.0f;
+				v[2] = 0.5f * sin(v[0] * 4.0f + frame * 0.1f);
+			}
+		}
+	}
+
+	MeshData ToMeshData() {
+		MeshData meshData;
+		MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 3, false);
+		meshData.data = vertices.data();
+		meshData.dataSize = vertices.size() * sizeof(float);
+		meshData.vertCount = side * side;
+		meshData.indicies = indicies.data();
+		meshData.indiciesCount = indicies.size();
+		return meshData;
+	}
+};
+
+int main() {
+	Init();
+	Window window;
+	if (CreateResWindow(256, 256, "Benchmark", &window) != ErrorCode::RES_NO_ERROR) {
+		cerr << "Window creation failed" << endl;
+		return 1;
+	}
+	Shader shader;
+	CreateShader(&shader);
+	char log[1024];
+	CompileShader(shader, ShaderSource, log, sizeof(log), nullptr);
+	UseShader(shader);
+
+	cout << "grid\tmesh\tbytes per frame\tms per frame\tGB/s\tfence waits\tfallbacks" << endl;
+	for (int quads : { 64, 255, 512 })
+	{
+		Wave wave(quads);
+		for (int dynamic = 0; dynamic < 2; dynamic++)
+		{
+			Mesh mesh;
+			if (dynamic)
+				CreateDynamicMesh(&mesh);
+			else
+				CreateMesh(&mesh);
+			ResetGLStreamingStats();
+			size_t bytes = 0;
+			double seconds = 0.0;
+			for (int frame = 0; frame < Frames; frame++)
+			{
+				//Animation isn't measured, only what the backend does with the data.
+				wave.Animate(frame);
+				auto meshData = wave.ToMeshData();
+				auto start = chrono::steady_clock::now();
+				UploadMeshData(mesh, &meshData);
+				DrawMesh(mesh);
+				SwapBuffer(window);
+				seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+				bytes = meshData.dataSize + meshData.indiciesCount * sizeof(VertexIndex_t);
+			}
+			GLStreamingStats stats;
+			GetGLStreamingStats(&stats);
+			DestroyMesh(mesh);
+			cout << quads << "x" << quads << "\t" << (dynamic ? "dynamic" : "static") << "\t" << bytes << "\t"
+				<< seconds * 1000.0 / Frames << "\t" << bytes * static_cast<double>(Frames) / seconds / 1e9 << "\t"
+				<< stats.fenceWaits << "\t" << stats.fallbackUploads << endl;
+		}
+	}
+
+	DestroyShader(shader);
+	Terminate();
+	return 0;
+}
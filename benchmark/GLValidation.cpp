@@ -0,0 +1,86 @@
+#include <ResRenderer.hpp>
+#include <ResRendererOpenGL.hpp>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace ResRenderer;
+
+//CPU cost of SetUniformVec + DrawMesh under each validation level. Levels above the compiled in
+//RES_GL_VALIDATION are clamped, build with -DRES_GL_VALIDATION=0 to see the cost of compiled out checks.
+
+static const int Draws = 20000;
+static const int Repeats = 10;
+
+static const char* ShaderSource = ""
+	"VertData(pos, 0, vec3);\n"
+	"uniform vec4 _Tint;\n"
+	"#ifdef VERTEX\n"
+	"vec4 vertex() { return vec4(pos, 1.0); }\n"
+	"#else\n"
+	"vec4 fragment() { return _Tint; }\n"
+	"#endif\n";
+
+static double Run(GLValidationLevel level, GLValidationLevel* outLevel) {
+	Init();
+	*outLevel = SetGLValidationLevel(level);
+	Window window;
+	if (CreateResWindow(64, 64, "Benchmark", &window) != ErrorCode::RES_NO_ERROR) {
+		cerr << "Window creation failed" << endl;
+		return 0.0;
+	}
+
+	Mesh mesh;
+	CreateMesh(&mesh);
+	MeshData meshData;
+	MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 3, false);
+	float vertices[] = { 0.01f, -0.01f, 0.0f, -0.01f, -0.01f, 0.0f, 0.0f, 0.01f, 0.0f };
+	VertexIndex_t indicies[] = { 0, 1, 2 };
+	meshData.data = vertices;
+	meshData.dataSize = sizeof(vertices);
+	meshData.vertCount = 3;
+	meshData.indicies = indicies;
+	meshData.indiciesCount = 3;
+	UploadMeshData(mesh, &meshData);
+
+	Shader shader;
+	CreateShader(&shader);
+	char log[1024];
+	CompileShader(shader, ShaderSource, log, sizeof(log), nullptr);
+	int location;
+	GetUniformLocation(shader, "_Tint", &location);
+	UseShader(shader);
+
+	vector<unsigned char> pixels(64 * 64 * 4);
+	double seconds = 0.0;
+	for (int repeat = 0; repeat < Repeats; repeat++)
+	{
+		auto start = chrono::steady_clock::now();
+		for (int i = 0; i < Draws; i++)
+		{
+			SetUniformVec(shader, location, Color(i / static_cast<float>(Draws), 0.0f, 0.0f, 1.0f));
+			DrawMesh(mesh);
+		}
+		seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		//Keep the driver queue from growing between repeats, not measured.
+		ReadWindowPixels(window, pixels.data(), pixels.size());
+	}
+
+	DestroyShader(shader);
+	DestroyMesh(mesh);
+	Terminate();
+	return seconds * 1e9 / (static_cast<double>(Draws) * Repeats);
+}
+
+int main() {
+	const char* names[] = { "none", "debug output", "full" };
+	cout << "requested\tin effect\tns per draw" << endl;
+	for (int level = 0; level <= 2; level++)
+	{
+		GLValidationLevel inEffect;
+		auto ns = Run(static_cast<GLValidationLevel>(level), &inEffect);
+		cout << names[level] << "\t" << names[static_cast<int>(inEffect)] << "\t" << ns << endl;
+	}
+	return 0;
+}
@@ -0,0 +1,135 @@
+#include <ResRenderer.hpp>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace ResRenderer;
+
+//Grid meshes drawn without vertex reuse(every triangle has its own 3 vertices, which is what drawing
+//with glDrawArrays amounts to) and indexed. Reports simulated post-transform cache behavior,
+//index buffer size, and GPU time per draw.
+
+static const int Draws = 50;
+static const int CacheSizes[] = { 16, 32 };
+
+static const char* ShaderSource = ""
+	"VertData(pos, 0, vec3);\n"
+	"#ifdef VERTEX\n"
+	"vec4 vertex() { return vec4(pos, 1.0); }\n"
+	"#else\n"
+	"vec4 fragment() { return vec4(1.0); }\n"
+	"#endif\n";
+
+struct Geometry {
+	vector<float> vertices;
+	vector<VertexIndex_t> indicies;
+};
+
+//quads x quads grid covering clip space, row by row.
+static Geometry MakeGrid(int quads) {
+	Geometry g;
+	int side = quads + 1;
+	for (int y = 0; y < side; y++)
+	{
+		for (int x = 0; x < side; x++)
+		{
+			g.vertices.push_back(x * 2.0f / quads - 1.0f);
+			g.vertices.push_back(y * 2.0f / quads - 1.0f);
+			g.vertices.push_back(0.0f);
+		}
+	}
+	for (int y = 0; y < quads; y++)
+	{
+		for (int x = 0; x < quads; x++)
+		{
+			VertexIndex_t i = y * side + x;
+			VertexIndex_t quad[] = { i, i + 1, i + side + 1, i, i + side + 1, i + side };
+			g.indicies.insert(g.indicies.end(), quad, quad + 6);
+		}
+	}
+	return g;
+}
+
+static Geometry Expand(const Geometry& indexed) {
+	Geometry g;
+	for (auto index : indexed.indicies)
+	{
+		g.vertices.insert(g.vertices.end(), &indexed.vertices[index * 3], &indexed.vertices[index * 3] + 3);
+		g.indicies.push_back(static_cast<VertexIndex_t>(g.indicies.size()));
+	}
+	return g;
+}
+
+static MeshData ToMeshData(Geometry& g) {
+	MeshData meshData;
+	MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 3, false);
+	meshData.data = g.vertices.data();
+	meshData.dataSize = g.vertices.size() * sizeof(float);
+	meshData.vertCount = static_cast<int>(g.vertices.size() / 3);
+	meshData.indicies = g.indicies.data();
+	meshData.indiciesCount = g.indicies.size();
+	return meshData;
+}
+
+static double MillisecondsPerDraw(Window window, Mesh mesh) {
+	vector<unsigned char> pixels(256 * 256 * 4);
+	DrawMesh(mesh);
+	ReadWindowPixels(window, pixels.data(), pixels.size());
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < Draws; i++)
+		DrawMesh(mesh);
+	ReadWindowPixels(window, pixels.data(), pixels.size());
+	return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / Draws;
+}
+
+int main() {
+	Init();
+	Window window;
+	if (CreateResWindow(256, 256, "Benchmark", &window) != ErrorCode::RES_NO_ERROR) {
+		cerr << "Window creation failed" << endl;
+		return 1;
+	}
+	Shader shader;
+	CreateShader(&shader);
+	char log[1024];
+	CompileShader(shader, ShaderSource, log, sizeof(log), nullptr);
+	UseShader(shader);
+
+	cout << "mesh\tvertices\tindex bytes\tcache\tACMR\tATVR\thit rate\tms per draw" << endl;
+	//255 quads per side is the largest grid with 16 bit indices.
+	for (int quads : { 255, 300 })
+	{
+		auto indexed = MakeGrid(quads);
+		auto expanded = Expand(indexed);
+		int vertCount = static_cast<int>(indexed.vertices.size() / 3);
+		size_t indexBytes = indexed.indicies.size() * (vertCount <= 0x10000 ? 2 : 4);
+
+		struct Variant { const char* name; Geometry* geometry; size_t indexBytes; };
+		Variant variants[] = {
+			{ "no reuse", &expanded, 0 },
+			{ "indexed", &indexed, indexBytes },
+		};
+		for (auto& variant : variants)
+		{
+			auto meshData = ToMeshData(*variant.geometry);
+			Mesh mesh;
+			CreateMesh(&mesh);
+			UploadMeshData(mesh, &meshData);
+			auto ms = MillisecondsPerDraw(window, mesh);
+			DestroyMesh(mesh);
+
+			for (int cacheSize : CacheSizes)
+			{
+				VertexCacheStats stats;
+				MeshDataAnalyzeVertexCache(&meshData, cacheSize, &stats);
+				cout << variant.name << " " << quads << "x" << quads << "\t" << meshData.vertCount << "\t" << variant.indexBytes << "\t"
+					<< cacheSize << "\t" << stats.acmr << "\t" << stats.atvr << "\t" << stats.hitRate << "\t" << ms << endl;
+			}
+		}
+	}
+
+	DestroyShader(shader);
+	Terminate();
+	return 0;
+}
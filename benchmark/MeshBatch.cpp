@@ -0,0 +1,149 @@
+#include <ResRenderer.hpp>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace ResRenderer;
+
+//Scatters N small meshes over the screen, each with its own offset. Draws them with N x (SetUniformVec + DrawMesh),
+//and with one DrawMeshBatch taking offsets from an instance buffer. Reports submit(CPU) and frame time.
+
+static const int MeshTypes = 64;
+static const int Repeats = 5;
+
+static const char* UniformShaderSource = ""
+	"VertData(pos, 0, vec2);\n"
+	"uniform vec4 _Offset;\n"
+	"#ifdef VERTEX\n"
+	"vec4 vertex() { return vec4(pos + _Offset.xy, 0.0, 1.0); }\n"
+	"#else\n"
+	"vec4 fragment() { return vec4(1.0); }\n"
+	"#endif\n";
+
+static const char* InstanceShaderSource = ""
+	"VertData(pos, 0, vec2);\n"
+	"VertData(offset, 1, vec2);\n"
+	"#ifdef VERTEX\n"
+	"vec4 vertex() { return vec4(pos + offset, 0.0, 1.0); }\n"
+	"#else\n"
+	"vec4 fragment() { return vec4(1.0); }\n"
+	"#endif\n";
+
+static Shader Compile(const char* source) {
+	Shader shader;
+	CreateShader(&shader);
+	char log[1024];
+	if (CompileShader(shader, source, log, sizeof(log), nullptr) != ErrorCode::RES_NO_ERROR)
+		cerr << log << endl;
+	return shader;
+}
+
+int main() {
+	Init();
+	Window window;
+	if (CreateResWindow(512, 512, "Benchmark", &window) != ErrorCode::RES_NO_ERROR) {
+		cerr << "Window creation failed" << endl;
+		return 1;
+	}
+
+	//Mesh type i is a (i + 3)-gon.
+	vector<Mesh> meshes(MeshTypes);
+	MeshBatch batch;
+	CreateMeshBatch(&batch);
+	for (int type = 0; type < MeshTypes; type++)
+	{
+		int sides = type + 3;
+		vector<float> vertices = { 0.0f, 0.0f };
+		vector<VertexIndex_t> indicies;
+		for (int i = 0; i < sides; i++)
+		{
+			float angle = 6.2831853f * i / sides;
+			vertices.push_back(0.01f * cos(angle));
+			vertices.push_back(0.01f * sin(angle));
+			VertexIndex_t tri[] = { 0, static_cast<VertexIndex_t>(i + 1), static_cast<VertexIndex_t>((i + 1) % sides + 1) };
+			indicies.insert(indicies.end(), tri, tri + 3);
+		}
+		MeshData meshData;
+		MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 2, false);
+		meshData.data = vertices.data();
+		meshData.dataSize = vertices.size() * sizeof(float);
+		meshData.vertCount = sides + 1;
+		meshData.indicies = indicies.data();
+		meshData.indiciesCount = indicies.size();
+		CreateMesh(&meshes[type]);
+		UploadMeshData(meshes[type], &meshData);
+		int subMesh;
+		MeshBatchAddMesh(batch, &meshData, &subMesh);
+	}
+
+	auto uniformShader = Compile(UniformShaderSource);
+	int offsetLocation;
+	GetUniformLocation(uniformShader, "_Offset", &offsetLocation);
+	auto instanceShader = Compile(InstanceShaderSource);
+	InstanceBuffer instances;
+	CreateInstanceBuffer(&instances);
+
+	vector<unsigned char> pixels(512 * 512 * 4);
+	cout << "draws\tmode\tsubmit ms\tframe ms" << endl;
+	for (int draws : { 10000, 30000, 100000 })
+	{
+		mt19937 random(draws);
+		uniform_int_distribution<int> typeDist(0, MeshTypes - 1);
+		uniform_real_distribution<float> posDist(-1.0f, 1.0f);
+		vector<int> types(draws);
+		vector<float> offsets(draws * 2);
+		for (int i = 0; i < draws; i++)
+		{
+			types[i] = typeDist(random);
+			offsets[i * 2] = posDist(random);
+			offsets[i * 2 + 1] = posDist(random);
+		}
+		InstanceData instanceData;
+		InstanceDataAppendAttrib(&instanceData, VertexAttribType::ResFloat, 2, false);
+		instanceData.instanceCount = draws;
+		instanceData.data = offsets.data();
+		instanceData.dataSize = offsets.size() * sizeof(float);
+		UploadInstanceData(instances, &instanceData);
+
+		for (int mode = 0; mode < 2; mode++)
+		{
+			double submitSeconds = 0.0, frameSeconds = 0.0;
+			for (int repeat = 0; repeat < Repeats; repeat++)
+			{
+				Clear(Color(0.0f, 0.0f, 0.0f, 1.0f), ClearType::ColorAndDepth);
+				auto start = chrono::steady_clock::now();
+				if (mode == 0) {
+					UseShader(uniformShader);
+					for (int i = 0; i < draws; i++)
+					{
+						SetUniformVec(uniformShader, offsetLocation, Color(offsets[i * 2], offsets[i * 2 + 1], 0.0f, 0.0f));
+						DrawMesh(meshes[types[i]]);
+					}
+				}
+				else {
+					UseShader(instanceShader);
+					DrawMeshBatch(batch, types.data(), draws, instances);
+				}
+				auto submitted = chrono::steady_clock::now();
+				ReadWindowPixels(window, pixels.data(), pixels.size());
+				auto finished = chrono::steady_clock::now();
+				submitSeconds += chrono::duration<double>(submitted - start).count();
+				frameSeconds += chrono::duration<double>(finished - start).count();
+			}
+			cout << draws << "\t" << (mode == 0 ? "DrawMesh" : "DrawMeshBatch") << "\t"
+				<< submitSeconds * 1000.0 / Repeats << "\t" << frameSeconds * 1000.0 / Repeats << endl;
+		}
+	}
+
+	DestroyInstanceBuffer(instances);
+	DestroyShader(instanceShader);
+	DestroyShader(uniformShader);
+	DestroyMeshBatch(batch);
+	for (auto mesh : meshes)
+		DestroyMesh(mesh);
+	Terminate();
+	return 0;
+}
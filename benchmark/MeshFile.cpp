@@ -0,0 +1,127 @@
+#include <ResRenderer.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace ResRenderer;
+
+//Loads a set of .resmesh files through LoadMeshFile and, for comparison, copies each into buffers of its own first like
+//loaders that parse into MeshData do. Every loaded mesh is then read once by a Full MeshDataVerify, standing in for the upload that
+//touches the pages. Cold runs drop the files from the page cache first(Linux), so they're bounded by the disk.
+//Usage: MeshFileBenchmark [directory] [total MB], 256 MB in the current directory by default. CPU only.
+
+static const int Files = 16;
+
+static string FilePath(const string& directory, int i) {
+	return directory + "/bench" + to_string(i) + ".resmesh";
+}
+
+static void DropFromCache(const string& path) {
+#ifdef __linux__
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd >= 0) {
+		fdatasync(fd);
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		close(fd);
+	}
+#else
+	(void)path;
+#endif
+}
+
+static bool LoadMapped(const string& path, size_t* outBytes) {
+	MeshFile file;
+	MeshData meshData;
+	if (LoadMeshFile(path.c_str(), &file, &meshData) != ErrorCode::RES_NO_ERROR)
+		return false;
+	bool ok = MeshDataVerify(&meshData, MeshDataValidation::Full) == ErrorCode::RES_NO_ERROR;
+	*outBytes += meshData.dataSize + meshData.indiciesCount * sizeof(VertexIndex_t);
+	CloseMeshFile(file);
+	return ok;
+}
+
+//The way meshes were loaded before, copied into buffers of their own before MeshData points at them.
+static bool LoadCopied(const string& path, size_t* outBytes) {
+	MeshFile file;
+	MeshData mapped;
+	if (LoadMeshFile(path.c_str(), &file, &mapped) != ErrorCode::RES_NO_ERROR)
+		return false;
+	auto source = static_cast<const unsigned char*>(mapped.data);
+	vector<unsigned char> vertices(source, source + mapped.dataSize);
+	vector<VertexIndex_t> indicies(mapped.indicies, mapped.indicies + mapped.indiciesCount);
+	CloseMeshFile(file);
+	MeshData meshData = mapped;
+	meshData.data = vertices.data();
+	meshData.indicies = indicies.data();
+	*outBytes += meshData.dataSize + meshData.indiciesCount * sizeof(VertexIndex_t);
+	return MeshDataVerify(&meshData, MeshDataValidation::Full) == ErrorCode::RES_NO_ERROR;
+}
+
+template<typename F>
+static double GBPerSecond(const string& directory, bool cold, F load) {
+	if (cold) {
+		for (int i = 0; i < Files; i++)
+			DropFromCache(FilePath(directory, i));
+	}
+	size_t bytes = 0;
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < Files; i++)
+	{
+		if (!load(FilePath(directory, i), &bytes)) {
+			cerr << "load failed" << endl;
+			exit(1);
+		}
+	}
+	return bytes / chrono::duration<double>(chrono::steady_clock::now() - start).count() / 1e9;
+}
+
+int main(int argc, char** argv) {
+	string directory = argc > 1 ? argv[1] : ".";
+	size_t totalBytes = (argc > 2 ? strtoull(argv[2], nullptr, 10) : 256) << 20;
+
+	//float3 position, float3 normal, float2 uv and 6 indices per vertex, 56 bytes.
+	auto vertCount = static_cast<int>(totalBytes / Files / 56);
+	vector<float> vertices(static_cast<size_t>(vertCount) * 8);
+	for (size_t i = 0; i < vertices.size(); i++)
+		vertices[i] = static_cast<float>(i % 1000) * 0.001f;
+	vector<VertexIndex_t> indicies(static_cast<size_t>(vertCount) * 6);
+	for (size_t i = 0; i < indicies.size(); i++)
+		indicies[i] = static_cast<VertexIndex_t>((i * 2654435761u) % vertCount);
+	MeshData meshData;
+	MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 3, false);
+	MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 3, false);
+	MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 2, false);
+	meshData.data = vertices.data();
+	meshData.dataSize = vertices.size() * sizeof(float);
+	meshData.vertCount = vertCount;
+	meshData.indicies = indicies.data();
+	meshData.indiciesCount = indicies.size();
+	for (int i = 0; i < Files; i++)
+	{
+		if (SaveMeshFile(FilePath(directory, i).c_str(), &meshData) != ErrorCode::RES_NO_ERROR) {
+			cerr << "SaveMeshFile failed" << endl;
+			return 1;
+		}
+	}
+
+	cout << "files\t" << Files << " x " << (meshData.dataSize + meshData.indiciesCount * sizeof(VertexIndex_t)) / 1e6 << " MB" << endl;
+	cout << "method\tcold GB/s\twarm GB/s" << endl;
+	auto coldMapped = GBPerSecond(directory, true, LoadMapped);
+	auto warmMapped = GBPerSecond(directory, false, LoadMapped);
+	auto coldCopied = GBPerSecond(directory, true, LoadCopied);
+	auto warmCopied = GBPerSecond(directory, false, LoadCopied);
+	cout << "mapped\t" << coldMapped << "\t" << warmMapped << endl;
+	cout << "copied\t" << coldCopied << "\t" << warmCopied << endl;
+
+	for (int i = 0; i < Files; i++)
+		remove(FilePath(directory, i).c_str());
+	return 0;
+}
@@ -0,0 +1,77 @@
+#include <ResRenderer.hpp>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace ResRenderer;
+
+//Simplifies a bumpy sphere to a chain of smaller levels like UploadMeshDataWithLODs does. Reports triangles and error
+//of each level, simplification speed, and the screen size below which DrawMeshLOD picks the level at one pixel of
+//error. CPU only, runs with any backend.
+
+static const int Segments = 512;
+static const int Levels = 6;
+
+static void AddSphere(vector<float>& vertices, vector<VertexIndex_t>& indicies) {
+	int rings = Segments / 2;
+	for (int y = 0; y <= rings; y++)
+	{
+		float theta = 3.14159265f * y / rings;
+		for (int s = 0; s <= Segments; s++)
+		{
+			float phi = 6.2831853f * s / Segments;
+			float r = 1.0f + 0.05f * sin(theta * 12.0f) * cos(phi * 9.0f);
+			vertices.push_back(r * sin(theta) * cos(phi));
+			vertices.push_back(r * cos(theta));
+			vertices.push_back(r * sin(theta) * sin(phi));
+		}
+	}
+	int side = Segments + 1;
+	for (int y = 0; y < rings; y++)
+	{
+		for (int s = 0; s < Segments; s++)
+		{
+			VertexIndex_t i = y * side + s;
+			VertexIndex_t quad[] = { i, i + side + 1, i + 1, i, i + side, i + side + 1 };
+			indicies.insert(indicies.end(), quad, quad + 6);
+		}
+	}
+}
+
+int main() {
+	vector<float> vertices;
+	vector<VertexIndex_t> indicies;
+	AddSphere(vertices, indicies);
+	MeshData meshData;
+	MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 3, false);
+	meshData.data = vertices.data();
+	meshData.dataSize = vertices.size() * sizeof(float);
+	meshData.vertCount = static_cast<int>(vertices.size() / 3);
+	meshData.indicies = indicies.data();
+	meshData.indiciesCount = indicies.size();
+
+	cout << "level\ttriangles\terror\tfull detail below px\tMtris/s" << endl;
+	cout << "0\t" << indicies.size() / 3 << "\t0\t-\t-" << endl;
+	vector<VertexIndex_t> level(indicies.size());
+	vector<VertexIndex_t> previous = indicies;
+	float error = 0.0f;
+	for (int l = 1; l < Levels; l++)
+	{
+		meshData.indicies = previous.data();
+		meshData.indiciesCount = previous.size();
+		size_t levelCount = 0;
+		float levelError = 0.0f;
+		auto start = chrono::steady_clock::now();
+		if (SimplifyMeshData(&meshData, previous.size() / 6 * 3, 1.0f, level.data(), &levelCount, &levelError) != ErrorCode::RES_NO_ERROR) {
+			cerr << "SimplifyMeshData failed" << endl;
+			return 1;
+		}
+		auto seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		error += levelError;
+		cout << l << "\t" << levelCount / 3 << "\t" << error << "\t" << 1.0f / error << "\t" << previous.size() / 3 / seconds / 1e6 << endl;
+		previous.assign(level.begin(), level.begin() + levelCount);
+	}
+	return 0;
+}
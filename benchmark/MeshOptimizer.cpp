@@ -0,0 +1,148 @@
+#include <ResRenderer.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace ResRenderer;
+
+//OptimizeMeshData on large meshes whose triangles and vertices were shuffled, like a mesh from an exporter that
+//doesn't care about order. Reports simulated post-transform cache behavior before and after, and the optimizer's
+//own throughput. CPU only, runs with any backend.
+
+static const int CacheSizes[] = { 16, 32 };
+
+struct Geometry {
+	const char* name;
+	vector<float> vertices;
+	vector<VertexIndex_t> indicies;
+};
+
+static void AddQuads(Geometry& g, int columns, int rows) {
+	int side = columns + 1;
+	for (int y = 0; y < rows; y++)
+	{
+		for (int x = 0; x < columns; x++)
+		{
+			VertexIndex_t i = y * side + x;
+			VertexIndex_t quad[] = { i, i + 1, i + side + 1, i, i + side + 1, i + side };
+			g.indicies.insert(g.indicies.end(), quad, quad + 6);
+		}
+	}
+}
+
+static Geometry MakeGrid(int quads) {
+	Geometry g;
+	g.name = "grid";
+	for (int y = 0; y <= quads; y++)
+	{
+		for (int x = 0; x <= quads; x++)
+		{
+			g.vertices.push_back(x * 2.0f / quads - 1.0f);
+			g.vertices.push_back(y * 2.0f / quads - 1.0f);
+			g.vertices.push_back(0.0f);
+		}
+	}
+	AddQuads(g, quads, quads);
+	return g;
+}
+
+//Latitude-longitude sphere, seam vertices duplicated.
+static Geometry MakeSphere(int segments) {
+	Geometry g;
+	g.name = "sphere";
+	int rings = segments / 2;
+	for (int y = 0; y <= rings; y++)
+	{
+		float theta = 3.14159265f * y / rings;
+		for (int x = 0; x <= segments; x++)
+		{
+			float phi = 6.2831853f * x / segments;
+			g.vertices.push_back(sin(theta) * cos(phi));
+			g.vertices.push_back(cos(theta));
+			g.vertices.push_back(sin(theta) * sin(phi));
+		}
+	}
+	AddQuads(g, segments, rings);
+	return g;
+}
+
+static void Shuffle(Geometry& g, mt19937& random) {
+	auto triangleCount = g.indicies.size() / 3;
+	vector<size_t> triangles(triangleCount);
+	for (size_t i = 0; i < triangleCount; i++)
+		triangles[i] = i;
+	shuffle(triangles.begin(), triangles.end(), random);
+	auto vertCount = g.vertices.size() / 3;
+	vector<VertexIndex_t> remap(vertCount);
+	for (size_t i = 0; i < vertCount; i++)
+		remap[i] = static_cast<VertexIndex_t>(i);
+	shuffle(remap.begin(), remap.end(), random);
+
+	vector<VertexIndex_t> indicies;
+	for (auto triangle : triangles)
+	{
+		for (int c = 0; c < 3; c++)
+			indicies.push_back(remap[g.indicies[triangle * 3 + c]]);
+	}
+	vector<float> vertices(g.vertices.size());
+	for (size_t i = 0; i < vertCount; i++)
+		copy(&g.vertices[i * 3], &g.vertices[i * 3] + 3, &vertices[remap[i] * 3]);
+	g.indicies.swap(indicies);
+	g.vertices.swap(vertices);
+}
+
+static MeshData ToMeshData(Geometry& g) {
+	MeshData meshData;
+	MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 3, false);
+	meshData.data = g.vertices.data();
+	meshData.dataSize = g.vertices.size() * sizeof(float);
+	meshData.vertCount = static_cast<int>(g.vertices.size() / 3);
+	meshData.indicies = g.indicies.data();
+	meshData.indiciesCount = g.indicies.size();
+	return meshData;
+}
+
+static void PrintCache(const char* name, const MeshData& meshData, const char* state) {
+	for (auto cacheSize : CacheSizes)
+	{
+		VertexCacheStats stats;
+		MeshDataAnalyzeVertexCache(&meshData, cacheSize, &stats);
+		cout << name << "\t" << meshData.indiciesCount / 3 << "\t" << state << "\t" << cacheSize << "\t"
+			<< stats.acmr << "\t" << stats.atvr << endl;
+	}
+}
+
+int main() {
+	mt19937 random(1234);
+	vector<Geometry> meshes;
+	meshes.push_back(MakeGrid(256));
+	meshes.push_back(MakeGrid(1024));
+	meshes.push_back(MakeSphere(512));
+	meshes.push_back(MakeSphere(1448));
+
+	cout << "mesh\ttriangles\tstate\tcache\tACMR\tATVR" << endl;
+	vector<double> throughput;
+	for (auto& g : meshes)
+	{
+		Shuffle(g, random);
+		auto meshData = ToMeshData(g);
+		PrintCache(g.name, meshData, "shuffled");
+		auto start = chrono::steady_clock::now();
+		if (OptimizeMeshData(&meshData, CacheSizes[0]) != ErrorCode::RES_NO_ERROR) {
+			cerr << "OptimizeMeshData failed" << endl;
+			return 1;
+		}
+		auto seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		throughput.push_back(meshData.indiciesCount / 3 / seconds / 1e6);
+		PrintCache(g.name, meshData, "optimized");
+	}
+
+	cout << endl << "mesh\ttriangles\tMtris/s" << endl;
+	for (size_t i = 0; i < meshes.size(); i++)
+		cout << meshes[i].name << "\t" << meshes[i].indicies.size() / 3 << "\t" << throughput[i] << endl;
+	return 0;
+}
@@ -0,0 +1,102 @@
+#include <ResRenderer.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+using namespace std;
+using namespace ResRenderer;
+
+//MeshDataVerify throughput of Layout and Full validation on a large mesh, float and compact vertex layouts, next to
+//memcpy of the same bytes as a bandwidth reference. Also checks Full catches a bad index and a NaN at the very end.
+//CPU only, runs with any backend.
+
+static const int Vertices = 1 << 22;
+static const int Repeats = 10;
+
+static double Seconds(const MeshData& meshData, MeshDataValidation level, ErrorCode* outResult) {
+	*outResult = MeshDataVerify(&meshData, level);
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < Repeats; i++)
+		MeshDataVerify(&meshData, level);
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count() / Repeats;
+}
+
+static void Run(const char* name, MeshData& meshData, vector<unsigned char>& vertices, vector<VertexIndex_t>& indicies) {
+	auto bytes = static_cast<double>(meshData.dataSize + meshData.indiciesCount * sizeof(VertexIndex_t));
+	ErrorCode layoutResult, fullResult;
+	auto layout = Seconds(meshData, MeshDataValidation::Layout, &layoutResult);
+	auto full = Seconds(meshData, MeshDataValidation::Full, &fullResult);
+
+	vector<unsigned char> copy(static_cast<size_t>(bytes));
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < Repeats; i++)
+	{
+		memcpy(copy.data(), vertices.data(), meshData.dataSize);
+		memcpy(copy.data() + meshData.dataSize, indicies.data(), meshData.indiciesCount * sizeof(VertexIndex_t));
+	}
+	auto memcpySeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count() / Repeats;
+
+	indicies.back() = static_cast<VertexIndex_t>(meshData.vertCount);
+	auto badIndex = MeshDataVerify(&meshData, MeshDataValidation::Full);
+	indicies.back() = 0;
+	float nan = numeric_limits<float>::quiet_NaN();
+	memcpy(vertices.data() + meshData.dataSize - GetMeshVertexSize(&meshData), &nan, sizeof(nan));
+	auto badVertex = MeshDataVerify(&meshData, MeshDataValidation::Full);
+	memset(vertices.data() + meshData.dataSize - GetMeshVertexSize(&meshData), 0, sizeof(nan));
+
+	cout << name << "\t" << bytes / layout / 1e9 << "\t" << bytes / full / 1e9 << "\t" << bytes / memcpySeconds / 1e9 << "\t"
+		<< (layoutResult == ErrorCode::RES_NO_ERROR && fullResult == ErrorCode::RES_NO_ERROR && badIndex == ErrorCode::MESH_DATA_INDEX_OUT_OF_RANGE && badVertex == ErrorCode::MESH_DATA_NOT_FINITE ? "yes" : "NO") << endl;
+}
+
+int main() {
+	vector<VertexIndex_t> indicies(static_cast<size_t>(Vertices) * 6);
+	for (size_t i = 0; i < indicies.size(); i++)
+		indicies[i] = static_cast<VertexIndex_t>((i * 2654435761u) % Vertices);
+
+	cout << "layout\tLayout GB/s\tFull GB/s\tmemcpy GB/s\tcatches errors" << endl;
+	{
+		MeshData meshData;
+		MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 3, false);
+		MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 3, false);
+		MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 2, false);
+		vector<float> floats(static_cast<size_t>(Vertices) * 8);
+		for (size_t i = 0; i < floats.size(); i++)
+			floats[i] = sin(static_cast<float>(i));
+		vector<unsigned char> vertices(floats.size() * sizeof(float));
+		memcpy(vertices.data(), floats.data(), vertices.size());
+		meshData.data = vertices.data();
+		meshData.dataSize = vertices.size();
+		meshData.vertCount = Vertices;
+		meshData.indicies = indicies.data();
+		meshData.indiciesCount = indicies.size();
+		Run("float", meshData, vertices, indicies);
+	}
+	{
+		MeshData meshData;
+		MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 3, false);
+		MeshDataAppendAttrib(&meshData, VertexAttribType::ResInt10_10_10_2, 4, true);
+		MeshDataAppendAttrib(&meshData, VertexAttribType::ResHalfFloat, 2, false);
+		vector<float> positions(static_cast<size_t>(Vertices) * 3), uvs(static_cast<size_t>(Vertices) * 2), normals(static_cast<size_t>(Vertices) * 4);
+		for (size_t i = 0; i < positions.size(); i++)
+			positions[i] = sin(static_cast<float>(i));
+		for (size_t i = 0; i < uvs.size(); i++)
+			uvs[i] = cos(static_cast<float>(i));
+		for (size_t i = 0; i < normals.size(); i++)
+			normals[i] = sin(static_cast<float>(i) * 0.5f);
+		auto stride = GetMeshVertexSize(&meshData);
+		vector<unsigned char> vertices(static_cast<size_t>(Vertices) * stride);
+		PackVertexAttrib(&meshData.attribDescriptions[0], positions.data(), Vertices, vertices.data(), stride);
+		PackVertexAttrib(&meshData.attribDescriptions[1], normals.data(), Vertices, vertices.data() + 12, stride);
+		PackVertexAttrib(&meshData.attribDescriptions[2], uvs.data(), Vertices, vertices.data() + 16, stride);
+		meshData.data = vertices.data();
+		meshData.dataSize = vertices.size();
+		meshData.vertCount = Vertices;
+		meshData.indicies = indicies.data();
+		meshData.indiciesCount = indicies.size();
+		Run("compact", meshData, vertices, indicies);
+	}
+	return 0;
+}
@@ -0,0 +1,137 @@
+#include <ResRenderer.hpp>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace ResRenderer;
+
+//Meshlets of a large model, a field of spheres, seen by a camera circling inside it. Reports meshlet build speed,
+//cull speed, and how many triangles are left to draw after frustum and backface culling at meshlet granularity.
+//CPU only, runs with any backend.
+
+static const int Spheres = 8;
+static const int Segments = 256;
+static const int Views = 64;
+static const int CullRepeats = 20;
+
+static void AddSphere(vector<float>& vertices, vector<VertexIndex_t>& indicies, float x, float z) {
+	auto first = static_cast<VertexIndex_t>(vertices.size() / 3);
+	int rings = Segments / 2;
+	for (int y = 0; y <= rings; y++)
+	{
+		float theta = 3.14159265f * y / rings;
+		for (int s = 0; s <= Segments; s++)
+		{
+			float phi = 6.2831853f * s / Segments;
+			vertices.push_back(x + sin(theta) * cos(phi));
+			vertices.push_back(cos(theta));
+			vertices.push_back(z + sin(theta) * sin(phi));
+		}
+	}
+	int side = Segments + 1;
+	for (int y = 0; y < rings; y++)
+	{
+		for (int s = 0; s < Segments; s++)
+		{
+			VertexIndex_t i = first + y * side + s;
+			VertexIndex_t quad[] = { i, i + side + 1, i + 1, i, i + side, i + side + 1 };
+			indicies.insert(indicies.end(), quad, quad + 6);
+		}
+	}
+}
+
+//Column major perspective * look-at.
+static void MakeViewProjection(const float* eye, const float* target, float* out) {
+	float f[3] = { target[0] - eye[0], target[1] - eye[1], target[2] - eye[2] };
+	float fl = sqrt(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+	for (auto& c : f)
+		c /= fl;
+	float s[3] = { f[1] * 0.0f - f[2] * 1.0f, f[2] * 0.0f - f[0] * 0.0f, f[0] * 1.0f - f[1] * 0.0f };
+	float sl = sqrt(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+	for (auto& c : s)
+		c /= sl;
+	float u[3] = { s[1] * f[2] - s[2] * f[1], s[2] * f[0] - s[0] * f[2], s[0] * f[1] - s[1] * f[0] };
+	float view[16] = {
+		s[0], u[0], -f[0], 0.0f,
+		s[1], u[1], -f[1], 0.0f,
+		s[2], u[2], -f[2], 0.0f,
+		-(s[0] * eye[0] + s[1] * eye[1] + s[2] * eye[2]), -(u[0] * eye[0] + u[1] * eye[1] + u[2] * eye[2]), f[0] * eye[0] + f[1] * eye[1] + f[2] * eye[2], 1.0f,
+	};
+	float n = 0.1f, fr = 100.0f, t = 1.0f / tan(0.5f);
+	float projection[16] = {
+		t, 0.0f, 0.0f, 0.0f,
+		0.0f, t, 0.0f, 0.0f,
+		0.0f, 0.0f, (fr + n) / (n - fr), -1.0f,
+		0.0f, 0.0f, 2.0f * fr * n / (n - fr), 0.0f,
+	};
+	for (int c = 0; c < 4; c++)
+	{
+		for (int r = 0; r < 4; r++)
+		{
+			out[c * 4 + r] = 0.0f;
+			for (int k = 0; k < 4; k++)
+				out[c * 4 + r] += projection[k * 4 + r] * view[c * 4 + k];
+		}
+	}
+}
+
+int main() {
+	vector<float> vertices;
+	vector<VertexIndex_t> indicies;
+	for (int i = 0; i < Spheres; i++)
+	{
+		float angle = 6.2831853f * i / Spheres;
+		AddSphere(vertices, indicies, cos(angle) * 6.0f, sin(angle) * 6.0f);
+	}
+	MeshData meshData;
+	MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 3, false);
+	meshData.data = vertices.data();
+	meshData.dataSize = vertices.size() * sizeof(float);
+	meshData.vertCount = static_cast<int>(vertices.size() / 3);
+	meshData.indicies = indicies.data();
+	meshData.indiciesCount = indicies.size();
+	auto triangles = indicies.size() / 3;
+
+	vector<Meshlet> meshlets(GetMeshletCountBound(&meshData));
+	size_t meshletCount = 0;
+	auto start = chrono::steady_clock::now();
+	if (BuildMeshlets(&meshData, meshlets.data(), meshlets.size(), &meshletCount) != ErrorCode::RES_NO_ERROR) {
+		cerr << "BuildMeshlets failed" << endl;
+		return 1;
+	}
+	auto buildSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	cout << "triangles\t" << triangles << endl;
+	cout << "meshlets\t" << meshletCount << "\t" << static_cast<double>(triangles) / meshletCount << " triangles each" << endl;
+	cout << "build Mtris/s\t" << triangles / buildSeconds / 1e6 << endl;
+
+	vector<IndexRange> ranges(meshletCount);
+	unsigned long long drawnIndices = 0, drawnRanges = 0, visibleMeshlets = 0;
+	double cullSeconds = 0.0;
+	for (int v = 0; v < Views; v++)
+	{
+		float angle = 6.2831853f * v / Views;
+		float eye[3] = { cos(angle) * 2.0f, 0.5f, sin(angle) * 2.0f };
+		float target[3] = { cos(angle + 1.2f) * 6.0f, 0.0f, sin(angle + 1.2f) * 6.0f };
+		float viewProjection[16];
+		MakeViewProjection(eye, target, viewProjection);
+		MeshletCullView view;
+		MakeMeshletCullView(viewProjection, eye, &view);
+
+		size_t rangeCount = 0, visible = 0;
+		auto cullStart = chrono::steady_clock::now();
+		for (int r = 0; r < CullRepeats; r++)
+			CullMeshlets(meshlets.data(), meshletCount, &view, ranges.data(), &rangeCount, &visible);
+		cullSeconds += chrono::duration<double>(chrono::steady_clock::now() - cullStart).count();
+		for (size_t r = 0; r < rangeCount; r++)
+			drawnIndices += ranges[r].indexCount;
+		drawnRanges += rangeCount;
+		visibleMeshlets += visible;
+	}
+	cout << "cull Mmeshlets/s\t" << static_cast<double>(meshletCount) * Views * CullRepeats / cullSeconds / 1e6 << endl;
+	cout << "visible meshlets\t" << static_cast<double>(visibleMeshlets) / Views / meshletCount * 100.0 << "%" << endl;
+	cout << "drawn triangles\t" << static_cast<double>(drawnIndices) / 3 / Views / triangles * 100.0 << "%" << endl;
+	cout << "ranges per view\t" << static_cast<double>(drawnRanges) / Views << endl;
+	return 0;
+}
@@ -0,0 +1,67 @@
+#include <ResRenderer.hpp>
+#include <ResRendererNull.hpp>
+#include <chrono>
+#include <iostream>
+
+using namespace std;
+using namespace ResRenderer;
+
+//Measures the CPU cost of API calls against the null backend, no driver is involved.
+
+static const int Iterations = 10000000;
+
+template<typename F>
+static void Measure(const char* name, F func) {
+	//Warm up.
+	for (int i = 0; i < Iterations / 100; i++)
+		func(i);
+
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < Iterations; i++)
+		func(i);
+	chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+	cout << name << "\t" << elapsed.count() / Iterations << " ns/call" << endl;
+}
+
+int main() {
+	Init();
+	Window window;
+	CreateResWindow(800, 600, "Benchmark", &window);
+
+	Mesh mesh;
+	CreateMesh(&mesh);
+	MeshData meshData;
+	MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 3, false);
+	float vertices[] = { 0.5f, -0.5f, 0.0f, -0.5f, -0.5f, 0.0f, 0.0f, 0.5f, 0.0f };
+	VertexIndex_t indicies[] = { 0, 1, 2 };
+	meshData.data = vertices;
+	meshData.dataSize = sizeof(vertices);
+	meshData.vertCount = 3;
+	meshData.indicies = indicies;
+	meshData.indiciesCount = 3;
+	UploadMeshData(mesh, &meshData);
+
+	Shader shader;
+	CreateShader(&shader);
+	CompileShader(shader, "", nullptr, 0, nullptr);
+	int location;
+	GetUniformLocation(shader, "_Tint", &location);
+
+	ResetNullBackendStats();
+	Measure("DrawMesh", [&](int) { DrawMesh(mesh); });
+	Measure("SetUniformVec", [&](int i) { SetUniformVec(shader, location, Color(static_cast<float>(i), 0.0f, 0.0f, 1.0f)); });
+	Measure("UseShader", [&](int) { UseShader(shader); });
+	Measure("GetUniformLocation", [&](int) { GetUniformLocation(shader, "_Tint", &location); });
+	Measure("UploadMeshData", [&](int) { UploadMeshData(mesh, &meshData); });
+	Measure("Clear", [&](int) { Clear(Color(0.0f, 0.0f, 0.0f, 1.0f), ClearType::ColorAndDepth); });
+
+	NullBackendStats stats;
+	GetNullBackendStats(&stats);
+	cout << "calls: " << stats.apiCalls << " draws: " << stats.drawCalls << " uniform sets: " << stats.uniformSets
+		<< " uploaded bytes: " << stats.uploadedBytes << " failed: " << stats.failedCalls << endl;
+
+	DestroyShader(shader);
+	DestroyMesh(mesh);
+	Terminate();
+	return 0;
+}
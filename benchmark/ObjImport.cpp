@@ -0,0 +1,83 @@
+#include <ResRenderer.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace std;
+using namespace ResRenderer;
+
+//Writes a scan-like OBJ, a bumpy grid of quads with v, vt, vn and f v/vt/vn, then imports it with ImportObjFile.
+//Reports parse speed in GB/s of text with the file in the page cache, so it's bounded by the CPU rather than the disk.
+//Usage: ObjImportBenchmark [path] [MB], 256 MB at ./bench.obj by default. CPU only.
+
+static const int Repeats = 3;
+
+int main(int argc, char** argv) {
+	string path = argc > 1 ? argv[1] : "./bench.obj";
+	size_t targetBytes = (argc > 2 ? strtoull(argv[2], nullptr, 10) : 256) << 20;
+
+	//About 140 bytes of text per grid point.
+	auto side = static_cast<int>(sqrt(static_cast<double>(targetBytes) / 140.0));
+	auto file = fopen(path.c_str(), "wb");
+	if (file == nullptr) {
+		cerr << "can't write " << path << endl;
+		return 1;
+	}
+	fprintf(file, "# %d x %d grid\n", side, side);
+	for (int y = 0; y < side; y++)
+	{
+		for (int x = 0; x < side; x++)
+		{
+			float u = static_cast<float>(x) / side, v = static_cast<float>(y) / side;
+			fprintf(file, "v %.6f %.6f %.6f\n", u * 10.0f, 0.1f * sin(u * 40.0f) * cos(v * 40.0f), v * 10.0f);
+		}
+	}
+	for (int y = 0; y < side; y++)
+	{
+		for (int x = 0; x < side; x++)
+			fprintf(file, "vt %.6f %.6f\n", static_cast<float>(x) / side, static_cast<float>(y) / side);
+	}
+	for (int y = 0; y < side; y++)
+	{
+		for (int x = 0; x < side; x++)
+			fprintf(file, "vn %.6f %.6f %.6f\n", 0.0f, 1.0f, 0.0f);
+	}
+	for (int y = 0; y + 1 < side; y++)
+	{
+		for (int x = 0; x + 1 < side; x++)
+		{
+			int a = y * side + x + 1, b = a + 1, c = a + side + 1, d = a + side;
+			fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, c, c, c, d, d, d);
+		}
+	}
+	auto bytes = static_cast<double>(ftell(file));
+	fclose(file);
+
+	MeshFile mesh;
+	MeshData meshData;
+	if (ImportObjFile(path.c_str(), &mesh, &meshData) != ErrorCode::RES_NO_ERROR) {
+		cerr << "ImportObjFile failed" << endl;
+		return 1;
+	}
+	cout << "file MB\t" << bytes / 1e6 << endl;
+	cout << "vertices\t" << meshData.vertCount << endl;
+	cout << "triangles\t" << meshData.indiciesCount / 3 << endl;
+	CloseMeshFile(mesh);
+
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < Repeats; i++)
+	{
+		ImportObjFile(path.c_str(), &mesh, &meshData);
+		CloseMeshFile(mesh);
+	}
+	auto seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count() / Repeats;
+	cout << "threads\t" << thread::hardware_concurrency() << endl;
+	cout << "import GB/s\t" << bytes / seconds / 1e9 << endl;
+	cout << "Mtris/s\t" << meshData.indiciesCount / 3 / seconds / 1e6 << endl;
+	remove(path.c_str());
+	return 0;
+}
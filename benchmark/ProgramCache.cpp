@@ -0,0 +1,81 @@
+#include <ResRenderer.hpp>
+#include <ResRendererOpenGL.hpp>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using namespace ResRenderer;
+
+//Startup cost of compiling a set of shaders: without program cache, with an empty(cold) cache directory,
+//and again with the binaries stored by the cold run(warm). Each run is a fresh Init/window, like an application launch.
+//Usage: ProgramCacheBenchmark <empty directory>, binaries are left there.
+
+static const int Shaders = 100;
+
+static string MakeSource(int i) {
+	//Distinct constants, so every program is its own cache entry.
+	return "VertData(pos, 0, vec3);\n"
+		"VertData(normal, 1, vec3);\n"
+		"uniform vec4 _Light;\n"
+		"INTERP vec3 vNormal;\n"
+		"#ifdef VERTEX\n"
+		"vec4 vertex() { vNormal = normal; return vec4(pos * " + to_string(i + 1) + ".0, 1.0); }\n"
+		"#else\n"
+		"vec4 fragment() {\n"
+		"	float d = max(dot(normalize(vNormal), _Light.xyz), 0.0);\n"
+		"	return vec4(vec3(pow(d, " + to_string(i % 16 + 1) + ".0)), 1.0);\n"
+		"}\n"
+		"#endif\n";
+}
+
+static double Run(const char* cacheDirectory, GLProgramCacheStats* outStats) {
+	Init();
+	Window window;
+	if (CreateResWindow(64, 64, "Benchmark", &window) != ErrorCode::RES_NO_ERROR) {
+		cerr << "Window creation failed" << endl;
+		return 0.0;
+	}
+	SetGLProgramCacheDirectory(cacheDirectory);
+	ResetGLProgramCacheStats();
+
+	Shader shaders[Shaders];
+	char log[1024];
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < Shaders; i++)
+	{
+		CreateShader(&shaders[i]);
+		if (CompileShader(shaders[i], MakeSource(i).c_str(), log, sizeof(log), nullptr) != ErrorCode::RES_NO_ERROR)
+			cerr << log << endl;
+	}
+	auto ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+	GetGLProgramCacheStats(outStats);
+	for (auto shader : shaders)
+		DestroyShader(shader);
+	Terminate();
+	return ms;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		cerr << "Usage: ProgramCacheBenchmark <empty directory>" << endl;
+		return 1;
+	}
+	string directory = argv[1];
+
+	struct Variant { const char* name; const char* directory; };
+	Variant variants[] = {
+		{ "no cache", nullptr },
+		{ "cold", directory.c_str() },
+		{ "warm", directory.c_str() },
+	};
+	cout << "cache\tms for " << Shaders << " shaders\thits\tmisses\trejected\tstores" << endl;
+	for (auto& variant : variants)
+	{
+		GLProgramCacheStats stats;
+		auto ms = Run(variant.directory, &stats);
+		cout << variant.name << "\t" << ms << "\t" << stats.hits << "\t" << stats.misses << "\t" << stats.rejected << "\t" << stats.stores << endl;
+	}
+	return 0;
+}
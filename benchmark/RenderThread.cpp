@@ -0,0 +1,108 @@
+#include <ResRenderer.hpp>
+#include <ResRendererOpenGL.hpp>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace ResRenderer;
+
+//Frame throughput of a CPU-bound frame loop, with every call executed synchronously
+//and with a render thread. Each frame burns some "game logic" time, then submits draws.
+
+static const int Frames = 300;
+static const int DrawsPerFrame = 2000;
+static const double LogicMilliseconds = 4.0;
+
+static const char* ShaderSource = ""
+	"VertData(pos, 0, vec3);\n"
+	"uniform vec4 _Tint;\n"
+	"#ifdef VERTEX\n"
+	"vec4 vertex() { return vec4(pos, 1.0); }\n"
+	"#else\n"
+	"vec4 fragment() { return _Tint; }\n"
+	"#endif\n";
+
+static volatile double logicSink = 0.0;
+static GLStateCacheStats stateStats;
+
+static void SimulateGameLogic() {
+	auto start = chrono::steady_clock::now();
+	double x = 0.0;
+	while (chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() < LogicMilliseconds)
+	{
+		for (int i = 0; i < 1000; i++)
+			x += sin(x + i);
+	}
+	logicSink = x;
+}
+
+static double Run(int framesInFlight) {
+	Init();
+	if (framesInFlight > 0)
+		EnableRenderThread(framesInFlight);
+
+	Window window;
+	if (CreateResWindow(640, 480, "Benchmark", &window) != ErrorCode::RES_NO_ERROR) {
+		cerr << "Window creation failed" << endl;
+		return 0.0;
+	}
+
+	Mesh mesh;
+	CreateMesh(&mesh);
+	MeshData meshData;
+	MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 3, false);
+	float vertices[] = { 0.01f, -0.01f, 0.0f, -0.01f, -0.01f, 0.0f, 0.0f, 0.01f, 0.0f };
+	VertexIndex_t indicies[] = { 0, 1, 2 };
+	meshData.data = vertices;
+	meshData.dataSize = sizeof(vertices);
+	meshData.vertCount = 3;
+	meshData.indicies = indicies;
+	meshData.indiciesCount = 3;
+	UploadMeshData(mesh, &meshData);
+
+	Shader shader;
+	CreateShader(&shader);
+	char log[1024];
+	CompileShader(shader, ShaderSource, log, sizeof(log), nullptr);
+	int location;
+	GetUniformLocation(shader, "_Tint", &location);
+
+	auto start = chrono::steady_clock::now();
+	for (int frame = 0; frame < Frames; frame++)
+	{
+		SimulateGameLogic();
+		Clear(Color(0.0f, 0.0f, 0.0f, 1.0f), ClearType::ColorAndDepth);
+		UseShader(shader);
+		for (int i = 0; i < DrawsPerFrame; i++)
+		{
+			SetUniformVec(shader, location, Color(i / static_cast<float>(DrawsPerFrame), 0.0f, 0.0f, 1.0f));
+			DrawMesh(mesh);
+		}
+		SwapBuffer(window);
+		PollEvents();
+	}
+	//Wait for the render thread to catch up.
+	vector<unsigned char> pixels(640 * 480 * 4);
+	ReadWindowPixels(window, pixels.data(), pixels.size());
+	chrono::duration<double> seconds = chrono::steady_clock::now() - start;
+	GetGLStateCacheStats(&stateStats);
+
+	DestroyShader(shader);
+	DestroyMesh(mesh);
+	Terminate();
+	return Frames / seconds.count();
+}
+
+int main() {
+	cout << "mode\tframes in flight\tfps\tissued binds\telided binds" << endl;
+	auto fps = Run(0);
+	cout << "sync\t0\t" << fps << "\t" << stateStats.total.issued << "\t" << stateStats.total.elided << endl;
+	for (int framesInFlight = 1; framesInFlight <= 3; framesInFlight++)
+	{
+		fps = Run(framesInFlight);
+		cout << "async\t" << framesInFlight << "\t" << fps << "\t" << stateStats.total.issued << "\t" << stateStats.total.elided << endl;
+	}
+	return 0;
+}
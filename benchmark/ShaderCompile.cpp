@@ -0,0 +1,97 @@
+#include <ResRenderer.hpp>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace ResRenderer;
+
+//Total time to compile a set of distinct shaders, one CompileShader after another vs all CompileShaderAsync
+//at once and polling until every one is done, like a loading screen would.
+
+static const int Shaders = 200;
+
+static string MakeSource(int i) {
+	return "VertData(pos, 0, vec3);\n"
+		"VertData(normal, 1, vec3);\n"
+		"uniform vec4 _Light;\n"
+		"INTERP vec3 vNormal;\n"
+		"#ifdef VERTEX\n"
+		"vec4 vertex() { vNormal = normal; return vec4(pos * " + to_string(i + 1) + ".0, 1.0); }\n"
+		"#else\n"
+		"vec4 fragment() {\n"
+		"	float d = max(dot(normalize(vNormal), _Light.xyz), 0.0);\n"
+		"	return vec4(vec3(pow(d, " + to_string(i % 16 + 1) + ".0)), 1.0);\n"
+		"}\n"
+		"#endif\n";
+}
+
+static double Run(bool async, int* outFailed) {
+	Init();
+	Window window;
+	if (CreateResWindow(64, 64, "Benchmark", &window) != ErrorCode::RES_NO_ERROR) {
+		cerr << "Window creation failed" << endl;
+		return 0.0;
+	}
+	//Offset keeps drivers with their own shader caches from reusing the previous run.
+	vector<string> sources;
+	for (int i = 0; i < Shaders; i++)
+		sources.push_back(MakeSource(i + (async ? Shaders : 0)));
+	vector<Shader> shaders(Shaders);
+	for (auto& shader : shaders)
+		CreateShader(&shader);
+
+	*outFailed = 0;
+	char log[1024];
+	auto start = chrono::steady_clock::now();
+	if (!async) {
+		for (int i = 0; i < Shaders; i++)
+		{
+			if (CompileShader(shaders[i], sources[i].c_str(), log, sizeof(log), nullptr) != ErrorCode::RES_NO_ERROR)
+				(*outFailed)++;
+		}
+	}
+	else {
+		for (int i = 0; i < Shaders; i++)
+			CompileShaderAsync(shaders[i], sources[i].c_str());
+		int pending = Shaders;
+		vector<bool> done(Shaders);
+		while (pending > 0)
+		{
+			for (int i = 0; i < Shaders; i++)
+			{
+				if (done[i])
+					continue;
+				ShaderCompileStatus status;
+				PollShaderCompile(shaders[i], &status, log, sizeof(log), nullptr);
+				if (status == ShaderCompileStatus::Compiling)
+					continue;
+				if (status == ShaderCompileStatus::Failed)
+					(*outFailed)++;
+				done[i] = true;
+				pending--;
+			}
+			if (pending > 0)
+				this_thread::sleep_for(chrono::microseconds(100));
+		}
+	}
+	auto ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+	for (auto shader : shaders)
+		DestroyShader(shader);
+	Terminate();
+	return ms;
+}
+
+int main() {
+	cout << "mode\tms for " << Shaders << " shaders\tfailed" << endl;
+	for (int async = 0; async < 2; async++)
+	{
+		int failed;
+		auto ms = Run(async != 0, &failed);
+		cout << (async ? "CompileShaderAsync" : "CompileShader") << "\t" << ms << "\t" << failed << endl;
+	}
+	return 0;
+}
@@ -0,0 +1,80 @@
+#include <ResRenderer.hpp>
+#include <ResRendererOpenGL.hpp>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using namespace ResRenderer;
+
+//Shader hot reload latency: a watched shader file is rewritten with a small edit, frames keep running, and the time
+//until PollGLShaderReloads reports the new program is measured. Also reports the slowest frame, reloads must not stall.
+//Usage: ShaderReloadBenchmark [shader path], defaults to ShaderReloadBenchmark.glsl in current directory.
+
+static const int Edits = 20;
+
+static void WriteShader(const string& path, int edit) {
+	ofstream file(path, ios::trunc);
+	file << "VertData(pos, 0, vec3);\n"
+		"uniform vec4 _Tint;\n"
+		"#ifdef VERTEX\n"
+		"vec4 vertex() { return vec4(pos, 1.0); }\n"
+		"#else\n"
+		"vec4 fragment() { return _Tint * " << (edit % 10) / 10.0 + 0.05 << "; }\n"
+		"#endif\n";
+}
+
+int main(int argc, char** argv) {
+	string path = argc > 1 ? argv[1] : "ShaderReloadBenchmark.glsl";
+	Init();
+	Window window;
+	if (CreateResWindow(256, 256, "Benchmark", &window) != ErrorCode::RES_NO_ERROR) {
+		cerr << "Window creation failed" << endl;
+		return 1;
+	}
+
+	WriteShader(path, 0);
+	ifstream file(path);
+	string source((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+	Shader shader;
+	CreateShader(&shader);
+	char log[1024];
+	CompileShader(shader, source.c_str(), log, sizeof(log), nullptr);
+	if (WatchGLShaderFile(shader, path.c_str()) != ErrorCode::RES_NO_ERROR) {
+		cerr << "Watching " << path << " failed, hot reload needs inotify." << endl;
+		return 1;
+	}
+	UseShader(shader);
+
+	cout << "edit\tlatency ms\tframes\tslowest frame ms" << endl;
+	double totalMs = 0.0;
+	for (int edit = 1; edit <= Edits; edit++)
+	{
+		WriteShader(path, edit);
+		auto written = chrono::steady_clock::now();
+		int frames = 0;
+		double slowest = 0.0;
+		for (;;)
+		{
+			auto frameStart = chrono::steady_clock::now();
+			frames++;
+			int reloaded = PollGLShaderReloads();
+			SetUniformVecById(shader, MakeUniformId("_Tint"), Color(1.0f, 1.0f, 1.0f, 1.0f));
+			Clear(Color(0.0f, 0.0f, 0.0f, 1.0f), ClearType::ColorAndDepth);
+			SwapBuffer(window);
+			PollEvents();
+			slowest = max(slowest, chrono::duration<double, milli>(chrono::steady_clock::now() - frameStart).count());
+			if (reloaded > 0 || frames > 1000)
+				break;
+		}
+		auto ms = chrono::duration<double, milli>(chrono::steady_clock::now() - written).count();
+		totalMs += ms;
+		cout << edit << "\t" << ms << "\t" << frames << "\t" << slowest << endl;
+	}
+	cout << "average latency ms\t" << totalMs / Edits << endl;
+
+	DestroyShader(shader);
+	Terminate();
+	return 0;
+}
@@ -0,0 +1,108 @@
+#include <ResRenderer.hpp>
+#include <ResRendererSoftware.hpp>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace ResRenderer;
+
+//Renders a scene of many small overlapping triangles plus a few big ones,
+//reports triangles and pixels per second for every thread count.
+
+static const int Width = 1920;
+static const int Height = 1080;
+static const int FramesPerRun = 20;
+
+static void BuildScene(vector<float>& vertices, vector<VertexIndex_t>& indices, int triangleCount) {
+	mt19937 rng(1234);
+	uniform_real_distribution<float> pos(-1.0f, 1.0f);
+	uniform_real_distribution<float> size(0.002f, 0.02f);
+	uniform_real_distribution<float> unit(0.0f, 1.0f);
+	for (int i = 0; i < triangleCount; i++)
+	{
+		float cx = pos(rng), cy = pos(rng), z = pos(rng);
+		//Every 10000th triangle is a big one.
+		float s = (i % 10000 == 0) ? 0.8f : size(rng);
+		float corners[3][2] = { { cx - s, cy - s }, { cx + s, cy - s }, { cx, cy + s } };
+		for (int v = 0; v < 3; v++)
+		{
+			float vert[] = { corners[v][0], corners[v][1], z, unit(rng), unit(rng), unit(rng) };
+			vertices.insert(vertices.end(), vert, vert + 6);
+			indices.push_back(static_cast<VertexIndex_t>(indices.size()));
+		}
+	}
+}
+
+int main() {
+	if (!Init()) {
+		cerr << "Init failed" << endl;
+		return 1;
+	}
+
+	Window window;
+	if (CreateResWindow(Width, Height, "Benchmark", &window) != ErrorCode::RES_NO_ERROR) {
+		cerr << "Window creation failed" << endl;
+		return 1;
+	}
+
+	vector<float> vertices;
+	vector<VertexIndex_t> indices;
+	BuildScene(vertices, indices, 200000);
+
+	Mesh mesh;
+	CreateMesh(&mesh);
+	MeshData meshData;
+	MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 3, false);
+	MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 3, false);
+	meshData.data = vertices.data();
+	meshData.dataSize = vertices.size() * sizeof(float);
+	meshData.vertCount = static_cast<int>(vertices.size() / 6);
+	meshData.indicies = indices.data();
+	meshData.indiciesCount = indices.size();
+	if (UploadMeshData(mesh, &meshData) != ErrorCode::RES_NO_ERROR) {
+		cerr << "Upload failed" << endl;
+		return 1;
+	}
+
+	int maxThreads = 0;
+	SetRasterizerThreadCount(0);
+	maxThreads = GetRasterizerThreadCount();
+
+	vector<int> threadCounts;
+	for (int t = 1; t < maxThreads; t *= 2)
+		threadCounts.push_back(t);
+	threadCounts.push_back(maxThreads);
+
+	cout << "threads\tms/frame\tMtri/s\tMpixel/s" << endl;
+	for (auto threads : threadCounts)
+	{
+		SetRasterizerThreadCount(threads);
+		//Warm up.
+		Clear(Color(0.0f, 0.0f, 0.0f, 1.0f), ClearType::ColorAndDepth);
+		DrawMesh(mesh);
+		SwapBuffer(window);
+		ResetRasterizerStats();
+
+		auto start = chrono::steady_clock::now();
+		for (int frame = 0; frame < FramesPerRun; frame++)
+		{
+			Clear(Color(0.0f, 0.0f, 0.0f, 1.0f), ClearType::ColorAndDepth);
+			DrawMesh(mesh);
+			SwapBuffer(window);
+		}
+		chrono::duration<double> seconds = chrono::steady_clock::now() - start;
+
+		RasterizerStats stats;
+		GetRasterizerStats(&stats);
+		cout << threads << "\t"
+			<< seconds.count() * 1000.0 / FramesPerRun << "\t"
+			<< stats.triangles / seconds.count() / 1e6 << "\t"
+			<< stats.pixels / seconds.count() / 1e6 << endl;
+	}
+
+	DestroyMesh(mesh);
+	Terminate();
+	return 0;
+}
@@ -0,0 +1,153 @@
+#include <ResRenderer.hpp>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace ResRenderer;
+
+//Draws with 4 vec4s of material data each. Plain uniforms need 4 SetUniformVec per draw, uniform buffers are
+//filled once per material and only bound per draw. Reports submit(CPU) and frame time.
+
+static const int Materials = 64;
+static const int Repeats = 5;
+
+static const char* UniformShaderSource = ""
+	"VertData(pos, 0, vec2);\n"
+	"uniform vec4 _Offset;\n"
+	"uniform vec4 _Scale;\n"
+	"uniform vec4 _Tint;\n"
+	"uniform vec4 _Fade;\n"
+	"#ifdef VERTEX\n"
+	"vec4 vertex() { return vec4(pos * _Scale.xy + _Offset.xy, 0.0, 1.0); }\n"
+	"#else\n"
+	"vec4 fragment() { return _Tint * _Fade.x; }\n"
+	"#endif\n";
+
+static const char* BlockShaderSource = ""
+	"VertData(pos, 0, vec2);\n"
+	"layout(std140) uniform Material {\n"
+	"	vec4 _Offset;\n"
+	"	vec4 _Scale;\n"
+	"	vec4 _Tint;\n"
+	"	vec4 _Fade;\n"
+	"};\n"
+	"#ifdef VERTEX\n"
+	"vec4 vertex() { return vec4(pos * _Scale.xy + _Offset.xy, 0.0, 1.0); }\n"
+	"#else\n"
+	"vec4 fragment() { return _Tint * _Fade.x; }\n"
+	"#endif\n";
+
+//std140 layout of the Material block.
+struct MaterialData {
+	float values[4][4];
+};
+
+static Shader Compile(const char* source) {
+	Shader shader;
+	CreateShader(&shader);
+	char log[1024];
+	if (CompileShader(shader, source, log, sizeof(log), nullptr) != ErrorCode::RES_NO_ERROR)
+		cerr << log << endl;
+	return shader;
+}
+
+int main() {
+	Init();
+	Window window;
+	if (CreateResWindow(512, 512, "Benchmark", &window) != ErrorCode::RES_NO_ERROR) {
+		cerr << "Window creation failed" << endl;
+		return 1;
+	}
+
+	Mesh mesh;
+	CreateMesh(&mesh);
+	MeshData meshData;
+	MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 2, false);
+	float vertices[] = { -1.0f, -1.0f, 1.0f, -1.0f, 0.0f, 1.0f };
+	VertexIndex_t indicies[] = { 0, 1, 2 };
+	meshData.data = vertices;
+	meshData.dataSize = sizeof(vertices);
+	meshData.vertCount = 3;
+	meshData.indicies = indicies;
+	meshData.indiciesCount = 3;
+	UploadMeshData(mesh, &meshData);
+
+	mt19937 random(1);
+	uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	vector<MaterialData> materials(Materials);
+	vector<UniformBuffer> buffers(Materials);
+	for (int i = 0; i < Materials; i++)
+	{
+		auto& m = materials[i];
+		float values[4][4] = {
+			{ dist(random), dist(random), 0.0f, 0.0f },
+			{ 0.02f, 0.02f, 1.0f, 1.0f },
+			{ dist(random) * 0.5f + 0.5f, dist(random) * 0.5f + 0.5f, dist(random) * 0.5f + 0.5f, 1.0f },
+			{ 1.0f, 0.0f, 0.0f, 0.0f },
+		};
+		memcpy(m.values, values, sizeof(values));
+		CreateUniformBuffer(sizeof(MaterialData), &buffers[i]);
+		UpdateUniformBuffer(buffers[i], &m, sizeof(MaterialData));
+	}
+
+	auto uniformShader = Compile(UniformShaderSource);
+	int locations[4];
+	const char* names[] = { "_Offset", "_Scale", "_Tint", "_Fade" };
+	for (int i = 0; i < 4; i++)
+		GetUniformLocation(uniformShader, names[i], &locations[i]);
+	auto blockShader = Compile(BlockShaderSource);
+	SetUniformBlockSlot(blockShader, "Material", 0);
+
+	vector<unsigned char> pixels(512 * 512 * 4);
+	cout << "draws\tmode\tsubmit ms\tframe ms" << endl;
+	for (int draws : { 10000, 30000 })
+	{
+		vector<int> order(draws);
+		uniform_int_distribution<int> materialDist(0, Materials - 1);
+		for (auto& material : order)
+			material = materialDist(random);
+
+		for (int mode = 0; mode < 2; mode++)
+		{
+			double submitSeconds = 0.0, frameSeconds = 0.0;
+			for (int repeat = 0; repeat < Repeats; repeat++)
+			{
+				Clear(Color(0.0f, 0.0f, 0.0f, 1.0f), ClearType::ColorAndDepth);
+				auto start = chrono::steady_clock::now();
+				UseShader(mode == 0 ? uniformShader : blockShader);
+				for (auto material : order)
+				{
+					if (mode == 0) {
+						for (int i = 0; i < 4; i++)
+						{
+							auto v = materials[material].values[i];
+							SetUniformVec(uniformShader, locations[i], Color(v[0], v[1], v[2], v[3]));
+						}
+					}
+					else {
+						BindUniformBuffer(buffers[material], 0);
+					}
+					DrawMesh(mesh);
+				}
+				auto submitted = chrono::steady_clock::now();
+				ReadWindowPixels(window, pixels.data(), pixels.size());
+				auto finished = chrono::steady_clock::now();
+				submitSeconds += chrono::duration<double>(submitted - start).count();
+				frameSeconds += chrono::duration<double>(finished - start).count();
+			}
+			cout << draws << "\t" << (mode == 0 ? "SetUniformVec" : "UniformBuffer") << "\t"
+				<< submitSeconds * 1000.0 / Repeats << "\t" << frameSeconds * 1000.0 / Repeats << endl;
+		}
+	}
+
+	for (auto buffer : buffers)
+		DestroyUniformBuffer(buffer);
+	DestroyShader(blockShader);
+	DestroyShader(uniformShader);
+	DestroyMesh(mesh);
+	Terminate();
+	return 0;
+}
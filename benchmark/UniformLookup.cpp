@@ -0,0 +1,91 @@
+#include <ResRenderer.hpp>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace ResRenderer;
+
+//CPU cost of setting a uniform when the location is looked up every draw: by name(string hash and compare),
+//by compile-time id, and with a location cached by the caller as the baseline.
+
+static const int Draws = 20000;
+static const int Repeats = 10;
+
+static const char* ShaderSource = ""
+	"VertData(pos, 0, vec3);\n"
+	"uniform vec4 _Offset;\n"
+	"uniform vec4 _Tint;\n"
+	"#ifdef VERTEX\n"
+	"vec4 vertex() { return vec4(pos + _Offset.xyz, 1.0); }\n"
+	"#else\n"
+	"vec4 fragment() { return _Tint; }\n"
+	"#endif\n";
+
+int main() {
+	Init();
+	Window window;
+	if (CreateResWindow(64, 64, "Benchmark", &window) != ErrorCode::RES_NO_ERROR) {
+		cerr << "Window creation failed" << endl;
+		return 1;
+	}
+
+	Mesh mesh;
+	CreateMesh(&mesh);
+	MeshData meshData;
+	MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 3, false);
+	float vertices[] = { 0.01f, -0.01f, 0.0f, -0.01f, -0.01f, 0.0f, 0.0f, 0.01f, 0.0f };
+	VertexIndex_t indicies[] = { 0, 1, 2 };
+	meshData.data = vertices;
+	meshData.dataSize = sizeof(vertices);
+	meshData.vertCount = 3;
+	meshData.indicies = indicies;
+	meshData.indiciesCount = 3;
+	UploadMeshData(mesh, &meshData);
+
+	Shader shader;
+	CreateShader(&shader);
+	char log[1024];
+	CompileShader(shader, ShaderSource, log, sizeof(log), nullptr);
+	UseShader(shader);
+	int location;
+	GetUniformLocation(shader, "_Tint", &location);
+	constexpr UniformId tintId = MakeUniformId("_Tint");
+
+	const char* names[] = { "cached location", "by name", "by id" };
+	vector<unsigned char> pixels(64 * 64 * 4);
+	cout << "lookup\tns per draw" << endl;
+	for (int mode = 0; mode < 3; mode++)
+	{
+		double seconds = 0.0;
+		for (int repeat = 0; repeat < Repeats; repeat++)
+		{
+			auto start = chrono::steady_clock::now();
+			for (int i = 0; i < Draws; i++)
+			{
+				auto color = Color(i / static_cast<float>(Draws), 0.0f, 0.0f, 1.0f);
+				if (mode == 0) {
+					SetUniformVec(shader, location, color);
+				}
+				else if (mode == 1) {
+					int t;
+					GetUniformLocation(shader, "_Tint", &t);
+					SetUniformVec(shader, t, color);
+				}
+				else {
+					SetUniformVecById(shader, tintId, color);
+				}
+				DrawMesh(mesh);
+			}
+			seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+			//Keep the driver queue from growing between repeats, not measured.
+			ReadWindowPixels(window, pixels.data(), pixels.size());
+		}
+		cout << names[mode] << "\t" << seconds * 1e9 / (static_cast<double>(Draws) * Repeats) << endl;
+	}
+
+	DestroyShader(shader);
+	DestroyMesh(mesh);
+	Terminate();
+	return 0;
+}
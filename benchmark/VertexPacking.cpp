@@ -0,0 +1,73 @@
+#include <ResRenderer.hpp>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace ResRenderer;
+
+//Vertex size of a typical position, normal, uv, color layout in floats vs compact formats, and PackVertexAttrib
+//throughput per format, tightly packed and interleaved. CPU only, runs with any backend.
+
+static const size_t Vertices = 1 << 22;
+static const int Repeats = 5;
+
+struct Format {
+	const char* name;
+	VertexAttribType type;
+	int count;
+	bool normalize;
+};
+
+static double PackGBPerSecond(const VertexAttribDescription& desc, const vector<float>& src, void* dst, size_t stride) {
+	PackVertexAttrib(&desc, src.data(), Vertices, dst, stride);
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < Repeats; i++)
+		PackVertexAttrib(&desc, src.data(), Vertices, dst, stride);
+	auto seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	return Vertices * desc.count * sizeof(float) * Repeats / seconds / 1e9;
+}
+
+int main() {
+	MeshData floats;
+	MeshDataAppendAttrib(&floats, VertexAttribType::ResFloat, 3, false);
+	MeshDataAppendAttrib(&floats, VertexAttribType::ResFloat, 3, false);
+	MeshDataAppendAttrib(&floats, VertexAttribType::ResFloat, 2, false);
+	MeshDataAppendAttrib(&floats, VertexAttribType::ResFloat, 4, false);
+	MeshData compact;
+	MeshDataAppendAttrib(&compact, VertexAttribType::ResFloat, 3, false);
+	MeshDataAppendAttrib(&compact, VertexAttribType::ResInt10_10_10_2, 4, true);
+	MeshDataAppendAttrib(&compact, VertexAttribType::ResHalfFloat, 2, false);
+	MeshDataAppendAttrib(&compact, VertexAttribType::ResUnsignedByte, 4, true);
+	cout << "layout\tbytes per vertex" << endl;
+	cout << "float\t" << GetMeshVertexSize(&floats) << endl;
+	cout << "compact\t" << GetMeshVertexSize(&compact) << endl << endl;
+
+	Format formats[] = {
+		{ "half4", VertexAttribType::ResHalfFloat, 4, false },
+		{ "snorm16x4", VertexAttribType::ResShort, 4, true },
+		{ "unorm8x4", VertexAttribType::ResUnsignedByte, 4, true },
+		{ "snorm8x4", VertexAttribType::ResByte, 4, true },
+		{ "snorm10_10_10_2", VertexAttribType::ResInt10_10_10_2, 4, true },
+	};
+	mt19937 random(1234);
+	uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	vector<float> src(Vertices * 4);
+	for (auto& f : src)
+		f = distribution(random);
+	auto stride = GetMeshVertexSize(&compact);
+	vector<unsigned char> dst(Vertices * stride);
+
+	cout << "format\tpacked GB/s\tinterleaved GB/s(float input)" << endl;
+	for (auto& format : formats)
+	{
+		MeshData t;
+		MeshDataAppendAttrib(&t, format.type, format.count, format.normalize);
+		auto& desc = t.attribDescriptions[0];
+		auto packed = PackGBPerSecond(desc, src, dst.data(), 0);
+		auto interleaved = PackGBPerSecond(desc, src, dst.data(), stride);
+		cout << format.name << "\t" << packed << "\t" << interleaved << endl;
+	}
+	return 0;
+}
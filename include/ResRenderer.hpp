@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include "ResCommon.hpp"
 #include "ResMath.hpp"
@@ -26,6 +27,12 @@ namespace ResRenderer {
 		MESH_DATA_ATTRIB_OVERFLOW,
 		MESH_DATA_LENGTH_ERROR,
 		MESH_NOT_CREATED,
+		BUFFER_TOO_SMALL,
+		SHADER_KEYWORD_INVALID,
+		MESH_DATA_INDEX_OUT_OF_RANGE,
+		MESH_DATA_NOT_FINITE,
+		FILE_ERROR,
+		MESH_FILE_INVALID,
 	};
 
 	typedef void* Mesh;
@@ -33,6 +40,13 @@ namespace ResRenderer {
 	typedef void* Shader;
 	typedef void* Window;
 	typedef void* FrameBuffer;
+	typedef void* CommandList;
+	typedef void* DrawQueue;
+	typedef void* InstanceBuffer;
+	typedef void* MeshBatch;
+	typedef void* UniformBuffer;
+	typedef void* ShaderVariants;
+	typedef void* MeshFile;
 
 	bool RES_RENDERER_API Init();
 	void RES_RENDERER_API Terminate();
@@ -40,10 +54,18 @@ namespace ResRenderer {
 
 	#define MESH_DATA_MAX_ATTRIB_COUNT 10
 
+	//Integer types read as floats in shaders, set normalize to map them to [-1, 1](signed) or [0, 1](unsigned):
+	//snorm16 is ResShort normalized, unorm8 ResUnsignedByte normalized, snorm8 ResByte normalized.
 	enum class VertexAttribType {
 		ResFloat,
+		ResHalfFloat,
+		ResShort,
+		ResUnsignedByte,
+		ResByte,
+		ResInt10_10_10_2,	//Signed x, y, z of 10 bits and w of 2 packed into 4 bytes, x in the lowest bits. count must be 4.
 	};
 
+	//Per component, ResInt10_10_10_2 counts as 1.
 	size_t GetVertexAttribSize(VertexAttribType type);
 
 	//MeshData, as helper class. It's not implemented platform-specific, so just use class style.
@@ -64,13 +86,142 @@ namespace ResRenderer {
 		size_t indiciesCount = 0;
 	};
 	ErrorCode RES_RENDERER_API MeshDataAppendAttrib(MeshData* data, VertexAttribType type, int count, bool normalize);
+	//How much MeshDataVerify checks. Layout is sizes and pointers only. Full also scans the contents: every index must be
+	//below vertCount(MESH_DATA_INDEX_OUT_OF_RANGE), no NaN or infinity in float and half float attributes(MESH_DATA_NOT_FINITE).
+	//The scan is vectorized and split across threads for large meshes, it runs near memory bandwidth.
+	enum class MeshDataValidation {
+		Layout = 0,
+		Full = 1,
+	};
+	//Level of every MeshDataVerify without one, which includes all uploads. Layout by default.
+	void RES_RENDERER_API SetMeshDataValidation(MeshDataValidation level);
+	MeshDataValidation RES_RENDERER_API GetMeshDataValidation();
 	ErrorCode RES_RENDERER_API MeshDataVerify(const MeshData* data);
+	ErrorCode RES_RENDERER_API MeshDataVerify(const MeshData* data, MeshDataValidation level);
+	bool RES_RENDERER_API MeshDataSameLayout(const MeshData* a, const MeshData* b);
 	size_t RES_RENDERER_API GetMeshVertexSize(const MeshData* data);
+
+	//Simulates a FIFO post-transform vertex cache of cacheSize entries over the index buffer.
+	struct VertexCacheStats {
+		float acmr = 0.0f;		//Vertex shader runs per triangle. 3 without any reuse.
+		float atvr = 0.0f;		//Vertex shader runs per vertex. 1 is optimal.
+		float hitRate = 0.0f;	//Fraction of indices served from the cache.
+	};
+	ErrorCode RES_RENDERER_API MeshDataAnalyzeVertexCache(const MeshData* data, int cacheSize, VertexCacheStats* outStats);
+	//Converts vertCount vertices of desc.count floats each, tightly packed in src, to desc's format.
+	//Vertices are written dstStride bytes apart, so dst can point at the attribute inside interleaved vertex data.
+	//0 means tightly packed. Vectorized with AVX2 and F16C where the CPU has them.
+	ErrorCode RES_RENDERER_API PackVertexAttrib(const VertexAttribDescription* desc, const float* src, size_t vertCount, void* dst, size_t dstStride = 0);
+	//Reorders triangles for a post-transform vertex cache of cacheSize entries, then groups of them front to back
+	//for less overdraw(needs float positions of 3+ components at attribute 0), then vertices in order of first use.
+	//Works in place, the mesh renders the same. Best done once offline or at load, before UploadMeshData.
+	ErrorCode RES_RENDERER_API OptimizeMeshData(MeshData* data, int cacheSize = 16);
+
+	//Mesh files.
+	//.resmesh is MeshData as it is in memory: a versioned header with the layout and counts, then vertex data and indicies,
+	//each 64 byte aligned. Little endian only.
+	ErrorCode RES_RENDERER_API SaveMeshFile(const char* path, const MeshData* data);
+	//Maps the file and points outData's data and indicies into the mapping, nothing is read or copied up front, pages come in
+	//from disk as the upload touches them. They're copy on write, so in place work like OptimizeMeshData doesn't change the file.
+	//outData stays valid until CloseMeshFile. FILE_ERROR if it can't be opened or mapped, MESH_FILE_INVALID for anything else.
+	ErrorCode RES_RENDERER_API LoadMeshFile(const char* path, MeshFile* outFile, MeshData* outData);
+	void RES_RENDERER_API CloseMeshFile(MeshFile file);
+	//Wavefront OBJ, meant for large scans. The file is mapped and parsed in chunks of lines on all cores. Vertices are
+	//position, then normal and uv if the file has any vn and vt, zero for corners without. Corners with the same
+	//position/uv/normal share a vertex. Vertices follow the file's position order, extra ones for positions used with
+	//several uvs or normals come last. Files with positions only keep unused positions too. Polygons become triangle fans,
+	//everything other than v, vt, vn and f is ignored. outData stays valid until CloseMeshFile(outFile).
+	//FILE_ERROR if it can't be opened, MESH_FILE_INVALID for syntax errors, indices out of range or no faces.
+	ErrorCode RES_RENDERER_API ImportObjFile(const char* path, MeshFile* outFile, MeshData* outData);
+
+	//Level of detail.
+	//Simplifies by collapsing edges with the least quadric error, only through the index buffer, so every level shares
+	//the mesh's vertices. Open borders and seams(vertices split for uv or normals) stay in place.
+	struct MeshLODSettings {
+		int levels = 4;				//Including the full mesh.
+		float reduction = 0.5f;		//Triangles of each level relative to the one before.
+		float maxError = 0.05f;		//Relative to mesh size, no more levels once it would be exceeded.
+	};
+	//outIndicies needs room for data->indiciesCount. outError gets the error relative to mesh size.
+	ErrorCode RES_RENDERER_API SimplifyMeshData(const MeshData* data, size_t targetIndexCount, float maxError,
+		VertexIndex_t* outIndicies, size_t* outIndexCount, float* outError = nullptr);
+
+	//Meshlets.
+	//Clusters of nearby triangles with bounds, for culling below the object level. BuildMeshlets reorders the index buffer
+	//so every meshlet is one contiguous index range, vertices stay where they are.
+	#define MESHLET_MAX_VERTICES 64
+	#define MESHLET_MAX_TRIANGLES 124
+	struct Meshlet {
+		unsigned int firstIndex;
+		unsigned int indexCount;
+		unsigned int vertexCount;
+		float center[3];	//Bounding sphere.
+		float radius;
+		//Normal cone, every triangle faces away from cameras where dot(normalize(coneApex - camera), coneAxis) >= coneCutoff.
+		//Above 1 when the normals spread too much to ever cull.
+		float coneApex[3];
+		float coneAxis[3];
+		float coneCutoff;
+	};
+	struct IndexRange {
+		unsigned int firstIndex;
+		unsigned int indexCount;
+	};
+	//Upper bound of meshlets BuildMeshlets makes out of data.
+	size_t RES_RENDERER_API GetMeshletCountBound(const MeshData* data);
+	//Counter-clockwise front faces. Positions are attribute 0, any type of 3+ components.
+	//BUFFER_TOO_SMALL if more than maxMeshlets are needed.
+	ErrorCode RES_RENDERER_API BuildMeshlets(MeshData* data, Meshlet* outMeshlets, size_t maxMeshlets, size_t* outMeshletCount);
+
+	//All in mesh space.
+	struct MeshletCullView {
+		float planes[6][4];		//Inside where dot(plane.xyz, p) + plane.w >= 0, xyz unit length.
+		float cameraPosition[3];
+	};
+	//modelViewProjection is column major(OpenGL convention), cameraPosition in mesh space.
+	ErrorCode RES_RENDERER_API MakeMeshletCullView(const float* modelViewProjection, const float* cameraPosition, MeshletCullView* outView);
+	//Frustum and backface culls meshlets, 8 at a time with AVX2 where the CPU has it. Visible meshlets next to each other
+	//are merged, outRanges needs room for count ranges and feeds DrawMeshRanges.
+	ErrorCode RES_RENDERER_API CullMeshlets(const Meshlet* meshlets, size_t count, const MeshletCullView* view,
+		IndexRange* outRanges, size_t* outRangeCount, size_t* outVisibleCount = nullptr);
 	
 	//Mesh API.
 	ErrorCode RES_RENDERER_API CreateMesh(Mesh* outMesh);
 	ErrorCode RES_RENDERER_API UploadMeshData(Mesh mesh, const MeshData* data);
+	//UploadMeshData plus simplified levels stored after the full index buffer, for DrawMeshLOD. Every other draw, and the
+	//ranges DrawMeshRanges accepts, keeps to the full mesh.
+	ErrorCode RES_RENDERER_API UploadMeshDataWithLODs(Mesh mesh, const MeshData* data, const MeshLODSettings* settings = nullptr);
 	ErrorCode RES_RENDERER_API DestroyMesh(Mesh mesh);
+	//For geometry uploaded again every frame. Uploads go to streaming memory shared by all dynamic meshes,
+	//which gets reused after a few frames, so upload again in every frame the mesh is drawn.
+	ErrorCode RES_RENDERER_API CreateDynamicMesh(Mesh* outMesh);
+
+	//Instancing.
+	//Per-instance attributes are described like vertex attributes, and advance once per instance.
+	//They take the locations right after the mesh's vertex attributes, e.g. with a mesh of 2 attributes
+	//the first instance attribute is VertData(name, 2, type).
+	struct InstanceData {
+		VertexAttribDescription attribDescriptions[MESH_DATA_MAX_ATTRIB_COUNT];
+		int instanceCount = 0;
+		int attribCount = 0;
+		void* data = nullptr;
+		size_t dataSize = 0;
+	};
+	ErrorCode RES_RENDERER_API InstanceDataAppendAttrib(InstanceData* data, VertexAttribType type, int count, bool normalize);
+	ErrorCode RES_RENDERER_API InstanceDataVerify(const InstanceData* data);
+	size_t RES_RENDERER_API GetInstanceSize(const InstanceData* data);
+
+	ErrorCode RES_RENDERER_API CreateInstanceBuffer(InstanceBuffer* outBuffer);
+	ErrorCode RES_RENDERER_API UploadInstanceData(InstanceBuffer buffer, const InstanceData* data);
+	ErrorCode RES_RENDERER_API DestroyInstanceBuffer(InstanceBuffer buffer);
+
+	//Mesh batches.
+	//Meshes sharing a vertex layout are packed into one vertex and one index buffer, so any list of them is drawn
+	//with a single call(glMultiDrawElementsIndirect where supported). Sub meshes are numbered from 0 in adding order.
+	ErrorCode RES_RENDERER_API CreateMeshBatch(MeshBatch* outBatch);
+	//MESH_DATA_BROKEN if the layout differs from the first mesh added.
+	ErrorCode RES_RENDERER_API MeshBatchAddMesh(MeshBatch batch, const MeshData* data, int* outSubMesh);
+	ErrorCode RES_RENDERER_API DestroyMeshBatch(MeshBatch batch);
 
 	//Texture
 	enum TextureFormat {
@@ -94,11 +245,71 @@ namespace ResRenderer {
 	//Also, upper application should be aware of the underlying shading language.
 	ErrorCode RES_RENDERER_API CreateShader(Shader* outShader);
 	ErrorCode RES_RENDERER_API CompileShader(Shader shader, const char* source, char* compileErrorLog, size_t compileErrorMaxLength, size_t* compileErrorLength);
+	//Asynchronous compiles return right away, many shaders could compile at the same time(e.g. on loading screens).
+	//Until the shader polls as Succeeded or Failed, it must not be used, compiled again or destroyed.
+	enum class ShaderCompileStatus {
+		None,			//No asynchronous compile started.
+		Compiling,
+		Succeeded,
+		Failed,
+	};
+	//Source is copied.
+	ErrorCode RES_RENDERER_API CompileShaderAsync(Shader shader, const char* source);
+	//Never waits for the compile. Log is written when it Failed.
+	ErrorCode RES_RENDERER_API PollShaderCompile(Shader shader, ShaderCompileStatus* outStatus,
+		char* compileErrorLog = nullptr, size_t compileErrorMaxLength = 0, size_t* compileErrorLength = nullptr);
 	ErrorCode RES_RENDERER_API GetUniformLocation(Shader shader, const char* name, int* outLocation);
 	ErrorCode RES_RENDERER_API SetUniformVec(Shader shader, int location, Vector4 v);
+	//Uniform ids are FNV-1a hashes of names, computable at compile time:
+	//  constexpr UniformId tintId = MakeUniformId("_Tint");
+	//Active uniforms are hashed once after linking, so lookups by id never touch strings or the graphics API.
+	//Array elements other than the first have no id, use GetUniformLocation("name[i]") for them.
+	typedef std::uint32_t UniformId;
+	constexpr UniformId MakeUniformId(const char* name, UniformId hash = 2166136261u) {
+		return *name == '\0' ? hash : MakeUniformId(name + 1, (hash ^ static_cast<unsigned char>(*name)) * 16777619u);
+	}
+	//-1 if the shader has no such active uniform. Location could be used with SetUniformVec, command lists and draw queues.
+	ErrorCode RES_RENDERER_API GetUniformLocationById(Shader shader, UniformId id, int* outLocation);
+	//Unknown ids are ignored, like location -1.
+	ErrorCode RES_RENDERER_API SetUniformVecById(Shader shader, UniformId id, Vector4 v);
 	ErrorCode RES_RENDERER_API UseShader(Shader shader);
 	ErrorCode RES_RENDERER_API DestroyShader(Shader shader);
 
+	//Shader variants
+	//One source compiled with different keyword sets, keywords become #defines in front of the source(e.g. "SKINNED ALPHA_TEST").
+	//Variants are compiled on first use and kept. Keywords the source never mentions are ignored, and order doesn't matter,
+	//so keyword sets giving the same preprocessed source share one program.
+	//Variant shaders belong to the set, DestroyShaderVariants destroys them.
+	struct ShaderVariantStats {
+		unsigned int lookups = 0;
+		unsigned int programs = 0;		//Compiled, including failed ones.
+		unsigned int shared = 0;		//Lookups of a keyword set not seen before that found an existing program.
+	};
+	//Source is copied.
+	ErrorCode RES_RENDERER_API CreateShaderVariants(const char* source, ShaderVariants* outVariants);
+	//keywords is whitespace separated, nullptr or "" for none. SHADER_KEYWORD_INVALID if one isn't an identifier.
+	//Compiles and waits if needed. Failed variants keep failing with the same log without compiling again.
+	ErrorCode RES_RENDERER_API GetShaderVariant(ShaderVariants variants, const char* keywords, Shader* outShader,
+		char* compileErrorLog = nullptr, size_t compileErrorMaxLength = 0, size_t* compileErrorLength = nullptr);
+	//Starts asynchronous compiles of the variants a scene needs, so later GetShaderVariant calls don't wait.
+	ErrorCode RES_RENDERER_API PrewarmShaderVariants(ShaderVariants variants, const char* const* keywordSets, int count);
+	//Number of prewarmed variants still compiling.
+	ErrorCode RES_RENDERER_API PollShaderVariants(ShaderVariants variants, int* outPending);
+	ErrorCode RES_RENDERER_API GetShaderVariantStats(ShaderVariants variants, ShaderVariantStats* outStats);
+	ErrorCode RES_RENDERER_API DestroyShaderVariants(ShaderVariants variants);
+
+	//Uniform buffers
+	//Blocks of uniforms(std140 layout in GLSL) uploaded once and shared by every shader reading them, e.g. per-frame
+	//or per-material data. A buffer is bound to a slot, a shader's block reads the slot assigned by SetUniformBlockSlot.
+	#define UNIFORM_BUFFER_MAX_SLOT_COUNT 16
+	ErrorCode RES_RENDERER_API CreateUniformBuffer(size_t size, UniformBuffer* outBuffer);
+	//BUFFER_TOO_SMALL if [offset, offset + size) is outside the buffer. Data is copied, buffer could be updated between draws.
+	ErrorCode RES_RENDERER_API UpdateUniformBuffer(UniformBuffer buffer, const void* data, size_t size, size_t offset = 0);
+	ErrorCode RES_RENDERER_API BindUniformBuffer(UniformBuffer buffer, int slot);
+	//Linking resets the assignment, call after CompileShader. INTERNAL_ERROR if the shader has no such block.
+	ErrorCode RES_RENDERER_API SetUniformBlockSlot(Shader shader, const char* blockName, int slot);
+	ErrorCode RES_RENDERER_API DestroyUniformBuffer(UniformBuffer buffer);
+
 	//FrameBuffer
 	struct FrameBufferDescriptor {
 		int width;
@@ -114,6 +325,17 @@ namespace ResRenderer {
 	void RES_RENDERER_API SetRenderWindow(Window window);   //wglMakeCurrent
 	void RES_RENDERER_API SetRenderTarget(FrameBuffer frameBuffer);
 	ErrorCode RES_RENDERER_API DrawMesh(Mesh mesh);
+	//Draws the first instanceCount instances of the buffer in one call. BUFFER_TOO_SMALL if it holds less.
+	ErrorCode RES_RENDERER_API DrawMeshInstanced(Mesh mesh, InstanceBuffer instances, int instanceCount);
+	//Draws subMeshes[0, count) of the batch in one call. With instances, draw i gets instance i as per-draw data,
+	//BUFFER_TOO_SMALL if the buffer holds less than count.
+	ErrorCode RES_RENDERER_API DrawMeshBatch(MeshBatch batch, const int* subMeshes, int count, InstanceBuffer instances = nullptr);
+	//Draws ranges[0, count) of the mesh's index buffer in one call(glMultiDrawElements), e.g. visible meshlets.
+	//MESH_DATA_LENGTH_ERROR if a range goes past the index buffer.
+	ErrorCode RES_RENDERER_API DrawMeshRanges(Mesh mesh, const IndexRange* ranges, int count);
+	//projectedSize is the mesh's size on screen in pixels, e.g. its projected bounding sphere diameter. Draws the coarsest
+	//level whose error stays under maxPixelError pixels. Meshes uploaded without levels draw as DrawMesh.
+	ErrorCode RES_RENDERER_API DrawMeshLOD(Mesh mesh, float projectedSize, float maxPixelError = 1.0f);
 	
 	enum class ClearType
 	{
@@ -123,6 +345,39 @@ namespace ResRenderer {
 	};
 	void RES_RENDERER_API Clear(Color color, ClearType clearType);
 
+	//Command lists
+	//Recording only writes to the list's own memory, so lists could be recorded on worker threads in parallel,
+	//as long as one list is used by one thread at a time. Submitting replays them in order, on the API thread.
+	//Handles must stay alive until submitted, errors of recorded commands are returned by SubmitCommandLists.
+	ErrorCode RES_RENDERER_API CreateCommandList(CommandList* outList);
+	ErrorCode RES_RENDERER_API ResetCommandList(CommandList list);
+	ErrorCode RES_RENDERER_API DestroyCommandList(CommandList list);
+	ErrorCode RES_RENDERER_API CmdUseShader(CommandList list, Shader shader);
+	ErrorCode RES_RENDERER_API CmdSetUniformVec(CommandList list, Shader shader, int location, Vector4 v);
+	ErrorCode RES_RENDERER_API CmdDrawMesh(CommandList list, Mesh mesh);
+	ErrorCode RES_RENDERER_API SubmitCommandLists(const CommandList* lists, int count);
+
+	//Draw queue
+	//Every queued draw gets a 64 bit key: render target(8 bits) | shader(16 bits) | mesh(16 bits) | depth(24 bits),
+	//and draws are radix sorted by key on submit, so render target, program and vertex array switches are minimized.
+	//depth is in [0, 1], smaller is drawn first. Uniform values are copied and set right before their draw.
+	//After submit the queue is empty. Submit sets the render target of each draw and doesn't restore the one set before,
+	//the target of the last draw stays set, call SetRenderTarget again before drawing directly.
+	struct DrawQueueStats {
+		unsigned int draws = 0;
+		unsigned int targetSwitches = 0;
+		unsigned int shaderSwitches = 0;
+		unsigned int meshSwitches = 0;
+		unsigned int unsortedShaderSwitches = 0;	//Switches submit order would have caused.
+		unsigned int unsortedMeshSwitches = 0;
+		float sortMilliseconds = 0.0f;
+	};
+	ErrorCode RES_RENDERER_API CreateDrawQueue(DrawQueue* outQueue);
+	ErrorCode RES_RENDERER_API QueueDrawMesh(DrawQueue queue, FrameBuffer target, Shader shader, Mesh mesh, float depth,
+		const int* uniformLocations = nullptr, const Vector4* uniformValues = nullptr, int uniformCount = 0);
+	ErrorCode RES_RENDERER_API SubmitDrawQueue(DrawQueue queue, DrawQueueStats* outStats = nullptr);
+	ErrorCode RES_RENDERER_API DestroyDrawQueue(DrawQueue queue);
+
 
 	typedef void(*WindowResizeCallback)(int, int);
 	ErrorCode RES_RENDERER_API CreateResWindow(int width, int height, const char* title, Window* outWindow);
@@ -131,4 +386,18 @@ namespace ResRenderer {
 	void RES_RENDERER_API SwapBuffer(Window window);
 	void RES_RENDERER_API PollEvents();
 
+	//Async rendering.
+	//Must be called after Init and before the first CreateResWindow. Rendering calls are then recorded and executed in order
+	//by a render thread owning the context. Calls returning data(Create*, CompileShader, GetUniformLocation...) wait for it,
+	//errors of the other calls are printed to std::cerr instead of being returned.
+	//SwapBuffer blocks when caller runs more than framesInFlight frames ahead of the render thread.
+	ErrorCode RES_RENDERER_API EnableRenderThread(int framesInFlight);
+
+	//Batch jobs.
+	//After frameCount SwapBuffer calls, ShouldCloseWindow returns true. 0 means no limit.
+	//Built with RES_HEADLESS, windows are offscreen surfaces and this is the only way they get closed.
+	void RES_RENDERER_API SetWindowFrameLimit(Window window, int frameCount);
+	//Reads back the window's color buffer as RGBA8, rows are bottom-up. bufferSize must be at least width * height * 4.
+	ErrorCode RES_RENDERER_API ReadWindowPixels(Window window, void* outPixels, size_t bufferSize);
+
 }
@@ -0,0 +1,30 @@
+#pragma once
+#include "ResRenderer.hpp"
+
+//Extra controls only available when built with RES_USE_NULL.
+//The null backend validates arguments like the real ones but never touches a graphics API,
+//so it could be used to measure the cost of ResRenderer itself.
+
+namespace ResRenderer {
+
+	struct NullBackendStats {
+		unsigned long long apiCalls = 0;		//Every API function, including the ones below.
+		unsigned long long meshUploads = 0;
+		unsigned long long instanceUploads = 0;
+		unsigned long long uploadedBytes = 0;	//Vertex, index and instance data.
+		unsigned long long drawCalls = 0;
+		unsigned long long drawnIndices = 0;	//Of all instances.
+		unsigned long long drawnInstances = 0;	//DrawMesh draws one.
+		unsigned long long uniformSets = 0;
+		unsigned long long uniformBytes = 0;		//SetUniformVec and UpdateUniformBuffer.
+		unsigned long long uniformBufferUpdates = 0;
+		unsigned long long uniformBufferBinds = 0;
+		unsigned long long shaderUses = 0;
+		unsigned long long shaderCompiles = 0;
+		unsigned long long clears = 0;
+		unsigned long long swaps = 0;
+		unsigned long long failedCalls = 0;		//Calls returned an error.
+	};
+	void RES_RENDERER_API GetNullBackendStats(NullBackendStats* outStats);
+	void RES_RENDERER_API ResetNullBackendStats();
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "ResRenderer.hpp"
+
+//Extra controls only available with the OpenGL backend.
+
+namespace ResRenderer {
+
+	struct GLStateCounter {
+		unsigned long long issued = 0;		//Reached the driver.
+		unsigned long long elided = 0;		//Skipped, state already matched.
+	};
+
+	//The backend shadows bind state, calls that would not change it never reach the driver.
+	struct GLStateCacheStats {
+		GLStateCounter program;
+		GLStateCounter vertexArray;
+		GLStateCounter arrayBuffer;
+		GLStateCounter elementBuffer;
+		GLStateCounter frameBuffer;
+		GLStateCounter viewport;
+		GLStateCounter clearColor;
+		GLStateCounter uniformBuffer;		//Generic and indexed(slot) bindings.
+		GLStateCounter total;				//Sum of above.
+	};
+	//Waits for the render thread, if there's one.
+	void RES_RENDERER_API GetGLStateCacheStats(GLStateCacheStats* outStats);
+	void RES_RENDERER_API ResetGLStateCacheStats();
+
+	enum class GLValidationLevel {
+		None = 0,			//Release, no error checking at all.
+		DebugOutput = 1,	//Driver messages through KHR_debug, reported to stderr. No pipeline syncs.
+		Full = 2,			//Also glGetError after every call, errors fail the call.
+	};
+	//Levels above the one compiled in(RES_GL_VALIDATION) are clamped, returns the level in effect.
+	//Debug contexts are requested for windows created later, so set it before creating windows.
+	GLValidationLevel RES_RENDERER_API SetGLValidationLevel(GLValidationLevel level);
+	GLValidationLevel RES_RENDERER_API GetGLValidationLevel();
+
+	//Dynamic meshes(CreateDynamicMesh) are written into a persistently mapped ring when GL 4.4 or ARB_buffer_storage is available.
+	struct GLStreamingStats {
+		unsigned long long streamedBytes = 0;	//Vertex and index bytes written to mapped memory.
+		unsigned long long fenceWaits = 0;		//Times the CPU caught up with the GPU and had to wait for a slice.
+		unsigned long long fallbackUploads = 0;	//Uploads that went through glBufferData, unsupported or frame's slice full.
+	};
+	//Waits for the render thread, if there's one.
+	void RES_RENDERER_API GetGLStreamingStats(GLStreamingStats* outStats);
+	void RES_RENDERER_API ResetGLStreamingStats();
+
+	//Linked programs are cached as driver binaries in directory, if GL 4.1 or ARB_get_program_binary is available.
+	//Files are keyed by shader source and driver(vendor, renderer, version), so after driver updates they're just missed.
+	//Directory must exist. nullptr or "" disables the cache, which is the default.
+	void RES_RENDERER_API SetGLProgramCacheDirectory(const char* directory);
+	struct GLProgramCacheStats {
+		unsigned long long hits = 0;
+		unsigned long long misses = 0;		//Compiled from source, including rejected ones.
+		unsigned long long rejected = 0;	//Cached binaries the driver refused, they're deleted.
+		unsigned long long stores = 0;
+	};
+	//Waits for the render thread, if there's one.
+	void RES_RENDERER_API GetGLProgramCacheStats(GLProgramCacheStats* outStats);
+	void RES_RENDERER_API ResetGLProgramCacheStats();
+
+	//Shader hot reload(Linux only, inotify). Whenever the file is written, it's compiled again on a background context,
+	//or with KHR_parallel_shader_compile if no context could be shared. Watching fails if there's neither.
+	//The program inside shader is replaced once compile and link succeed. Failures are reported to stderr, the old
+	//program stays. Uniform locations could change with the program, look them up again or use uniform ids. Uniform values
+	//and block bindings carry over to the new program for uniforms with the same name and type.
+	//Watching doesn't compile the shader, compile it as usual first.
+	ErrorCode RES_RENDERER_API WatchGLShaderFile(Shader shader, const char* path);
+	ErrorCode RES_RENDERER_API UnwatchGLShaderFile(Shader shader);
+	//Call once per frame on API thread, never waits for compiles. Returns how many shaders got a new program.
+	int RES_RENDERER_API PollGLShaderReloads();
+}
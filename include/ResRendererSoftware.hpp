@@ -0,0 +1,30 @@
+#pragma once
+#include "ResRenderer.hpp"
+
+//Extra controls only available when built with RES_USE_SOFTWARE.
+
+namespace ResRenderer {
+
+	/*
+	Software backend notes:
+	There's no shader compiler, shaders are accepted but not executed. Instead a fixed pipeline is used:
+	attribute 0 is clip space position(2~4 floats, w defaults to 1), attribute 1 is vertex color(3~4 floats, white if missing).
+	Vertex color is multiplied by the "_Tint" uniform of current shader, if it's set.
+	With DrawMeshInstanced, instance attribute 0 is added to position(1~4 floats), instance attribute 1 multiplies color.
+	Uniform buffers only keep their data, the fixed pipeline doesn't read them.
+	Triangles are clipped against w = 0 and a guard band far around the viewport. Like the OpenGL backend there's no depth
+	test, triangles are drawn in submit order and pixels with depth outside [0, 1] are dropped. There's no depth buffer.
+	*/
+
+	//0 means use all hardware threads.
+	void RES_RENDERER_API SetRasterizerThreadCount(int count);
+	int RES_RENDERER_API GetRasterizerThreadCount();
+
+	struct RasterizerStats {
+		unsigned long long triangles = 0;		//Triangles that survived setup and got binned.
+		unsigned long long pixels = 0;			//Pixels passing coverage test.
+		unsigned long long tileJobs = 0;		//(tile, flush) pairs that had work.
+	};
+	void RES_RENDERER_API GetRasterizerStats(RasterizerStats* outStats);
+	void RES_RENDERER_API ResetRasterizerStats();
+}
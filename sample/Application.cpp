@@ -3,6 +3,7 @@
 #include <iostream>
 #include <sstream>
 #include <cmath>
+#include <cstdlib>
 
 using namespace std;
 using namespace ResRenderer;
@@ -25,7 +26,7 @@ std::string LoadSourceFromFile(const char* filePath) {
 	return ss.str();
 }
 
-int main(){
+int main(int argc, char** argv){
 	if (!ResRenderer::Init()) {
 		cout << "Failed" << endl;
 		return 0;
@@ -33,6 +34,9 @@ int main(){
 
 	ResRenderer::Window pWindow;
     if (ResRenderer::CreateResWindow(800, 600, "233", &pWindow) == ErrorCode::RES_NO_ERROR){
+		//Optional frame count, so batch jobs(e.g. headless build) terminate.
+		if (argc > 1)
+			SetWindowFrameLimit(pWindow, atoi(argv[1]));
 		/*
 		Mesh mesh;
 		CHECKERROR(CreateMesh(&mesh));
@@ -0,0 +1,61 @@
+#include <ResRenderer.hpp>
+#include <ResCommandList.hpp>
+
+//Recording is backend independent and touches no graphics API, SubmitCommandLists is implemented by backends.
+
+namespace ResRenderer {
+
+	ErrorCode RES_RENDERER_API CreateCommandList(CommandList* outList) {
+		if (outList == nullptr)
+			return ErrorCode::INTERNAL_ERROR;
+		*outList = static_cast<CommandList>(new CommandListImpl());
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API ResetCommandList(CommandList list) {
+		if (list == nullptr)
+			return ErrorCode::INTERNAL_ERROR;
+		static_cast<CommandListImpl*>(list)->Reset();
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API DestroyCommandList(CommandList list) {
+		delete static_cast<CommandListImpl*>(list);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API CmdUseShader(CommandList list, Shader shader) {
+		if (list == nullptr || shader == nullptr)
+			return ErrorCode::INTERNAL_ERROR;
+		RecordedCommand command = RecordedCommand();
+		command.type = RecordedCommandType::UseShader;
+		command.object = shader;
+		static_cast<CommandListImpl*>(list)->Push(command);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API CmdSetUniformVec(CommandList list, Shader shader, int location, Vector4 v) {
+		if (list == nullptr || shader == nullptr)
+			return ErrorCode::INTERNAL_ERROR;
+		RecordedCommand command = RecordedCommand();
+		command.type = RecordedCommandType::SetUniformVec;
+		command.object = shader;
+		command.location = location;
+		command.v[0] = v.x;
+		command.v[1] = v.y;
+		command.v[2] = v.z;
+		command.v[3] = v.w;
+		static_cast<CommandListImpl*>(list)->Push(command);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API CmdDrawMesh(CommandList list, Mesh mesh) {
+		if (list == nullptr || mesh == nullptr)
+			return ErrorCode::INTERNAL_ERROR;
+		RecordedCommand command = RecordedCommand();
+		command.type = RecordedCommandType::DrawMesh;
+		command.object = mesh;
+		static_cast<CommandListImpl*>(list)->Push(command);
+		return ErrorCode::RES_NO_ERROR;
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <ResRenderer.hpp>
+#include <memory>
+#include <vector>
+
+//Recorded commands, shared by all backends. Each backend replays them in its SubmitCommandLists.
+
+namespace ResRenderer {
+
+	enum class RecordedCommandType {
+		UseShader,
+		SetUniformVec,
+		DrawMesh,
+	};
+
+	struct RecordedCommand {
+		RecordedCommandType type;
+		int location;
+		void* object;	//Shader or Mesh.
+		float v[4];
+	};
+
+	//Commands live in fixed size chunks, so recording never moves memory, and Reset keeps chunks for reuse.
+	class CommandListImpl {
+	public:
+		void Push(const RecordedCommand& command) {
+			auto chunk = count / ChunkCommands;
+			if (chunk == chunks.size())
+				chunks.emplace_back(new RecordedCommand[ChunkCommands]);
+			chunks[chunk][count % ChunkCommands] = command;
+			count++;
+		}
+
+		template<typename F>
+		void ForEach(F func) const {
+			size_t remaining = count;
+			for (size_t c = 0; remaining > 0; c++)
+			{
+				size_t n = remaining < ChunkCommands ? remaining : ChunkCommands;
+				const RecordedCommand* commands = chunks[c].get();
+				for (size_t i = 0; i < n; i++)
+					func(commands[i]);
+				remaining -= n;
+			}
+		}
+
+		void AppendTo(std::vector<RecordedCommand>& out) const {
+			out.reserve(out.size() + count);
+			ForEach([&out](const RecordedCommand& command) { out.push_back(command); });
+		}
+
+		size_t Size() const {
+			return count;
+		}
+
+		void Reset() {
+			count = 0;
+		}
+
+	private:
+		static const size_t ChunkCommands = 1024;
+		std::vector<std::unique_ptr<RecordedCommand[]>> chunks;
+		size_t count = 0;
+	};
+}
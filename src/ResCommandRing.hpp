@@ -0,0 +1,155 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//Single-producer/single-consumer ring of type-erased commands.
+//A command is any callable, it's move-constructed into the ring and destroyed after being executed.
+//Packets are contiguous, when one doesn't fit before the end a padding packet skips to the start. Packets are at least
+//as large as a header, so there's always room for the padding header.
+
+namespace ResRenderer {
+
+	class CommandRing {
+	public:
+		explicit CommandRing(size_t capacityBytes) {
+			size_t capacity = PacketAlign;
+			while (capacity < capacityBytes)
+				capacity <<= 1;
+			storage.resize(capacity / PacketAlign);
+			mask = capacity - 1;
+		}
+
+		CommandRing(const CommandRing&) = delete;
+		CommandRing& operator=(const CommandRing&) = delete;
+
+		~CommandRing()
+		{
+			//Destroy commands never executed.
+			while (Execute(false)) {}
+		}
+
+		//Producer only. Spins when ring is full. Returns false without taking func when it's larger than half the ring,
+		//since with the padding in front of it such a packet might never fit.
+		template<typename F>
+		bool Push(F&& func) {
+			typedef typename std::decay<F>::type Command;
+			static_assert(alignof(Command) <= alignof(Header), "Command is over-aligned");
+			const size_t size = PacketSize(sizeof(Command));
+			if (size > Capacity() / 2)
+				return false;
+
+			size_t writePos = head.load(std::memory_order_relaxed);
+			size_t offset = writePos & mask;
+			size_t padding = offset + size > Capacity() ? Capacity() - offset : 0;
+			WaitForSpace(writePos, padding + size);
+
+			if (padding > 0) {
+				new (At(offset)) Header{ nullptr, nullptr, padding };
+				writePos += padding;
+				offset = 0;
+			}
+			new (At(offset) + sizeof(Header)) Command(std::forward<F>(func));
+			new (At(offset)) Header{ &Invoke<Command>, &Destroy<Command>, size };
+			head.store(writePos + size, std::memory_order_release);
+			return true;
+		}
+
+		//Consumer only. Runs and pops one command, returns false if ring is empty.
+		//When run is false the command is only destroyed.
+		bool Execute(bool run = true) {
+			size_t readPos = tail.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				if (readPos == head.load(std::memory_order_acquire))
+					return false;
+				auto header = reinterpret_cast<Header*>(At(readPos & mask));
+				if (header->invoke == nullptr) {
+					readPos += header->size;
+					tail.store(readPos, std::memory_order_release);
+					continue;
+				}
+
+				auto size = header->size;
+				auto payload = At(readPos & mask) + sizeof(Header);
+				struct Pop {
+					Header* header;
+					unsigned char* payload;
+					std::atomic<size_t>& tail;
+					size_t next;
+					~Pop() {
+						header->destroy(payload);
+						tail.store(next, std::memory_order_release);
+					}
+				} pop{ header, payload, tail, readPos + size };
+				if (run)
+					header->invoke(payload);
+				return true;
+			}
+		}
+
+		bool Empty() const {
+			return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+		}
+
+	private:
+		static const size_t PacketAlign = 32;
+
+		//Payloads follow the header, so its alignment is theirs too.
+		struct alignas(16) Header {
+			void(*invoke)(void*);
+			void(*destroy)(void*);
+			size_t size;
+		};
+		static_assert(sizeof(Header) <= PacketAlign, "Padding packets must fit a header");
+		static_assert((PacketAlign & (PacketAlign - 1)) == 0, "PacketAlign must be a power of two");
+
+		struct alignas(16) Block {
+			unsigned char bytes[PacketAlign];
+		};
+
+		template<typename Command>
+		static void Invoke(void* p) {
+			(*static_cast<Command*>(p))();
+		}
+
+		template<typename Command>
+		static void Destroy(void* p) {
+			static_cast<Command*>(p)->~Command();
+		}
+
+		static size_t PacketSize(size_t payloadSize) {
+			return (sizeof(Header) + payloadSize + PacketAlign - 1) & ~(PacketAlign - 1);
+		}
+
+		size_t Capacity() const {
+			return mask + 1;
+		}
+
+		unsigned char* At(size_t offset) {
+			return reinterpret_cast<unsigned char*>(storage.data()) + offset;
+		}
+
+		void WaitForSpace(size_t writePos, size_t size) {
+			int spins = 0;
+			while (writePos + size - tail.load(std::memory_order_acquire) > Capacity())
+			{
+				if (++spins > 64)
+					std::this_thread::yield();
+			}
+		}
+
+		std::vector<Block> storage;
+		size_t mask = 0;
+		//Keep producer and consumer positions on different cache lines.
+		char padding0[64];
+		std::atomic<size_t> head{ 0 };
+		char padding1[64];
+		std::atomic<size_t> tail{ 0 };
+		char padding2[64];
+	};
+}
@@ -0,0 +1,242 @@
+#include <ResRenderer.hpp>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+//Backend independent, sorted draws are executed through the immediate API.
+
+namespace ResRenderer {
+
+	static const int TargetBits = 8;
+	static const int ShaderBits = 16;
+	static const int MeshBits = 16;
+	static const int DepthBits = 24;
+
+	struct QueuedDraw {
+		FrameBuffer target;
+		Shader shader;
+		Mesh mesh;
+		uint32_t uniformOffset;
+		uint32_t uniformCount;
+	};
+
+	struct SortItem {
+		uint64_t key;
+		uint32_t draw;
+	};
+
+	//Assigns small ids to handles. Ids stay the same across frames, so sorting is stable frame to frame.
+	//Handles not queued for PruneFrames submits give their ids back, so destroyed ones don't pile up. A new handle at the
+	//address of a destroyed one may take over its id, which only matters for sorting. Same for running out of ids.
+	class HandleIds {
+	public:
+		explicit HandleIds(int bits) : mask((1u << bits) - 1) {
+		}
+
+		uint64_t Get(void* handle) {
+			auto ite = ids.find(handle);
+			if (ite != ids.end()) {
+				ite->second.frame = frame;
+				return ite->second.id;
+			}
+			uint32_t id;
+			if (!freeIds.empty()) {
+				id = freeIds.back();
+				freeIds.pop_back();
+			}
+			else {
+				id = nextId++ & mask;
+			}
+			ids.insert(std::make_pair(handle, Entry{ id, frame }));
+			return id;
+		}
+
+		void EndFrame() {
+			if (++frame % PruneFrames != 0)
+				return;
+			for (auto ite = ids.begin(); ite != ids.end();)
+			{
+				if (frame - ite->second.frame > PruneFrames) {
+					freeIds.push_back(ite->second.id);
+					ite = ids.erase(ite);
+				}
+				else {
+					++ite;
+				}
+			}
+		}
+
+	private:
+		static const uint32_t PruneFrames = 64;
+
+		struct Entry {
+			uint32_t id;
+			uint32_t frame;	//Last submit the handle was queued for.
+		};
+
+		uint32_t mask;
+		uint32_t nextId = 0;
+		uint32_t frame = 0;
+		std::unordered_map<void*, Entry> ids;
+		std::vector<uint32_t> freeIds;
+	};
+
+	//LSD radix sort by 8 bit digits, stable. Digits all keys share are skipped.
+	static void RadixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch) {
+		const size_t n = items.size();
+		size_t histograms[8][256] = {};
+		for (size_t i = 0; i < n; i++)
+		{
+			auto key = items[i].key;
+			for (int d = 0; d < 8; d++)
+				histograms[d][(key >> (d * 8)) & 0xFF]++;
+		}
+
+		scratch.resize(n);
+		for (int d = 0; d < 8; d++)
+		{
+			auto& histogram = histograms[d];
+			if (histogram[(items[0].key >> (d * 8)) & 0xFF] == n)
+				continue;
+
+			size_t offset = 0;
+			for (int b = 0; b < 256; b++)
+			{
+				auto count = histogram[b];
+				histogram[b] = offset;
+				offset += count;
+			}
+			for (size_t i = 0; i < n; i++)
+			{
+				auto& item = items[i];
+				scratch[histogram[(item.key >> (d * 8)) & 0xFF]++] = item;
+			}
+			items.swap(scratch);
+		}
+	}
+
+	class DrawQueueImpl {
+	public:
+		DrawQueueImpl() : targetIds(TargetBits), shaderIds(ShaderBits), meshIds(MeshBits) {
+		}
+
+		void Push(FrameBuffer target, Shader shader, Mesh mesh, float depth, const int* locations, const Vector4* values, int uniformCount) {
+			depth = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+			auto quantizedDepth = static_cast<uint64_t>(depth * ((1 << DepthBits) - 1));
+			uint64_t key = targetIds.Get(target);
+			key = (key << ShaderBits) | shaderIds.Get(shader);
+			key = (key << MeshBits) | meshIds.Get(mesh);
+			key = (key << DepthBits) | quantizedDepth;
+
+			QueuedDraw draw;
+			draw.target = target;
+			draw.shader = shader;
+			draw.mesh = mesh;
+			draw.uniformOffset = static_cast<uint32_t>(uniformLocations.size());
+			draw.uniformCount = static_cast<uint32_t>(uniformCount);
+			for (int i = 0; i < uniformCount; i++)
+			{
+				uniformLocations.push_back(locations[i]);
+				uniformValues.push_back(values[i]);
+			}
+
+			if (draws.empty() || draws.back().shader != shader)
+				stats.unsortedShaderSwitches++;
+			if (draws.empty() || draws.back().mesh != mesh)
+				stats.unsortedMeshSwitches++;
+
+			SortItem item;
+			item.key = key;
+			item.draw = static_cast<uint32_t>(draws.size());
+			items.push_back(item);
+			draws.push_back(draw);
+		}
+
+		ErrorCode Submit(DrawQueueStats* outStats) {
+			auto result = ErrorCode::RES_NO_ERROR;
+			stats.draws = static_cast<unsigned int>(draws.size());
+			if (!items.empty()) {
+				auto start = std::chrono::steady_clock::now();
+				RadixSort(items, scratch);
+				std::chrono::duration<float, std::milli> sortTime = std::chrono::steady_clock::now() - start;
+				stats.sortMilliseconds = sortTime.count();
+
+				const QueuedDraw* last = nullptr;
+				for (auto& item : items)
+				{
+					auto& draw = draws[item.draw];
+					if (last == nullptr || last->target != draw.target) {
+						SetRenderTarget(draw.target);
+						stats.targetSwitches++;
+					}
+					if (last == nullptr || last->shader != draw.shader) {
+						Accumulate(result, UseShader(draw.shader));
+						stats.shaderSwitches++;
+					}
+					if (last == nullptr || last->mesh != draw.mesh)
+						stats.meshSwitches++;
+					for (uint32_t i = 0; i < draw.uniformCount; i++)
+					{
+						Accumulate(result, SetUniformVec(draw.shader, uniformLocations[draw.uniformOffset + i], uniformValues[draw.uniformOffset + i]));
+					}
+					Accumulate(result, DrawMesh(draw.mesh));
+					last = &draw;
+				}
+			}
+
+			targetIds.EndFrame();
+			shaderIds.EndFrame();
+			meshIds.EndFrame();
+			if (outStats != nullptr)
+				*outStats = stats;
+			stats = DrawQueueStats();
+			items.clear();
+			draws.clear();
+			uniformLocations.clear();
+			uniformValues.clear();
+			return result;
+		}
+
+	private:
+		static void Accumulate(ErrorCode& result, ErrorCode code) {
+			if (result == ErrorCode::RES_NO_ERROR)
+				result = code;
+		}
+
+		HandleIds targetIds, shaderIds, meshIds;
+		std::vector<SortItem> items, scratch;
+		std::vector<QueuedDraw> draws;
+		std::vector<int> uniformLocations;
+		std::vector<Vector4> uniformValues;
+		DrawQueueStats stats;
+	};
+
+	ErrorCode RES_RENDERER_API CreateDrawQueue(DrawQueue* outQueue) {
+		if (outQueue == nullptr)
+			return ErrorCode::INTERNAL_ERROR;
+		*outQueue = static_cast<DrawQueue>(new DrawQueueImpl());
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API QueueDrawMesh(DrawQueue queue, FrameBuffer target, Shader shader, Mesh mesh, float depth,
+		const int* uniformLocations, const Vector4* uniformValues, int uniformCount) {
+		if (queue == nullptr || shader == nullptr || mesh == nullptr || uniformCount < 0)
+			return ErrorCode::INTERNAL_ERROR;
+		if (uniformCount > 0 && (uniformLocations == nullptr || uniformValues == nullptr))
+			return ErrorCode::INTERNAL_ERROR;
+		static_cast<DrawQueueImpl*>(queue)->Push(target, shader, mesh, depth, uniformLocations, uniformValues, uniformCount);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API SubmitDrawQueue(DrawQueue queue, DrawQueueStats* outStats) {
+		if (queue == nullptr)
+			return ErrorCode::INTERNAL_ERROR;
+		return static_cast<DrawQueueImpl*>(queue)->Submit(outStats);
+	}
+
+	ErrorCode RES_RENDERER_API DestroyDrawQueue(DrawQueue queue) {
+		delete static_cast<DrawQueueImpl*>(queue);
+		return ErrorCode::RES_NO_ERROR;
+	}
+}
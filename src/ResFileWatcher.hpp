@@ -0,0 +1,113 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+//Reports files that were written since last poll, never blocks.
+//Directories are watched instead of files, since editors often save by writing a new file and renaming it over the old one.
+//Only finished writes and renames count, files that were just created may still be empty.
+//Only implemented with inotify(Linux), elsewhere Add fails.
+
+namespace ResRenderer {
+
+	class FileWatcher {
+	public:
+		FileWatcher() {
+#ifdef __linux__
+			fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+		}
+
+		~FileWatcher() {
+#ifdef __linux__
+			if (fd >= 0)
+				close(fd);
+#endif
+		}
+
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
+		//Id reported by Poll, or -1.
+		int Add(const std::string& path) {
+#ifdef __linux__
+			if (fd < 0)
+				return -1;
+			auto slash = path.find_last_of('/');
+			auto directory = slash == std::string::npos ? std::string(".") : path.substr(0, slash == 0 ? 1 : slash);
+			auto name = slash == std::string::npos ? path : path.substr(slash + 1);
+			int wd = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+			if (wd < 0)
+				return -1;
+			auto id = nextId++;
+			files.insert(std::make_pair(id, File{ wd, name }));
+			return id;
+#else
+			(void)path;
+			return -1;
+#endif
+		}
+
+		//Directory stays watched, watches are shared between files and freed with the watcher.
+		void Remove(int id) {
+			files.erase(id);
+		}
+
+		//Ids of changed files, each once. Events are always drained, so nothing left over is reported after the next Add.
+		//If the kernel queue overflowed, events were lost and every file is reported.
+		std::vector<int> Poll() {
+			std::vector<int> changed;
+#ifdef __linux__
+			if (fd < 0)
+				return changed;
+			alignas(inotify_event) char buffer[4096];
+			bool overflowed = false;
+			for (;;)
+			{
+				auto length = read(fd, buffer, sizeof(buffer));
+				if (length <= 0)
+					break;
+				for (ssize_t offset = 0; offset < length;)
+				{
+					auto event = reinterpret_cast<const inotify_event*>(buffer + offset);
+					offset += sizeof(inotify_event) + event->len;
+					if (event->mask & IN_Q_OVERFLOW)
+						overflowed = true;
+					if (overflowed || event->len == 0)
+						continue;
+					for (auto& file : files)
+					{
+						if (file.second.wd != event->wd || file.second.name != event->name)
+							continue;
+						bool seen = false;
+						for (auto id : changed)
+							seen |= id == file.first;
+						if (!seen)
+							changed.push_back(file.first);
+					}
+				}
+			}
+			if (overflowed) {
+				changed.clear();
+				for (auto& file : files)
+					changed.push_back(file.first);
+			}
+#endif
+			return changed;
+		}
+
+	private:
+		struct File {
+			int wd;
+			std::string name;
+		};
+
+		int fd = -1;
+		int nextId = 0;
+		std::map<int, File> files;
+	};
+}
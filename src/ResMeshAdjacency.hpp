@@ -0,0 +1,22 @@
+#pragma once
+#include <ResRenderer.hpp>
+#include <vector>
+
+namespace ResRenderer {
+
+	//Triangles using each vertex, as one flat array. Triangles of vertex v are triangles[offsets[v], offsets[v + 1]).
+	struct VertexTriangles {
+		std::vector<unsigned int> offsets;
+		std::vector<unsigned int> triangles;
+
+		VertexTriangles(const VertexIndex_t* indicies, size_t triangleCount, int vertCount) : offsets(vertCount + 1, 0), triangles(triangleCount * 3) {
+			for (size_t i = 0; i < triangleCount * 3; i++)
+				offsets[indicies[i] + 1]++;
+			for (int v = 0; v < vertCount; v++)
+				offsets[v + 1] += offsets[v];
+			std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+			for (size_t i = 0; i < triangleCount * 3; i++)
+				triangles[fill[indicies[i]]++] = static_cast<unsigned int>(i / 3);
+		}
+	};
+}
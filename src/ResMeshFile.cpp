@@ -0,0 +1,197 @@
+#include <ResMeshFile.hpp>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <new>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//.resmesh layout, version 1: MeshFileHeader at offset 0, vertex data at dataOffset and indicies at indexOffset, both
+//multiples of PayloadAlignment. Everything in between is zero. Mappings start page aligned, so the payloads in memory
+//are as aligned as in the file.
+
+namespace ResRenderer {
+
+	static const char MeshFileMagic[8] = { 'R', 'E', 'S', 'M', 'E', 'S', 'H', '\0' };
+	static const std::uint32_t MeshFileVersion = 1;
+	static const std::uint64_t PayloadAlignment = 64;
+
+	struct MeshFileAttrib {
+		std::uint32_t type;
+		std::uint32_t count;
+		std::uint32_t normalize;
+	};
+
+	struct MeshFileHeader {
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t headerSize;	//Of this version's header, later versions may only append.
+		std::uint32_t indexSize;
+		std::int32_t attribCount;
+		std::int32_t vertCount;
+		std::uint32_t reserved;
+		MeshFileAttrib attribs[MESH_DATA_MAX_ATTRIB_COUNT];
+		std::uint64_t dataOffset;
+		std::uint64_t dataSize;
+		std::uint64_t indexOffset;
+		std::uint64_t indiciesCount;
+	};
+
+	static std::uint64_t AlignPayload(std::uint64_t offset) {
+		return (offset + PayloadAlignment - 1) / PayloadAlignment * PayloadAlignment;
+	}
+
+	ErrorCode MeshFileImpl::Map(const char* path) {
+		Unmap();
+#ifdef _WIN32
+		auto file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return ErrorCode::FILE_ERROR;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+			CloseHandle(file);
+			return ErrorCode::MESH_FILE_INVALID;
+		}
+		auto mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (mapping == nullptr)
+			return ErrorCode::FILE_ERROR;
+		view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+		CloseHandle(mapping);
+		if (view == nullptr)
+			return ErrorCode::FILE_ERROR;
+		size = static_cast<size_t>(fileSize.QuadPart);
+#else
+		int fd = open(path, O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+			return ErrorCode::FILE_ERROR;
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+			close(fd);
+			return ErrorCode::MESH_FILE_INVALID;
+		}
+		auto mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (mapped == MAP_FAILED)
+			return ErrorCode::FILE_ERROR;
+		view = mapped;
+		size = static_cast<size_t>(st.st_size);
+		//Starts readahead of the whole file without waiting for it.
+		madvise(view, size, MADV_WILLNEED);
+#endif
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	void MeshFileImpl::Unmap() {
+		if (view == nullptr)
+			return;
+#ifdef _WIN32
+		UnmapViewOfFile(view);
+#else
+		munmap(view, size);
+#endif
+		view = nullptr;
+		size = 0;
+	}
+
+	static bool ReadMeshFileHeader(const MeshFileImpl& file, MeshData* outData) {
+		MeshFileHeader header;
+		if (file.Size() < sizeof(header))
+			return false;
+		std::memcpy(&header, file.Bytes(), sizeof(header));
+		if (std::memcmp(header.magic, MeshFileMagic, sizeof(MeshFileMagic)) != 0 || header.version != MeshFileVersion ||
+			header.headerSize != sizeof(MeshFileHeader) || header.indexSize != sizeof(VertexIndex_t)) {
+			return false;
+		}
+		if (header.attribCount < 0 || header.attribCount > MESH_DATA_MAX_ATTRIB_COUNT)
+			return false;
+
+		MeshData data;
+		for (int i = 0; i < header.attribCount; i++)
+		{
+			auto& attrib = header.attribs[i];
+			if (attrib.count > 4 || attrib.normalize > 1)
+				return false;
+			if (MeshDataAppendAttrib(&data, static_cast<VertexAttribType>(attrib.type), static_cast<int>(attrib.count), attrib.normalize != 0) != ErrorCode::RES_NO_ERROR)
+				return false;
+		}
+
+		//Payloads must lie after the header and inside the file, without overflowing on the way.
+		std::uint64_t size = file.Size();
+		if (header.dataOffset % PayloadAlignment != 0 || header.indexOffset % PayloadAlignment != 0)
+			return false;
+		if (header.dataOffset < sizeof(MeshFileHeader) || header.dataOffset > size || header.dataSize > size - header.dataOffset)
+			return false;
+		if (header.indexOffset < sizeof(MeshFileHeader) || header.indexOffset > size || header.indiciesCount > (size - header.indexOffset) / sizeof(VertexIndex_t))
+			return false;
+
+		data.vertCount = header.vertCount;
+		data.data = file.Bytes() + header.dataOffset;
+		data.dataSize = static_cast<size_t>(header.dataSize);
+		data.indicies = reinterpret_cast<VertexIndex_t*>(file.Bytes() + header.indexOffset);
+		data.indiciesCount = static_cast<size_t>(header.indiciesCount);
+		if (MeshDataVerify(&data, MeshDataValidation::Layout) != ErrorCode::RES_NO_ERROR)
+			return false;
+		*outData = data;
+		return true;
+	}
+
+	ErrorCode RES_RENDERER_API SaveMeshFile(const char* path, const MeshData* data) {
+		auto t = MeshDataVerify(data, MeshDataValidation::Layout);
+		if (t != ErrorCode::RES_NO_ERROR)
+			return t;
+
+		MeshFileHeader header;
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic, MeshFileMagic, sizeof(MeshFileMagic));
+		header.version = MeshFileVersion;
+		header.headerSize = sizeof(MeshFileHeader);
+		header.indexSize = sizeof(VertexIndex_t);
+		header.attribCount = data->attribCount;
+		header.vertCount = data->vertCount;
+		for (int i = 0; i < data->attribCount; i++)
+		{
+			auto& desc = data->attribDescriptions[i];
+			header.attribs[i] = MeshFileAttrib{ static_cast<std::uint32_t>(desc.type), static_cast<std::uint32_t>(desc.count), desc.normalize ? 1u : 0u };
+		}
+		header.dataOffset = AlignPayload(sizeof(MeshFileHeader));
+		header.dataSize = data->dataSize;
+		header.indexOffset = AlignPayload(header.dataOffset + header.dataSize);
+		header.indiciesCount = data->indiciesCount;
+
+		static const char zeros[PayloadAlignment] = {};
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(zeros, static_cast<std::streamsize>(header.dataOffset - sizeof(header)));
+		file.write(static_cast<const char*>(data->data), static_cast<std::streamsize>(data->dataSize));
+		file.write(zeros, static_cast<std::streamsize>(header.indexOffset - header.dataOffset - header.dataSize));
+		file.write(reinterpret_cast<const char*>(data->indicies), static_cast<std::streamsize>(data->indiciesCount * sizeof(VertexIndex_t)));
+		file.close();
+		return file ? ErrorCode::RES_NO_ERROR : ErrorCode::FILE_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API LoadMeshFile(const char* path, MeshFile* outFile, MeshData* outData) {
+		auto file = new (std::nothrow) MeshFileImpl();
+		if (file == nullptr)
+			return ErrorCode::INTERNAL_ERROR;
+		auto t = file->Map(path);
+		if (t == ErrorCode::RES_NO_ERROR && !ReadMeshFileHeader(*file, outData))
+			t = ErrorCode::MESH_FILE_INVALID;
+		if (t != ErrorCode::RES_NO_ERROR) {
+			delete file;
+			return t;
+		}
+		*outFile = file;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	void RES_RENDERER_API CloseMeshFile(MeshFile file) {
+		delete static_cast<MeshFileImpl*>(file);
+	}
+}
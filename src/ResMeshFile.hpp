@@ -0,0 +1,34 @@
+#pragma once
+#include <ResRenderer.hpp>
+#include <vector>
+
+namespace ResRenderer {
+
+	//Behind MeshFile. Either a read only file mapping with private, copy on write pages, or for meshes converted on
+	//load(ImportObjFile) the buffers MeshData points at.
+	class MeshFileImpl {
+	public:
+		~MeshFileImpl() {
+			Unmap();
+		}
+
+		//FILE_ERROR if it can't be opened or mapped, MESH_FILE_INVALID if it's empty.
+		ErrorCode Map(const char* path);
+		void Unmap();
+
+		unsigned char* Bytes() const {
+			return static_cast<unsigned char*>(view);
+		}
+
+		size_t Size() const {
+			return size;
+		}
+
+		std::vector<float> vertices;
+		std::vector<VertexIndex_t> indicies;
+
+	private:
+		void* view = nullptr;
+		size_t size = 0;
+	};
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <ResRenderer.hpp>
+#include <vector>
+
+namespace ResRenderer {
+
+	//One level of a mesh's index buffer. error is relative to the mesh's size, 0 for the full mesh.
+	struct MeshLOD {
+		unsigned int firstIndex;
+		unsigned int indexCount;
+		float error;
+	};
+
+	//Index buffer of every level back to back, starting with data's own.
+	ErrorCode GenerateMeshLODs(const MeshData* data, const MeshLODSettings& settings, std::vector<VertexIndex_t>* outIndicies, std::vector<MeshLOD>* outLODs);
+	//Coarsest level whose error stays under maxPixelError pixels when the mesh covers projectedSize pixels.
+	const MeshLOD& SelectMeshLOD(const std::vector<MeshLOD>& lods, float projectedSize, float maxPixelError);
+}
@@ -0,0 +1,214 @@
+#include <ResRenderer.hpp>
+#include <ResMeshAdjacency.hpp>
+#include <ResVertexFormat.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+//Backend independent. Triangle order follows "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"
+//(Sander, Nehab, Barczak 2007): Tipsify for the vertex cache, then its clusters sorted for overdraw.
+
+namespace ResRenderer {
+
+	//Emits triangles in Tipsify order. clusterStarts gets the output triangle where each cluster starts,
+	//a cluster ends where the fanning vertex had to be picked without cache locality.
+	static void Tipsify(const VertexIndex_t* indicies, size_t triangleCount, int vertCount, int cacheSize,
+		std::vector<unsigned int>& outTriangles, std::vector<size_t>& clusterStarts) {
+		VertexTriangles adjacency(indicies, triangleCount, vertCount);
+		std::vector<unsigned int> liveTriangles(vertCount);
+		for (int v = 0; v < vertCount; v++)
+			liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+		std::vector<unsigned int> cacheTime(vertCount, 0);
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<VertexIndex_t> deadEnd;
+		std::vector<VertexIndex_t> candidates;
+		deadEnd.reserve(triangleCount * 3);
+		outTriangles.clear();
+		outTriangles.reserve(triangleCount);
+		clusterStarts.clear();
+
+		unsigned int time = static_cast<unsigned int>(cacheSize) + 1;
+		int cursor = 0;
+		int fanning = 0;
+		while (fanning >= 0)
+		{
+			candidates.clear();
+			for (auto t = adjacency.offsets[fanning]; t < adjacency.offsets[fanning + 1]; t++)
+			{
+				auto triangle = adjacency.triangles[t];
+				if (emitted[triangle])
+					continue;
+				emitted[triangle] = true;
+				outTriangles.push_back(triangle);
+				for (int c = 0; c < 3; c++)
+				{
+					auto v = indicies[triangle * 3 + c];
+					deadEnd.push_back(v);
+					candidates.push_back(v);
+					liveTriangles[v]--;
+					if (time - cacheTime[v] > static_cast<unsigned int>(cacheSize))
+						cacheTime[v] = time++;
+				}
+			}
+
+			//Candidate still in cache after emitting all its triangles, preferring the oldest.
+			int next = -1;
+			int best = -1;
+			for (auto v : candidates)
+			{
+				if (liveTriangles[v] == 0)
+					continue;
+				int priority = 0;
+				if (time - cacheTime[v] + 2 * liveTriangles[v] <= static_cast<unsigned int>(cacheSize))
+					priority = static_cast<int>(time - cacheTime[v]);
+				if (priority > best) {
+					best = priority;
+					next = static_cast<int>(v);
+				}
+			}
+			if (next < 0) {
+				//Dead end, recently used vertices first, then input order.
+				while (!deadEnd.empty() && next < 0)
+				{
+					auto v = deadEnd.back();
+					deadEnd.pop_back();
+					if (liveTriangles[v] > 0)
+						next = static_cast<int>(v);
+				}
+				while (next < 0 && cursor < vertCount)
+				{
+					if (liveTriangles[cursor] > 0)
+						next = cursor;
+					cursor++;
+				}
+				if (next >= 0)
+					clusterStarts.push_back(outTriangles.size());
+			}
+			fanning = next;
+		}
+		if (clusterStarts.empty() || clusterStarts[0] != 0)
+			clusterStarts.insert(clusterStarts.begin(), 0);
+	}
+
+	//Outward facing clusters first, they're likely to occlude the rest. Needs a float position of 3+ components at attribute 0.
+	static void SortClustersForOverdraw(const MeshData* data, const VertexIndex_t* indicies, std::vector<unsigned int>& triangles, const std::vector<size_t>& clusterStarts) {
+		//Vertices of compact formats needn't be a whole number of floats, positions are read at their byte offset.
+		auto stride = GetMeshVertexSize(data);
+		std::vector<float> positions(data->vertCount * 3ull);
+		for (int v = 0; v < data->vertCount; v++)
+		{
+			float p[4];
+			UnpackVertexAttrib(data->attribDescriptions[0], static_cast<const unsigned char*>(data->data) + v * stride, p);
+			std::copy(p, p + 3, &positions[v * 3ull]);
+		}
+		auto position = [&](VertexIndex_t v) { return &positions[v * 3ull]; };
+
+		struct Cluster {
+			size_t start, end;
+			double centroid[3], normal[3], area;
+			double sortKey;
+		};
+		std::vector<Cluster> clusters;
+		double meshCentroid[3] = {};
+		double meshArea = 0.0;
+		for (size_t c = 0; c < clusterStarts.size(); c++)
+		{
+			Cluster cluster = {};
+			cluster.start = clusterStarts[c];
+			cluster.end = c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : triangles.size();
+			for (auto i = cluster.start; i < cluster.end; i++)
+			{
+				auto tri = &indicies[triangles[i] * 3];
+				auto p0 = position(tri[0]), p1 = position(tri[1]), p2 = position(tri[2]);
+				double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+				double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+				double n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+				double area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) * 0.5;
+				for (int k = 0; k < 3; k++)
+				{
+					cluster.normal[k] += n[k];
+					cluster.centroid[k] += (p0[k] + p1[k] + p2[k]) / 3.0 * area;
+				}
+				cluster.area += area;
+			}
+			for (int k = 0; k < 3; k++)
+				meshCentroid[k] += cluster.centroid[k];
+			meshArea += cluster.area;
+			clusters.push_back(cluster);
+		}
+		if (meshArea <= 0.0)
+			return;
+		for (int k = 0; k < 3; k++)
+			meshCentroid[k] /= meshArea;
+
+		for (auto& cluster : clusters)
+		{
+			double length = std::sqrt(cluster.normal[0] * cluster.normal[0] + cluster.normal[1] * cluster.normal[1] + cluster.normal[2] * cluster.normal[2]);
+			cluster.sortKey = 0.0;
+			if (cluster.area <= 0.0 || length <= 0.0)
+				continue;
+			for (int k = 0; k < 3; k++)
+				cluster.sortKey += (cluster.centroid[k] / cluster.area - meshCentroid[k]) * cluster.normal[k] / length;
+		}
+		std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+		std::vector<unsigned int> sorted;
+		sorted.reserve(triangles.size());
+		for (auto& cluster : clusters)
+			sorted.insert(sorted.end(), triangles.begin() + cluster.start, triangles.begin() + cluster.end);
+		triangles.swap(sorted);
+	}
+
+	ErrorCode RES_RENDERER_API OptimizeMeshData(MeshData* data, int cacheSize) {
+		auto t = MeshDataVerify(data);
+		if (t != ErrorCode::RES_NO_ERROR)
+			return t;
+		if (cacheSize <= 0 || data->indicies == nullptr || data->indiciesCount % 3 != 0)
+			return ErrorCode::MESH_DATA_BROKEN;
+		auto vertCount = data->vertCount;
+		for (size_t i = 0; i < data->indiciesCount; i++)
+		{
+			if (data->indicies[i] >= static_cast<VertexIndex_t>(vertCount))
+				return ErrorCode::MESH_DATA_BROKEN;
+		}
+		auto triangleCount = data->indiciesCount / 3;
+		if (triangleCount == 0)
+			return ErrorCode::RES_NO_ERROR;
+
+		std::vector<unsigned int> triangles;
+		std::vector<size_t> clusterStarts;
+		Tipsify(data->indicies, triangleCount, vertCount, cacheSize, triangles, clusterStarts);
+		auto& position = data->attribDescriptions[0];
+		if (data->attribCount > 0 && position.type == VertexAttribType::ResFloat && position.count >= 3)
+			SortClustersForOverdraw(data, data->indicies, triangles, clusterStarts);
+
+		//Vertices in order of first use, unused ones at the end.
+		std::vector<VertexIndex_t> remap(vertCount, static_cast<VertexIndex_t>(~0u));
+		VertexIndex_t nextVertex = 0;
+		std::vector<VertexIndex_t> indicies(data->indiciesCount);
+		for (size_t i = 0; i < triangleCount; i++)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				auto v = data->indicies[triangles[i] * 3 + c];
+				if (remap[v] == static_cast<VertexIndex_t>(~0u))
+					remap[v] = nextVertex++;
+				indicies[i * 3 + c] = remap[v];
+			}
+		}
+		for (auto& v : remap)
+		{
+			if (v == static_cast<VertexIndex_t>(~0u))
+				v = nextVertex++;
+		}
+
+		auto stride = GetMeshVertexSize(data);
+		auto vertices = static_cast<unsigned char*>(data->data);
+		std::vector<unsigned char> original(vertices, vertices + stride * vertCount);
+		for (int v = 0; v < vertCount; v++)
+			memcpy(vertices + remap[v] * stride, original.data() + v * stride, stride);
+		memcpy(data->indicies, indicies.data(), indicies.size() * sizeof(VertexIndex_t));
+		return ErrorCode::RES_NO_ERROR;
+	}
+}
@@ -0,0 +1,291 @@
+#include <ResRenderer.hpp>
+#include <ResMeshAdjacency.hpp>
+#include <ResMeshLOD.hpp>
+#include <ResVertexFormat.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+//Backend independent. Garland-Heckbert quadrics, but every edge collapses onto one of its existing vertices,
+//so only the index buffer changes. Collapses run in passes ordered by error, a vertex whose triangles changed
+//waits for the next pass, which keeps the flip check exact.
+
+namespace ResRenderer {
+
+	//Sum of area weighted squared distances to planes, as a symmetric 4x4 matrix.
+	struct Quadric {
+		double a00, a01, a02, a03, a11, a12, a13, a22, a23, a33;
+		double weight;
+	};
+
+	static void AddPlane(Quadric& q, const double* n, double d, double weight) {
+		q.a00 += weight * n[0] * n[0];
+		q.a01 += weight * n[0] * n[1];
+		q.a02 += weight * n[0] * n[2];
+		q.a03 += weight * n[0] * d;
+		q.a11 += weight * n[1] * n[1];
+		q.a12 += weight * n[1] * n[2];
+		q.a13 += weight * n[1] * d;
+		q.a22 += weight * n[2] * n[2];
+		q.a23 += weight * n[2] * d;
+		q.a33 += weight * d * d;
+		q.weight += weight;
+	}
+
+	static void AddQuadric(Quadric& q, const Quadric& other) {
+		q.a00 += other.a00;
+		q.a01 += other.a01;
+		q.a02 += other.a02;
+		q.a03 += other.a03;
+		q.a11 += other.a11;
+		q.a12 += other.a12;
+		q.a13 += other.a13;
+		q.a22 += other.a22;
+		q.a23 += other.a23;
+		q.a33 += other.a33;
+		q.weight += other.weight;
+	}
+
+	static double EvaluateQuadric(const Quadric& q, const float* p) {
+		double x = p[0], y = p[1], z = p[2];
+		return q.a00 * x * x + q.a11 * y * y + q.a22 * z * z + q.a33
+			+ 2.0 * (q.a01 * x * y + q.a02 * x * z + q.a12 * y * z + q.a03 * x + q.a13 * y + q.a23 * z);
+	}
+
+	static void TriangleNormal(const float* p0, const float* p1, const float* p2, double* out) {
+		double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		out[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		out[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		out[2] = e1[0] * e2[1] - e1[1] * e2[0];
+	}
+
+	//Positions scaled so the bounding box diagonal is 1, errors come out relative to mesh size.
+	static ErrorCode ReadNormalizedPositions(const MeshData* data, std::vector<float>* outPositions) {
+		auto t = MeshDataVerify(data);
+		if (t != ErrorCode::RES_NO_ERROR)
+			return t;
+		if (data->indiciesCount % 3 != 0 || data->attribCount < 1 || data->attribDescriptions[0].count < 3)
+			return ErrorCode::MESH_DATA_BROKEN;
+		for (size_t i = 0; i < data->indiciesCount; i++)
+		{
+			if (data->indicies[i] >= static_cast<VertexIndex_t>(data->vertCount))
+				return ErrorCode::MESH_DATA_BROKEN;
+		}
+
+		auto& positions = *outPositions;
+		positions.resize(data->vertCount * 3);
+		auto stride = GetMeshVertexSize(data);
+		float lo[3] = { 0.0f, 0.0f, 0.0f }, hi[3] = { 0.0f, 0.0f, 0.0f };
+		for (int v = 0; v < data->vertCount; v++)
+		{
+			float p[4];
+			UnpackVertexAttrib(data->attribDescriptions[0], static_cast<const unsigned char*>(data->data) + v * stride, p);
+			for (int k = 0; k < 3; k++)
+			{
+				positions[v * 3 + k] = p[k];
+				lo[k] = v == 0 ? p[k] : std::min(lo[k], p[k]);
+				hi[k] = v == 0 ? p[k] : std::max(hi[k], p[k]);
+			}
+		}
+		float size = std::sqrt((hi[0] - lo[0]) * (hi[0] - lo[0]) + (hi[1] - lo[1]) * (hi[1] - lo[1]) + (hi[2] - lo[2]) * (hi[2] - lo[2]));
+		float scale = size > 0.0f ? 1.0f / size : 1.0f;
+		for (size_t i = 0; i < positions.size(); i++)
+			positions[i] = (positions[i] - lo[i % 3]) * scale;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	//Simplifies indicies in place toward targetIndexCount, returns the largest error of a collapse.
+	static float Simplify(const std::vector<float>& positions, int vertCount, std::vector<VertexIndex_t>& indicies, size_t targetIndexCount, float maxError) {
+		auto position = [&](VertexIndex_t v) { return &positions[v * 3]; };
+
+		//Vertices on an edge that isn't shared by exactly two triangles(borders, seams, non-manifold) never move.
+		std::vector<bool> locked(vertCount, false);
+		{
+			std::unordered_map<unsigned long long, int> edges;
+			edges.reserve(indicies.size());
+			for (size_t i = 0; i < indicies.size(); i++)
+			{
+				auto a = indicies[i];
+				auto b = indicies[i - i % 3 + (i + 1) % 3];
+				edges[static_cast<unsigned long long>(std::min(a, b)) << 32 | std::max(a, b)]++;
+			}
+			for (auto& edge : edges)
+			{
+				if (edge.second != 2) {
+					locked[edge.first >> 32] = true;
+					locked[edge.first & 0xFFFFFFFF] = true;
+				}
+			}
+		}
+
+		std::vector<Quadric> quadrics(vertCount, Quadric());
+		for (size_t i = 0; i < indicies.size(); i += 3)
+		{
+			double n[3];
+			TriangleNormal(position(indicies[i]), position(indicies[i + 1]), position(indicies[i + 2]), n);
+			double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			if (length <= 0.0)
+				continue;
+			for (auto& c : n)
+				c /= length;
+			auto p0 = position(indicies[i]);
+			double d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+			for (int c = 0; c < 3; c++)
+				AddPlane(quadrics[indicies[i + c]], n, d, length * 0.5);
+		}
+
+		struct Collapse {
+			VertexIndex_t from, to;
+			float error;
+		};
+		std::vector<Collapse> collapses;
+		std::vector<VertexIndex_t> remap(vertCount);
+		std::vector<bool> touched(vertCount);
+		float error = 0.0f;
+		while (indicies.size() > targetIndexCount)
+		{
+			auto triangleCount = indicies.size() / 3;
+			VertexTriangles adjacency(indicies.data(), triangleCount, vertCount);
+			collapses.clear();
+			for (size_t i = 0; i < indicies.size(); i++)
+			{
+				VertexIndex_t ends[2] = { indicies[i], indicies[i - i % 3 + (i + 1) % 3] };
+				for (int direction = 0; direction < 2; direction++)
+				{
+					auto from = ends[direction], to = ends[1 - direction];
+					if (locked[from])
+						continue;
+					auto& q = quadrics[from];
+					auto& r = quadrics[to];
+					double weight = q.weight + r.weight;
+					double e = weight > 0.0 ? std::sqrt(std::max(0.0, (EvaluateQuadric(q, position(to)) + EvaluateQuadric(r, position(to))) / weight)) : 0.0;
+					if (e <= maxError)
+						collapses.push_back(Collapse{ from, to, static_cast<float>(e) });
+				}
+			}
+			if (collapses.empty())
+				break;
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+			for (int v = 0; v < vertCount; v++)
+				remap[v] = static_cast<VertexIndex_t>(v);
+			std::fill(touched.begin(), touched.end(), false);
+			auto trianglesLeft = triangleCount;
+			size_t applied = 0;
+			for (auto& collapse : collapses)
+			{
+				if (trianglesLeft * 3 <= targetIndexCount)
+					break;
+				if (touched[collapse.from] || touched[collapse.to])
+					continue;
+
+				//Triangles that keep existing must not turn over.
+				bool flips = false;
+				size_t removed = 0;
+				for (auto a = adjacency.offsets[collapse.from]; a < adjacency.offsets[collapse.from + 1] && !flips; a++)
+				{
+					auto tri = &indicies[adjacency.triangles[a] * 3];
+					if (tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to) {
+						removed++;
+						continue;
+					}
+					const float* p[3];
+					const float* moved[3];
+					for (int c = 0; c < 3; c++)
+					{
+						p[c] = position(tri[c]);
+						moved[c] = tri[c] == collapse.from ? position(collapse.to) : p[c];
+					}
+					double before[3], after[3];
+					TriangleNormal(p[0], p[1], p[2], before);
+					TriangleNormal(moved[0], moved[1], moved[2], after);
+					flips = before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0;
+				}
+				if (flips)
+					continue;
+
+				remap[collapse.from] = collapse.to;
+				AddQuadric(quadrics[collapse.to], quadrics[collapse.from]);
+				error = std::max(error, collapse.error);
+				for (auto a = adjacency.offsets[collapse.from]; a < adjacency.offsets[collapse.from + 1]; a++)
+				{
+					for (int c = 0; c < 3; c++)
+						touched[indicies[adjacency.triangles[a] * 3 + c]] = true;
+				}
+				touched[collapse.to] = true;
+				trianglesLeft -= std::min(removed, trianglesLeft);
+				applied++;
+			}
+			if (applied == 0)
+				break;
+
+			size_t out = 0;
+			for (size_t i = 0; i < indicies.size(); i += 3)
+			{
+				VertexIndex_t a = remap[indicies[i]], b = remap[indicies[i + 1]], c = remap[indicies[i + 2]];
+				if (a == b || b == c || a == c)
+					continue;
+				indicies[out++] = a;
+				indicies[out++] = b;
+				indicies[out++] = c;
+			}
+			indicies.resize(out);
+		}
+		return error;
+	}
+
+	ErrorCode RES_RENDERER_API SimplifyMeshData(const MeshData* data, size_t targetIndexCount, float maxError,
+		VertexIndex_t* outIndicies, size_t* outIndexCount, float* outError) {
+		std::vector<float> positions;
+		auto t = ReadNormalizedPositions(data, &positions);
+		if (t != ErrorCode::RES_NO_ERROR)
+			return t;
+		std::vector<VertexIndex_t> indicies(data->indicies, data->indicies + data->indiciesCount);
+		auto error = Simplify(positions, data->vertCount, indicies, targetIndexCount, maxError);
+		memcpy(outIndicies, indicies.data(), indicies.size() * sizeof(VertexIndex_t));
+		*outIndexCount = indicies.size();
+		if (outError != nullptr)
+			*outError = error;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode GenerateMeshLODs(const MeshData* data, const MeshLODSettings& settings, std::vector<VertexIndex_t>* outIndicies, std::vector<MeshLOD>* outLODs) {
+		if (settings.levels < 1 || settings.reduction <= 0.0f || settings.reduction >= 1.0f)
+			return ErrorCode::MESH_DATA_BROKEN;
+		std::vector<float> positions;
+		auto t = ReadNormalizedPositions(data, &positions);
+		if (t != ErrorCode::RES_NO_ERROR)
+			return t;
+
+		outIndicies->assign(data->indicies, data->indicies + data->indiciesCount);
+		outLODs->assign(1, MeshLOD{ 0, static_cast<unsigned int>(data->indiciesCount), 0.0f });
+		//Each level simplifies the one before, its error adds up.
+		std::vector<VertexIndex_t> level(*outIndicies);
+		float error = 0.0f;
+		for (int l = 1; l < settings.levels; l++)
+		{
+			auto before = level.size();
+			auto target = static_cast<size_t>(before / 3 * settings.reduction) * 3;
+			error += Simplify(positions, data->vertCount, level, target, settings.maxError - error);
+			//Stuck at the error limit.
+			if (level.empty() || level.size() * 10 > before * 9)
+				break;
+			outLODs->push_back(MeshLOD{ static_cast<unsigned int>(outIndicies->size()), static_cast<unsigned int>(level.size()), error });
+			outIndicies->insert(outIndicies->end(), level.begin(), level.end());
+		}
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	const MeshLOD& SelectMeshLOD(const std::vector<MeshLOD>& lods, float projectedSize, float maxPixelError) {
+		size_t selected = 0;
+		for (size_t i = 1; i < lods.size(); i++)
+		{
+			if (lods[i].error * projectedSize <= maxPixelError)
+				selected = i;
+		}
+		return lods[selected];
+	}
+}
@@ -0,0 +1,210 @@
+#include <ResMeshValidation.hpp>
+#include <ResParallel.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define RES_MESH_VALIDATION_AVX2
+#endif
+
+//Backend independent. Indices and vertices are scanned in chunks of about ChunkBytes, spread over a worker pool once
+//a mesh is larger than ParallelBytes. Infinity and NaN are found by their exponent bits being all ones, for float and
+//half float alike. Vertex data is read little endian.
+
+namespace ResRenderer {
+
+	static const size_t ChunkBytes = 1 << 20;
+	static const size_t ParallelBytes = 4 << 20;
+
+	//A float or half float component inside a vertex.
+	struct FloatComponent {
+		size_t offset;
+		bool half;
+	};
+
+	static bool NonFiniteVerticesScalar(const unsigned char* src, size_t vertSize, size_t first, size_t count, const std::vector<FloatComponent>& components) {
+		for (size_t v = first; v < first + count; v++)
+		{
+			auto vertex = src + v * vertSize;
+			for (auto& c : components)
+			{
+				if (c.half) {
+					std::uint16_t h;
+					std::memcpy(&h, vertex + c.offset, sizeof(h));
+					if ((h & 0x7C00) == 0x7C00)
+						return true;
+				}
+				else {
+					std::uint32_t f;
+					std::memcpy(&f, vertex + c.offset, sizeof(f));
+					if ((f & 0x7F800000) == 0x7F800000)
+						return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	static VertexIndex_t MaxIndexScalar(const VertexIndex_t* src, size_t count) {
+		VertexIndex_t max = 0;
+		for (size_t i = 0; i < count; i++)
+			max = std::max(max, src[i]);
+		return max;
+	}
+
+	//Kernels return how many indices or vertices they went through, scalar code does the rest.
+#ifdef RES_MESH_VALIDATION_AVX2
+	static bool HasAVX2() {
+		static const bool has = __builtin_cpu_supports("avx2");
+		return has;
+	}
+
+	__attribute__((target("avx2")))
+	static size_t MaxIndexAVX2(const VertexIndex_t* src, size_t count, VertexIndex_t* outMax) {
+		auto m0 = _mm256_setzero_si256(), m1 = m0, m2 = m0, m3 = m0;
+		size_t i = 0;
+		for (; i + 32 <= count; i += 32)
+		{
+			m0 = _mm256_max_epu32(m0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+			m1 = _mm256_max_epu32(m1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 8)));
+			m2 = _mm256_max_epu32(m2, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 16)));
+			m3 = _mm256_max_epu32(m3, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 24)));
+		}
+		VertexIndex_t lanes[8];
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), _mm256_max_epu32(_mm256_max_epu32(m0, m1), _mm256_max_epu32(m2, m3)));
+		*outMax = *std::max_element(lanes, lanes + 8);
+		return i;
+	}
+
+	//16 vertices are a whole number of vectors when vertSize is even. Every 16 bit lane of them has a mask and a value,
+	//the lane is bad when (lane & mask) == value: the exponent lane of a float or half float gets its exponent bits for
+	//both, every other lane a value that can't come out of its mask.
+	struct ExponentPattern {
+		std::vector<std::uint16_t> masks;
+		std::vector<std::uint16_t> values;
+	};
+
+	static bool MakeExponentPattern(size_t vertSize, const std::vector<FloatComponent>& components, ExponentPattern* outPattern) {
+		if (vertSize % 2 != 0)
+			return false;
+		auto lanes = vertSize / 2;
+		outPattern->masks.assign(lanes * 16, 0);
+		outPattern->values.assign(lanes * 16, 0xFFFF);
+		for (auto& c : components)
+		{
+			if (c.offset % 2 != 0)
+				return false;
+			auto lane = c.offset / 2 + (c.half ? 0 : 1);
+			std::uint16_t exponent = c.half ? 0x7C00 : 0x7F80;
+			for (size_t v = 0; v < 16; v++)
+			{
+				outPattern->masks[v * lanes + lane] = exponent;
+				outPattern->values[v * lanes + lane] = exponent;
+			}
+		}
+		return true;
+	}
+
+	__attribute__((target("avx2")))
+	static size_t NonFiniteVerticesAVX2(const unsigned char* src, size_t vertSize, size_t count, const ExponentPattern& pattern, bool* outFound) {
+		auto vectors = vertSize / 2;
+		auto masks = reinterpret_cast<const __m256i*>(pattern.masks.data());
+		auto values = reinterpret_cast<const __m256i*>(pattern.values.data());
+		auto found = _mm256_setzero_si256();
+		size_t v = 0;
+		for (; v + 16 <= count; v += 16)
+		{
+			auto group = reinterpret_cast<const __m256i*>(src + v * vertSize);
+			for (size_t k = 0; k < vectors; k++)
+			{
+				auto x = _mm256_and_si256(_mm256_loadu_si256(group + k), _mm256_loadu_si256(masks + k));
+				found = _mm256_or_si256(found, _mm256_cmpeq_epi16(x, _mm256_loadu_si256(values + k)));
+			}
+		}
+		*outFound = !_mm256_testz_si256(found, found);
+		return v;
+	}
+#endif
+
+	ErrorCode VerifyMeshDataContents(const MeshData* data) {
+		auto vertSize = GetMeshVertexSize(data);
+		std::vector<FloatComponent> components;
+		size_t offset = 0;
+		for (int i = 0; i < data->attribCount; i++)
+		{
+			auto& desc = data->attribDescriptions[i];
+			auto size = GetVertexAttribSize(desc.type);
+			if (desc.type == VertexAttribType::ResFloat || desc.type == VertexAttribType::ResHalfFloat) {
+				for (int c = 0; c < desc.count; c++)
+					components.push_back(FloatComponent{ offset + c * size, desc.type == VertexAttribType::ResHalfFloat });
+			}
+			offset += size * desc.count;
+		}
+
+		auto src = static_cast<const unsigned char*>(data->data);
+		auto vertCount = static_cast<size_t>(data->vertCount);
+#ifdef RES_MESH_VALIDATION_AVX2
+		ExponentPattern pattern;
+		bool useAVX2 = HasAVX2();
+		bool vectorVertices = useAVX2 && !components.empty() && MakeExponentPattern(vertSize, components, &pattern);
+#endif
+
+		auto indexChunk = ChunkBytes / sizeof(VertexIndex_t);
+		auto vertexChunk = std::max<size_t>(ChunkBytes / vertSize / 16 * 16, 16);
+		auto indexChunks = static_cast<int>((data->indiciesCount + indexChunk - 1) / indexChunk);
+		auto vertexChunks = components.empty() ? 0 : static_cast<int>((vertCount + vertexChunk - 1) / vertexChunk);
+
+		//Index chunks only stop early for index errors, so those win over non-finite vertices no matter the order.
+		std::atomic<bool> outOfRange{ false }, notFinite{ false };
+		auto check = [&](int chunk, int) {
+			if (outOfRange.load(std::memory_order_relaxed))
+				return;
+			if (chunk < indexChunks) {
+				auto first = chunk * indexChunk;
+				auto count = std::min(indexChunk, data->indiciesCount - first);
+				VertexIndex_t max = 0;
+				size_t done = 0;
+#ifdef RES_MESH_VALIDATION_AVX2
+				if (useAVX2)
+					done = MaxIndexAVX2(data->indicies + first, count, &max);
+#endif
+				max = std::max(max, MaxIndexScalar(data->indicies + first + done, count - done));
+				if (max >= vertCount)
+					outOfRange.store(true, std::memory_order_relaxed);
+				return;
+			}
+			if (notFinite.load(std::memory_order_relaxed))
+				return;
+			auto first = (chunk - indexChunks) * vertexChunk;
+			auto count = std::min(vertexChunk, vertCount - first);
+			bool found = false;
+			size_t done = 0;
+#ifdef RES_MESH_VALIDATION_AVX2
+			if (vectorVertices)
+				done = NonFiniteVerticesAVX2(src + first * vertSize, vertSize, count, pattern, &found);
+#endif
+			if (found || NonFiniteVerticesScalar(src, vertSize, first + done, count - done, components))
+				notFinite.store(true, std::memory_order_relaxed);
+		};
+
+		auto total = indexChunks + vertexChunks;
+		auto bytes = data->indiciesCount * sizeof(VertexIndex_t) + (components.empty() ? 0 : data->dataSize);
+		if (bytes > ParallelBytes) {
+			SharedWorkerPool pool;
+			pool.ParallelFor(total, check);
+		}
+		else {
+			for (int i = 0; i < total; i++)
+				check(i, 0);
+		}
+
+		if (outOfRange.load())
+			return ErrorCode::MESH_DATA_INDEX_OUT_OF_RANGE;
+		if (notFinite.load())
+			return ErrorCode::MESH_DATA_NOT_FINITE;
+		return ErrorCode::RES_NO_ERROR;
+	}
+}
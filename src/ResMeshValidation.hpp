@@ -0,0 +1,8 @@
+#pragma once
+#include <ResRenderer.hpp>
+
+namespace ResRenderer {
+
+	//The contents part of MeshDataValidation::Full, the layout must already be verified.
+	ErrorCode VerifyMeshDataContents(const MeshData* data);
+}
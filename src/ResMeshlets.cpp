@@ -0,0 +1,365 @@
+#include <ResRenderer.hpp>
+#include <ResMeshAdjacency.hpp>
+#include <ResVertexFormat.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define RES_MESHLET_CULL_AVX2
+#endif
+
+//Backend independent. Meshlets grow greedily from a seed triangle, taking the neighbor that adds the fewest vertices,
+//closest to the meshlet's center on ties. Bounds follow meshoptimizer's cluster bounds.
+
+namespace ResRenderer {
+
+	static_assert(sizeof(Meshlet) == 14 * sizeof(float), "CullMeshlets gathers Meshlet fields as floats");
+
+	static float Dot(const float* a, const float* b) {
+		return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+	}
+
+	static void Cross(const float* a, const float* b, float* out) {
+		out[0] = a[1] * b[2] - a[2] * b[1];
+		out[1] = a[2] * b[0] - a[0] * b[2];
+		out[2] = a[0] * b[1] - a[1] * b[0];
+	}
+
+	size_t RES_RENDERER_API GetMeshletCountBound(const MeshData* data) {
+		//A meshlet only closes once the next triangle doesn't fit.
+		size_t byTriangles = (data->indiciesCount / 3 + MESHLET_MAX_TRIANGLES - 1) / MESHLET_MAX_TRIANGLES;
+		size_t byVertices = (data->indiciesCount + MESHLET_MAX_VERTICES - 3) / (MESHLET_MAX_VERTICES - 2);
+		return std::max(byTriangles, byVertices);
+	}
+
+	static void ComputeMeshletBounds(const std::vector<float>& positions, const VertexIndex_t* indicies, Meshlet* meshlet) {
+		auto position = [&](VertexIndex_t v) { return &positions[v * 3]; };
+		auto first = indicies + meshlet->firstIndex;
+		auto count = meshlet->indexCount;
+
+		float lo[3] = { position(first[0])[0], position(first[0])[1], position(first[0])[2] };
+		float hi[3] = { lo[0], lo[1], lo[2] };
+		for (unsigned int i = 1; i < count; i++)
+		{
+			auto p = position(first[i]);
+			for (int k = 0; k < 3; k++)
+			{
+				lo[k] = std::min(lo[k], p[k]);
+				hi[k] = std::max(hi[k], p[k]);
+			}
+		}
+		for (int k = 0; k < 3; k++)
+			meshlet->center[k] = (lo[k] + hi[k]) * 0.5f;
+		float radius = 0.0f;
+		for (unsigned int i = 0; i < count; i++)
+		{
+			auto p = position(first[i]);
+			float d[3] = { p[0] - meshlet->center[0], p[1] - meshlet->center[1], p[2] - meshlet->center[2] };
+			radius = std::max(radius, Dot(d, d));
+		}
+		meshlet->radius = std::sqrt(radius);
+
+		//Average of unit normals, degenerate triangles don't count.
+		std::vector<float> normals;
+		std::vector<const float*> corners;
+		float axis[3] = { 0.0f, 0.0f, 0.0f };
+		for (unsigned int i = 0; i < count; i += 3)
+		{
+			auto p0 = position(first[i]), p1 = position(first[i + 1]), p2 = position(first[i + 2]);
+			float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			float n[3];
+			Cross(e1, e2, n);
+			float length = std::sqrt(Dot(n, n));
+			if (length <= 0.0f)
+				continue;
+			for (int k = 0; k < 3; k++)
+			{
+				normals.push_back(n[k] / length);
+				axis[k] += n[k] / length;
+			}
+			corners.push_back(p0);
+		}
+
+		memcpy(meshlet->coneApex, meshlet->center, sizeof(meshlet->center));
+		memset(meshlet->coneAxis, 0, sizeof(meshlet->coneAxis));
+		meshlet->coneCutoff = 2.0f;
+		float axisLength = std::sqrt(Dot(axis, axis));
+		if (axisLength <= 0.0f)
+			return;
+		for (int k = 0; k < 3; k++)
+			meshlet->coneAxis[k] = axis[k] / axisLength;
+
+		float minDot = 1.0f;
+		for (size_t t = 0; t < corners.size(); t++)
+			minDot = std::min(minDot, Dot(&normals[t * 3], meshlet->coneAxis));
+		//Wider than about 84 degrees, it would cull next to nothing.
+		if (minDot <= 0.1f)
+			return;
+
+		//Apex on or behind every triangle's plane, along the axis from the center.
+		float maxT = 0.0f;
+		for (size_t t = 0; t < corners.size(); t++)
+		{
+			auto n = &normals[t * 3];
+			float c[3] = { meshlet->center[0] - corners[t][0], meshlet->center[1] - corners[t][1], meshlet->center[2] - corners[t][2] };
+			maxT = std::max(maxT, Dot(c, n) / Dot(meshlet->coneAxis, n));
+		}
+		for (int k = 0; k < 3; k++)
+			meshlet->coneApex[k] = meshlet->center[k] - meshlet->coneAxis[k] * maxT;
+		meshlet->coneCutoff = std::sqrt(1.0f - minDot * minDot);
+	}
+
+	ErrorCode RES_RENDERER_API BuildMeshlets(MeshData* data, Meshlet* outMeshlets, size_t maxMeshlets, size_t* outMeshletCount) {
+		auto t = MeshDataVerify(data);
+		if (t != ErrorCode::RES_NO_ERROR)
+			return t;
+		if (data->indiciesCount % 3 != 0 || data->attribCount < 1 || data->attribDescriptions[0].count < 3)
+			return ErrorCode::MESH_DATA_BROKEN;
+		auto vertCount = data->vertCount;
+		for (size_t i = 0; i < data->indiciesCount; i++)
+		{
+			if (data->indicies[i] >= static_cast<VertexIndex_t>(vertCount))
+				return ErrorCode::MESH_DATA_BROKEN;
+		}
+
+		std::vector<float> positions(vertCount * 3);
+		auto stride = GetMeshVertexSize(data);
+		for (int v = 0; v < vertCount; v++)
+		{
+			float p[4];
+			UnpackVertexAttrib(data->attribDescriptions[0], static_cast<const unsigned char*>(data->data) + v * stride, p);
+			memcpy(&positions[v * 3], p, 3 * sizeof(float));
+		}
+		auto indicies = data->indicies;
+		auto triangleCount = data->indiciesCount / 3;
+		auto centroid = [&](unsigned int triangle, float* out) {
+			for (int k = 0; k < 3; k++)
+			{
+				out[k] = (positions[indicies[triangle * 3] * 3 + k] + positions[indicies[triangle * 3 + 1] * 3 + k]
+					+ positions[indicies[triangle * 3 + 2] * 3 + k]) / 3.0f;
+			}
+		};
+
+		VertexTriangles adjacency(indicies, triangleCount, vertCount);
+		std::vector<bool> emitted(triangleCount, false);
+		//Meshlet a vertex was last added to, tells if a triangle brings new vertices.
+		std::vector<int> meshletOf(vertCount, -1);
+		std::vector<unsigned int> order;
+		order.reserve(triangleCount);
+		std::vector<unsigned int> candidates;
+		size_t meshletCount = 0;
+		size_t cursor = 0;
+		while (order.size() < triangleCount)
+		{
+			if (meshletCount == maxMeshlets)
+				return ErrorCode::BUFFER_TOO_SMALL;
+			int id = static_cast<int>(meshletCount);
+			auto& meshlet = outMeshlets[meshletCount++];
+			meshlet.firstIndex = static_cast<unsigned int>(order.size() * 3);
+			meshlet.vertexCount = 0;
+			candidates.clear();
+			float sum[3] = { 0.0f, 0.0f, 0.0f };
+
+			while (emitted[cursor])
+				cursor++;
+			auto newVertices = [&](unsigned int triangle) {
+				unsigned int count = 0;
+				for (int c = 0; c < 3; c++)
+					count += meshletOf[indicies[triangle * 3 + c]] != id ? 1 : 0;
+				return count;
+			};
+			long long triangle = static_cast<long long>(cursor);
+			unsigned int triangles = 0;
+			while (triangle >= 0)
+			{
+				auto added = static_cast<unsigned int>(triangle);
+				emitted[added] = true;
+				order.push_back(added);
+				triangles++;
+				for (int c = 0; c < 3; c++)
+				{
+					auto v = indicies[added * 3 + c];
+					if (meshletOf[v] == id)
+						continue;
+					meshletOf[v] = id;
+					meshlet.vertexCount++;
+					for (int k = 0; k < 3; k++)
+						sum[k] += positions[v * 3 + k];
+					for (auto a = adjacency.offsets[v]; a < adjacency.offsets[v + 1]; a++)
+					{
+						if (!emitted[adjacency.triangles[a]])
+							candidates.push_back(adjacency.triangles[a]);
+					}
+				}
+				if (triangles == MESHLET_MAX_TRIANGLES)
+					break;
+
+				float center[3] = { sum[0] / meshlet.vertexCount, sum[1] / meshlet.vertexCount, sum[2] / meshlet.vertexCount };
+				triangle = -1;
+				unsigned int bestNew = 4;
+				float bestDistance = 0.0f;
+				for (size_t i = 0; i < candidates.size();)
+				{
+					auto candidate = candidates[i];
+					if (emitted[candidate]) {
+						candidates[i] = candidates.back();
+						candidates.pop_back();
+						continue;
+					}
+					i++;
+					auto added = newVertices(candidate);
+					if (added > bestNew || meshlet.vertexCount + added > MESHLET_MAX_VERTICES)
+						continue;
+					float c[3];
+					centroid(candidate, c);
+					float d[3] = { c[0] - center[0], c[1] - center[1], c[2] - center[2] };
+					float distance = Dot(d, d);
+					if (added < bestNew || distance < bestDistance) {
+						bestNew = added;
+						bestDistance = distance;
+						triangle = candidate;
+					}
+				}
+				if (triangle < 0) {
+					//Ran out of neighbors, continue with the next unused triangle if it fits.
+					while (cursor < triangleCount && emitted[cursor])
+						cursor++;
+					if (cursor < triangleCount && meshlet.vertexCount + newVertices(static_cast<unsigned int>(cursor)) <= MESHLET_MAX_VERTICES)
+						triangle = static_cast<long long>(cursor);
+				}
+			}
+			meshlet.indexCount = triangles * 3;
+		}
+
+		std::vector<VertexIndex_t> reordered(data->indiciesCount);
+		for (size_t i = 0; i < triangleCount; i++)
+		{
+			for (int c = 0; c < 3; c++)
+				reordered[i * 3 + c] = indicies[order[i] * 3 + c];
+		}
+		memcpy(indicies, reordered.data(), reordered.size() * sizeof(VertexIndex_t));
+		for (size_t m = 0; m < meshletCount; m++)
+			ComputeMeshletBounds(positions, indicies, &outMeshlets[m]);
+		*outMeshletCount = meshletCount;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API MakeMeshletCullView(const float* modelViewProjection, const float* cameraPosition, MeshletCullView* outView) {
+		//Gribb and Hartmann: clip space -w <= x, y, z <= w as planes of row 3 plus or minus rows 0, 1, 2.
+		auto m = modelViewProjection;
+		for (int p = 0; p < 6; p++)
+		{
+			int row = p / 2;
+			float sign = p % 2 == 0 ? 1.0f : -1.0f;
+			float plane[4];
+			for (int k = 0; k < 4; k++)
+				plane[k] = m[k * 4 + 3] + sign * m[k * 4 + row];
+			float length = std::sqrt(Dot(plane, plane));
+			if (length <= 0.0f)
+				return ErrorCode::INTERNAL_ERROR;
+			for (int k = 0; k < 4; k++)
+				outView->planes[p][k] = plane[k] / length;
+		}
+		memcpy(outView->cameraPosition, cameraPosition, sizeof(outView->cameraPosition));
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	static bool MeshletVisible(const Meshlet& meshlet, const MeshletCullView& view) {
+		for (auto& plane : view.planes)
+		{
+			if (plane[0] * meshlet.center[0] + plane[1] * meshlet.center[1] + plane[2] * meshlet.center[2] + plane[3] < -meshlet.radius)
+				return false;
+		}
+		float d[3];
+		for (int k = 0; k < 3; k++)
+			d[k] = meshlet.coneApex[k] - view.cameraPosition[k];
+		return !(Dot(d, meshlet.coneAxis) >= meshlet.coneCutoff * std::sqrt(Dot(d, d)));
+	}
+
+#ifdef RES_MESHLET_CULL_AVX2
+	static bool HasAVX2() {
+		static const bool has = __builtin_cpu_supports("avx2") != 0;
+		return has;
+	}
+
+	//member of 8 consecutive meshlets.
+	__attribute__((target("avx2")))
+	static inline __m256 GatherField(const float* member) {
+		const int fields = sizeof(Meshlet) / sizeof(float);
+		auto offsets = _mm256_setr_epi32(0, fields, fields * 2, fields * 3, fields * 4, fields * 5, fields * 6, fields * 7);
+		return _mm256_i32gather_ps(member, offsets, 4);
+	}
+
+	//Same operations in the same order as MeshletVisible, so both agree on every meshlet. Returns a bit per meshlet.
+	__attribute__((target("avx2")))
+	static int MeshletsVisibleAVX2(const Meshlet* meshlets, const MeshletCullView& view) {
+		__m256 center[3] = { GatherField(&meshlets->center[0]), GatherField(&meshlets->center[1]), GatherField(&meshlets->center[2]) };
+		auto negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), GatherField(&meshlets->radius));
+		auto outside = _mm256_setzero_ps();
+		for (auto& plane : view.planes)
+		{
+			auto distance = _mm256_mul_ps(_mm256_set1_ps(plane[0]), center[0]);
+			distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane[1]), center[1]));
+			distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane[2]), center[2]));
+			distance = _mm256_add_ps(distance, _mm256_set1_ps(plane[3]));
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, negativeRadius, _CMP_LT_OQ));
+		}
+		__m256 d[3];
+		for (int k = 0; k < 3; k++)
+			d[k] = _mm256_sub_ps(GatherField(&meshlets->coneApex[k]), _mm256_set1_ps(view.cameraPosition[k]));
+		auto along = _mm256_mul_ps(d[0], GatherField(&meshlets->coneAxis[0]));
+		along = _mm256_add_ps(along, _mm256_mul_ps(d[1], GatherField(&meshlets->coneAxis[1])));
+		along = _mm256_add_ps(along, _mm256_mul_ps(d[2], GatherField(&meshlets->coneAxis[2])));
+		auto length = _mm256_mul_ps(d[0], d[0]);
+		length = _mm256_add_ps(length, _mm256_mul_ps(d[1], d[1]));
+		length = _mm256_add_ps(length, _mm256_mul_ps(d[2], d[2]));
+		auto backfacing = _mm256_cmp_ps(along, _mm256_mul_ps(GatherField(&meshlets->coneCutoff), _mm256_sqrt_ps(length)), _CMP_GE_OQ);
+		return ~_mm256_movemask_ps(_mm256_or_ps(outside, backfacing)) & 0xFF;
+	}
+#endif
+
+	ErrorCode RES_RENDERER_API CullMeshlets(const Meshlet* meshlets, size_t count, const MeshletCullView* view,
+		IndexRange* outRanges, size_t* outRangeCount, size_t* outVisibleCount) {
+		if (count > 0 && (meshlets == nullptr || outRanges == nullptr))
+			return ErrorCode::INTERNAL_ERROR;
+		size_t ranges = 0;
+		size_t visible = 0;
+		auto add = [&](const Meshlet& meshlet) {
+			visible++;
+			if (ranges > 0 && outRanges[ranges - 1].firstIndex + outRanges[ranges - 1].indexCount == meshlet.firstIndex) {
+				outRanges[ranges - 1].indexCount += meshlet.indexCount;
+				return;
+			}
+			outRanges[ranges].firstIndex = meshlet.firstIndex;
+			outRanges[ranges].indexCount = meshlet.indexCount;
+			ranges++;
+		};
+
+		size_t i = 0;
+#ifdef RES_MESHLET_CULL_AVX2
+		if (HasAVX2()) {
+			for (; i + 8 <= count; i += 8)
+			{
+				int mask = MeshletsVisibleAVX2(meshlets + i, *view);
+				for (int lane = 0; mask != 0; lane++, mask >>= 1)
+				{
+					if (mask & 1)
+						add(meshlets[i + lane]);
+				}
+			}
+		}
+#endif
+		for (; i < count; i++)
+		{
+			if (MeshletVisible(meshlets[i], *view))
+				add(meshlets[i]);
+		}
+		*outRangeCount = ranges;
+		if (outVisibleCount != nullptr)
+			*outVisibleCount = visible;
+		return ErrorCode::RES_NO_ERROR;
+	}
+}
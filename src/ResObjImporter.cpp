@@ -0,0 +1,577 @@
+#include <ResMeshFile.hpp>
+#include <ResParallel.hpp>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
+
+//The mapped file is split into chunks of whole lines, every step runs over chunks in parallel:
+//1. Count v, vt and vn lines, prefix sums give every chunk the global index of its first element, so negative(relative)
+//   indices resolve while parsing and elements go straight to their final place.
+//2. Parse. Faces become triangle fans of corners, one int per position, uv and normal the file has.
+//3. Deduplicate corners. Corners matching their position's first corner share its vertex, the few others are partitioned
+//   by hash and every partition gets its own open addressing table. Numbering doesn't depend on thread timing.
+
+namespace ResRenderer {
+
+	static const size_t MinChunkBytes = 1 << 20;
+	static const int Partitions = 256;
+
+	struct ObjChunk {
+		const char* begin;
+		const char* end;
+		size_t positions = 0;
+		size_t uvs = 0;
+		size_t normals = 0;
+		size_t positionBase = 0;
+		size_t uvBase = 0;
+		size_t normalBase = 0;
+		std::vector<int> corners;		//Grows ahead, the first cornerInts are used.
+		size_t cornerInts = 0;
+		bool broken = false;
+	};
+
+	static inline const char* SkipSpaces(const char* p, const char* end) {
+		while (p < end && (*p == ' ' || *p == '\t'))
+			p++;
+		return p;
+	}
+
+	static inline const char* NextLine(const char* p, const char* end) {
+		auto newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+		return newline != nullptr ? newline + 1 : end;
+	}
+
+	//Whether the line at p starts with keyword followed by white space.
+	static inline bool IsKeyword(const char* p, const char* end, const char* keyword, size_t length) {
+		return static_cast<size_t>(end - p) > length && std::memcmp(p, keyword, length) == 0 && (p[length] == ' ' || p[length] == '\t');
+	}
+
+	static inline bool IsDigit(char c) {
+		return static_cast<unsigned char>(c - '0') < 10;
+	}
+
+	static const double PowersOf10[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+	};
+
+	//Up to 19 digits go into an integer, which times or over an exact power of 10 is exact in double as long as it's below
+	//2^53 and the exponent within 22. That covers what exporters write, the rest goes to strtod.
+	static bool ParseFloat(const char*& p, const char* end, float* out) {
+		auto start = p;
+		bool negative = p < end && *p == '-';
+		p += p < end && (*p == '-' || *p == '+');
+		std::uint64_t mantissa = 0;
+		auto digitsStart = p;
+		for (; p < end && IsDigit(*p); p++)
+			mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+		auto digits = p - digitsStart;
+		int exponent = 0;
+		if (p < end && *p == '.') {
+			auto fractionStart = ++p;
+			for (; p < end && IsDigit(*p); p++)
+				mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+			digits += p - fractionStart;
+			exponent = -static_cast<int>(p - fractionStart);
+		}
+		if (digits == 0)
+			return false;
+		if (p < end && (*p == 'e' || *p == 'E')) {
+			p++;
+			bool negativeExponent = p < end && *p == '-';
+			p += p < end && (*p == '-' || *p == '+');
+			if (p >= end || !IsDigit(*p))
+				return false;
+			int e = 0;
+			for (; p < end && IsDigit(*p); p++)
+				e = std::min(e * 10 + (*p - '0'), 100000);
+			exponent += negativeExponent ? -e : e;
+		}
+
+		double value;
+		if (digits <= 19 && mantissa < (1ull << 53) && exponent >= -22 && exponent <= 22) {
+			value = exponent < 0 ? mantissa / PowersOf10[-exponent] : mantissa * PowersOf10[exponent];
+			if (negative)
+				value = -value;
+		}
+		else {
+			char buffer[64];
+			auto length = std::min(static_cast<size_t>(p - start), sizeof(buffer) - 1);
+			std::memcpy(buffer, start, length);
+			buffer[length] = '\0';
+			value = std::strtod(buffer, nullptr);
+		}
+		*out = static_cast<float>(value);
+		return true;
+	}
+
+	//OBJ indices count from 1, negative ones back from the last element so far. Out is 0 based.
+	static bool ParseIndex(const char*& p, const char* end, size_t current, size_t total, int* out) {
+		bool negative = p < end && *p == '-';
+		p += negative;
+		auto start = p;
+		std::uint64_t value = 0;
+		//More than 10 digits is out of range anyway, 19 can't overflow.
+		for (; p < end && IsDigit(*p) && p - start < 19; p++)
+			value = value * 10 + static_cast<unsigned>(*p - '0');
+		if (p == start || (p < end && IsDigit(*p)) || value == 0 || value > total)
+			return false;
+		auto index = negative ? static_cast<long long>(current) - static_cast<long long>(value) : static_cast<long long>(value) - 1;
+		if (index < 0 || index >= static_cast<long long>(total))
+			return false;
+		*out = static_cast<int>(index);
+		return true;
+	}
+
+	static inline bool AtLineEnd(const char* p, const char* end) {
+		return p >= end || *p == '\n' || *p == '\r' || *p == '#';
+	}
+
+	static void CountChunk(ObjChunk& chunk) {
+		for (auto p = chunk.begin; p < chunk.end; p = NextLine(p, chunk.end))
+		{
+			p = SkipSpaces(p, chunk.end);
+			if (p >= chunk.end || *p != 'v')
+				continue;
+			if (IsKeyword(p, chunk.end, "v", 1))
+				chunk.positions++;
+			else if (IsKeyword(p, chunk.end, "vt", 2))
+				chunk.uvs++;
+			else if (IsKeyword(p, chunk.end, "vn", 2))
+				chunk.normals++;
+		}
+	}
+
+	struct ObjTotals {
+		size_t positions;
+		size_t uvs;
+		size_t normals;
+	};
+
+	static bool ParseFloats(const char*& p, const char* end, int count, float* out) {
+		for (int i = 0; i < count; i++)
+		{
+			p = SkipSpaces(p, end);
+			if (!ParseFloat(p, end, out + i))
+				return false;
+			if (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+				return false;
+		}
+		return true;
+	}
+
+	//vt u [v] [w], v defaults to 0 and w is ignored.
+	static bool ParseUV(const char*& p, const char* end, float* out) {
+		out[1] = 0.0f;
+		if (!ParseFloats(p, end, 1, out))
+			return false;
+		p = SkipSpaces(p, end);
+		if (AtLineEnd(p, end))
+			return true;
+		return ParseFloats(p, end, 1, out + 1);
+	}
+
+	static bool ParseFace(const char*& p, const char* end, ObjChunk& chunk, const ObjTotals& totals, size_t positions, size_t uvs, size_t normals, int stride) {
+		int first[3] = { -1, -1, -1 }, previous[3] = { -1, -1, -1 };
+		int count = 0;
+		for (;;)
+		{
+			p = SkipSpaces(p, end);
+			if (AtLineEnd(p, end))
+				break;
+			int corner[3] = { -1, -1, -1 };
+			if (!ParseIndex(p, end, positions, totals.positions, &corner[0]))
+				return false;
+			if (p < end && *p == '/') {
+				p++;
+				if (p < end && *p != '/' && !ParseIndex(p, end, uvs, totals.uvs, &corner[1]))
+					return false;
+				if (p < end && *p == '/') {
+					p++;
+					if (!ParseIndex(p, end, normals, totals.normals, &corner[2]))
+						return false;
+				}
+			}
+			if (!AtLineEnd(p, end) && *p != ' ' && *p != '\t')
+				return false;
+
+			//Only the components the file has.
+			int packed[3];
+			int n = 0;
+			packed[n++] = corner[0];
+			if (totals.uvs > 0)
+				packed[n++] = corner[1];
+			if (totals.normals > 0)
+				packed[n++] = corner[2];
+			if (count == 0)
+				std::copy(packed, packed + stride, first);
+			else if (count >= 2) {
+				if (chunk.corners.size() < chunk.cornerInts + stride * 3)
+					chunk.corners.resize(std::max<size_t>(chunk.corners.size() * 2, 1024));
+				auto triangle = &chunk.corners[chunk.cornerInts];
+				for (int i = 0; i < stride; i++)
+				{
+					triangle[i] = first[i];
+					triangle[stride + i] = previous[i];
+					triangle[stride * 2 + i] = packed[i];
+				}
+				chunk.cornerInts += stride * 3;
+			}
+			std::copy(packed, packed + stride, previous);
+			count++;
+		}
+		return count >= 3;
+	}
+
+	static void ParseChunk(ObjChunk& chunk, const ObjTotals& totals, int stride, float* positions, float* uvs, float* normals) {
+		auto position = chunk.positionBase, uv = chunk.uvBase, normal = chunk.normalBase;
+		auto end = chunk.end;
+		for (auto p = chunk.begin; p < end; p = NextLine(p, end))
+		{
+			p = SkipSpaces(p, end);
+			bool ok = true;
+			if (p >= end)
+				break;
+			if (*p == 'v') {
+				if (IsKeyword(p, end, "v", 1)) {
+					p += 1;
+					ok = ParseFloats(p, end, 3, positions + position++ * 3);
+				}
+				else if (IsKeyword(p, end, "vt", 2)) {
+					p += 2;
+					ok = ParseUV(p, end, uvs + uv++ * 2);
+				}
+				else if (IsKeyword(p, end, "vn", 2)) {
+					p += 2;
+					ok = ParseFloats(p, end, 3, normals + normal++ * 3);
+				}
+			}
+			else if (*p == 'f' && IsKeyword(p, end, "f", 1)) {
+				p += 1;
+				ok = ParseFace(p, end, chunk, totals, position, uv, normal, stride);
+			}
+			if (!ok) {
+				chunk.broken = true;
+				return;
+			}
+		}
+		chunk.corners.resize(chunk.cornerInts);
+	}
+
+	static inline std::uint64_t HashCorner(const int* corner, int stride) {
+		std::uint64_t h = static_cast<std::uint32_t>(corner[0]) * 0x9E3779B97F4A7C15ull;
+		for (int i = 1; i < stride; i++)
+			h = (h ^ (h >> 29) ^ static_cast<std::uint32_t>(corner[i])) * 0xBF58476D1CE4E5B9ull;
+		return h ^ (h >> 32);
+	}
+
+	//Blocks of a range for ParallelFor, about 4 per thread and at least minBlock items.
+	static size_t BlockSize(const SharedWorkerPool& pool, size_t count, size_t minBlock) {
+		auto blocks = static_cast<size_t>(pool.GetThreadCount()) * 4;
+		return std::max((count + blocks - 1) / blocks, minBlock);
+	}
+
+	static int BlockCount(size_t count, size_t blockSize) {
+		return static_cast<int>((count + blockSize - 1) / blockSize);
+	}
+
+	//Vertices of the corners in ids, numbered from vertexCorners.size() on by partition, then by first use within it.
+	static void DeduplicateByHash(SharedWorkerPool& pool, const std::vector<int>& corners, int stride, const std::vector<std::uint32_t>& ids,
+		std::vector<VertexIndex_t>& indicies, std::vector<std::uint32_t>& vertexCorners) {
+		auto count = ids.size();
+		auto blockSize = BlockSize(pool, count, 65536);
+		int blocks = BlockCount(count, blockSize);
+		auto partitionOf = [&](std::uint32_t c) {
+			return static_cast<int>(HashCorner(&corners[static_cast<size_t>(c) * stride], stride) >> 56);
+		};
+
+		//Partition ids, keeping their order within every partition.
+		std::vector<size_t> offsets(static_cast<size_t>(blocks) * Partitions, 0);
+		pool.ParallelFor(blocks, [&](int block, int) {
+			auto counts = &offsets[static_cast<size_t>(block) * Partitions];
+			for (auto i = block * blockSize; i < std::min(count, (block + 1) * blockSize); i++)
+				counts[partitionOf(ids[i])]++;
+		});
+		std::vector<size_t> partitionStarts(Partitions + 1, 0);
+		size_t offset = 0;
+		for (int p = 0; p < Partitions; p++)
+		{
+			partitionStarts[p] = offset;
+			for (int b = 0; b < blocks; b++)
+			{
+				auto& blockOffset = offsets[static_cast<size_t>(b) * Partitions + p];
+				auto blockCount = blockOffset;
+				blockOffset = offset;
+				offset += blockCount;
+			}
+		}
+		partitionStarts[Partitions] = offset;
+		std::vector<std::uint32_t> order(count);
+		pool.ParallelFor(blocks, [&](int block, int) {
+			auto blockOffsets = &offsets[static_cast<size_t>(block) * Partitions];
+			for (auto i = block * blockSize; i < std::min(count, (block + 1) * blockSize); i++)
+				order[blockOffsets[partitionOf(ids[i])]++] = ids[i];
+		});
+
+		//Every partition numbers its own vertices, their corners go to the front of its range in uniqueCorners.
+		std::vector<std::uint32_t> uniqueCorners(count);
+		std::vector<size_t> vertexCounts(Partitions, 0);
+		std::vector<std::vector<std::int32_t>> tables(pool.GetThreadCount());
+		pool.ParallelFor(Partitions, [&](int partition, int thread) {
+			auto begin = partitionStarts[partition], end = partitionStarts[partition + 1];
+			if (begin == end)
+				return;
+			size_t tableSize = 16;
+			while (tableSize < (end - begin) * 2)
+				tableSize *= 2;
+			auto& table = tables[thread];
+			table.assign(tableSize, -1);
+			size_t vertices = 0;
+			for (auto i = begin; i < end; i++)
+			{
+				auto c = order[i];
+				auto corner = &corners[static_cast<size_t>(c) * stride];
+				auto slot = static_cast<size_t>(HashCorner(corner, stride)) & (tableSize - 1);
+				for (;; slot = (slot + 1) & (tableSize - 1))
+				{
+					auto v = table[slot];
+					if (v < 0) {
+						table[slot] = static_cast<std::int32_t>(vertices);
+						uniqueCorners[begin + vertices] = c;
+						indicies[c] = static_cast<VertexIndex_t>(vertices++);
+						break;
+					}
+					if (std::memcmp(&corners[static_cast<size_t>(uniqueCorners[begin + v]) * stride], corner, stride * sizeof(int)) == 0) {
+						indicies[c] = static_cast<VertexIndex_t>(v);
+						break;
+					}
+				}
+			}
+			vertexCounts[partition] = vertices;
+		});
+
+		//Partitions' vertices back to back.
+		std::vector<size_t> vertexBases(Partitions + 1, vertexCorners.size());
+		for (int p = 0; p < Partitions; p++)
+			vertexBases[p + 1] = vertexBases[p] + vertexCounts[p];
+		vertexCorners.resize(vertexBases[Partitions]);
+		pool.ParallelFor(Partitions, [&](int partition, int) {
+			auto begin = partitionStarts[partition];
+			std::copy(uniqueCorners.begin() + begin, uniqueCorners.begin() + begin + vertexCounts[partition], vertexCorners.begin() + vertexBases[partition]);
+			for (auto i = begin; i < partitionStarts[partition + 1]; i++)
+				indicies[order[i]] += static_cast<VertexIndex_t>(vertexBases[partition]);
+		});
+	}
+
+	//Most corners of a position agree on uv and normal, so every used position gets the vertex of its first corner, in
+	//position order. The first corner is an atomic min over corner ids, so it doesn't depend on thread timing. Only corners
+	//that differ from it(uv seams, hard edges) go through DeduplicateByHash. vertexCorners gets a corner of every vertex.
+	static bool Deduplicate(SharedWorkerPool& pool, const std::vector<int>& corners, int stride, size_t positionCount,
+		std::vector<VertexIndex_t>& outIndicies, std::vector<std::uint32_t>& outVertexCorners) {
+		auto cornerCount = corners.size() / stride;
+		auto cornerBlock = BlockSize(pool, cornerCount, 65536);
+		int cornerBlocks = BlockCount(cornerCount, cornerBlock);
+		auto positionBlock = BlockSize(pool, positionCount, 65536);
+		int positionBlocks = BlockCount(positionCount, positionBlock);
+
+		std::unique_ptr<std::atomic<std::uint32_t>[]> firstCorners(new std::atomic<std::uint32_t>[positionCount]);
+		pool.ParallelFor(positionBlocks, [&](int block, int) {
+			for (auto p = block * positionBlock; p < std::min(positionCount, (block + 1) * positionBlock); p++)
+				firstCorners[p].store(UINT32_MAX, std::memory_order_relaxed);
+		});
+		pool.ParallelFor(cornerBlocks, [&](int block, int) {
+			for (auto c = block * cornerBlock; c < std::min(cornerCount, (block + 1) * cornerBlock); c++)
+			{
+				auto& first = firstCorners[corners[c * stride]];
+				auto current = first.load(std::memory_order_relaxed);
+				while (c < current && !first.compare_exchange_weak(current, static_cast<std::uint32_t>(c), std::memory_order_relaxed)) {}
+			}
+		});
+
+		//Used positions numbered in order.
+		std::vector<size_t> blockVertices(positionBlocks + 1, 0);
+		pool.ParallelFor(positionBlocks, [&](int block, int) {
+			for (auto p = block * positionBlock; p < std::min(positionCount, (block + 1) * positionBlock); p++)
+				blockVertices[block + 1] += firstCorners[p].load(std::memory_order_relaxed) != UINT32_MAX;
+		});
+		for (int b = 0; b < positionBlocks; b++)
+			blockVertices[b + 1] += blockVertices[b];
+		std::vector<VertexIndex_t> positionVertices(positionCount);
+		outVertexCorners.resize(blockVertices[positionBlocks]);
+		pool.ParallelFor(positionBlocks, [&](int block, int) {
+			auto vertex = blockVertices[block];
+			for (auto p = block * positionBlock; p < std::min(positionCount, (block + 1) * positionBlock); p++)
+			{
+				auto first = firstCorners[p].load(std::memory_order_relaxed);
+				if (first == UINT32_MAX)
+					continue;
+				outVertexCorners[vertex] = first;
+				positionVertices[p] = static_cast<VertexIndex_t>(vertex++);
+			}
+		});
+
+		outIndicies.resize(cornerCount);
+		std::vector<std::vector<std::uint32_t>> blockSplits(cornerBlocks);
+		pool.ParallelFor(cornerBlocks, [&](int block, int) {
+			for (auto c = block * cornerBlock; c < std::min(cornerCount, (block + 1) * cornerBlock); c++)
+			{
+				auto corner = &corners[c * stride];
+				auto first = firstCorners[corner[0]].load(std::memory_order_relaxed);
+				if (first == c || std::memcmp(&corners[static_cast<size_t>(first) * stride], corner, stride * sizeof(int)) == 0)
+					outIndicies[c] = positionVertices[corner[0]];
+				else
+					blockSplits[block].push_back(static_cast<std::uint32_t>(c));
+			}
+		});
+		std::vector<std::uint32_t> splits;
+		for (auto& blockSplit : blockSplits)
+			splits.insert(splits.end(), blockSplit.begin(), blockSplit.end());
+		if (!splits.empty())
+			DeduplicateByHash(pool, corners, stride, splits, outIndicies, outVertexCorners);
+		return outVertexCorners.size() <= static_cast<size_t>(INT_MAX);
+	}
+
+	//Chunks' corners back to back, freeing them on the way.
+	template<typename T>
+	static void GatherCorners(SharedWorkerPool& pool, std::vector<ObjChunk>& chunks, size_t cornerInts, std::vector<T>& outCorners) {
+		outCorners.resize(cornerInts);
+		std::vector<size_t> offsets(chunks.size(), 0);
+		for (size_t i = 1; i < chunks.size(); i++)
+			offsets[i] = offsets[i - 1] + chunks[i - 1].corners.size();
+		pool.ParallelFor(static_cast<int>(chunks.size()), [&](int i, int) {
+			std::copy(chunks[i].corners.begin(), chunks[i].corners.end(), outCorners.begin() + offsets[i]);
+			std::vector<int>().swap(chunks[i].corners);
+		});
+	}
+
+	static ErrorCode ImportObj(const MeshFileImpl& file, MeshFileImpl* out, MeshData* outData) {
+		SharedWorkerPool pool;
+		auto text = reinterpret_cast<const char*>(file.Bytes());
+		auto textEnd = text + file.Size();
+
+		auto chunkCount = static_cast<int>(std::max<size_t>(1, std::min(file.Size() / MinChunkBytes, static_cast<size_t>(pool.GetThreadCount()) * 8)));
+		std::vector<ObjChunk> chunks(chunkCount);
+		for (int i = 0; i < chunkCount; i++)
+		{
+			chunks[i].begin = i == 0 ? text : chunks[i - 1].end;
+			auto target = std::max(text + file.Size() / chunkCount * (i + 1), chunks[i].begin);
+			chunks[i].end = i == chunkCount - 1 ? textEnd : NextLine(target, textEnd);
+		}
+
+		pool.ParallelFor(chunkCount, [&](int i, int) { CountChunk(chunks[i]); });
+		ObjTotals totals = { 0, 0, 0 };
+		for (auto& chunk : chunks)
+		{
+			chunk.positionBase = totals.positions;
+			chunk.uvBase = totals.uvs;
+			chunk.normalBase = totals.normals;
+			totals.positions += chunk.positions;
+			totals.uvs += chunk.uvs;
+			totals.normals += chunk.normals;
+		}
+		if (totals.positions == 0 || totals.positions > static_cast<size_t>(INT_MAX) || totals.uvs > static_cast<size_t>(INT_MAX) || totals.normals > static_cast<size_t>(INT_MAX))
+			return ErrorCode::MESH_FILE_INVALID;
+
+		int stride = 1 + (totals.uvs > 0) + (totals.normals > 0);
+		std::vector<float> positions(totals.positions * 3), uvs(totals.uvs * 2), normals(totals.normals * 3);
+		pool.ParallelFor(chunkCount, [&](int i, int) { ParseChunk(chunks[i], totals, stride, positions.data(), uvs.data(), normals.data()); });
+		size_t cornerInts = 0;
+		for (auto& chunk : chunks)
+		{
+			if (chunk.broken)
+				return ErrorCode::MESH_FILE_INVALID;
+			cornerInts += chunk.corners.size();
+		}
+		if (cornerInts == 0 || cornerInts / stride > UINT32_MAX)
+			return ErrorCode::MESH_FILE_INVALID;
+
+		MeshData data;
+		MeshDataAppendAttrib(&data, VertexAttribType::ResFloat, 3, false);
+		if (totals.normals > 0)
+			MeshDataAppendAttrib(&data, VertexAttribType::ResFloat, 3, false);
+		if (totals.uvs > 0)
+			MeshDataAppendAttrib(&data, VertexAttribType::ResFloat, 2, false);
+
+		if (stride == 1) {
+			//Positions are the vertices.
+			GatherCorners(pool, chunks, cornerInts, out->indicies);
+			out->vertices.swap(positions);
+		}
+		else {
+			std::vector<int> corners;
+			GatherCorners(pool, chunks, cornerInts, corners);
+			std::vector<std::uint32_t> vertexCorners;
+			if (!Deduplicate(pool, corners, stride, totals.positions, out->indicies, vertexCorners))
+				return ErrorCode::MESH_FILE_INVALID;
+
+			auto vertSize = GetMeshVertexSize(&data) / sizeof(float);
+			auto vertCount = vertexCorners.size();
+			out->vertices.resize(vertCount * vertSize);
+			auto blockSize = BlockSize(pool, vertCount, 4096);
+			pool.ParallelFor(BlockCount(vertCount, blockSize), [&](int block, int) {
+				for (auto v = block * blockSize; v < std::min(vertCount, (block + 1) * blockSize); v++)
+				{
+					auto corner = &corners[static_cast<size_t>(vertexCorners[v]) * stride];
+					auto vertex = &out->vertices[v * vertSize];
+					std::copy(&positions[corner[0] * 3ull], &positions[corner[0] * 3ull + 3], vertex);
+					vertex += 3;
+					int component = 1;
+					int uv = totals.uvs > 0 ? corner[component++] : -1;
+					if (totals.normals > 0) {
+						int normal = corner[component];
+						if (normal >= 0)
+							std::copy(&normals[normal * 3ull], &normals[normal * 3ull + 3], vertex);
+						else
+							std::fill(vertex, vertex + 3, 0.0f);
+						vertex += 3;
+					}
+					if (totals.uvs > 0) {
+						if (uv >= 0)
+							std::copy(&uvs[uv * 2ull], &uvs[uv * 2ull + 2], vertex);
+						else
+							std::fill(vertex, vertex + 2, 0.0f);
+					}
+				}
+			});
+		}
+
+		data.vertCount = static_cast<int>(out->vertices.size() * sizeof(float) / GetMeshVertexSize(&data));
+		data.data = out->vertices.data();
+		data.dataSize = out->vertices.size() * sizeof(float);
+		data.indicies = out->indicies.data();
+		data.indiciesCount = out->indicies.size();
+		*outData = data;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API ImportObjFile(const char* path, MeshFile* outFile, MeshData* outData) {
+		auto file = new (std::nothrow) MeshFileImpl();
+		if (file == nullptr)
+			return ErrorCode::INTERNAL_ERROR;
+		ErrorCode t;
+		try
+		{
+			t = file->Map(path);
+			if (t == ErrorCode::RES_NO_ERROR)
+				t = ImportObj(*file, file, outData);
+		}
+		//Also thrown by workers, ParallelFor rethrows here once they are all done.
+		catch (std::bad_alloc&)
+		{
+			t = ErrorCode::INTERNAL_ERROR;
+		}
+		file->Unmap();
+		if (t != ErrorCode::RES_NO_ERROR) {
+			delete file;
+			return t;
+		}
+		*outFile = file;
+		return ErrorCode::RES_NO_ERROR;
+	}
+}
@@ -0,0 +1,174 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Small persistent worker pool shared by the CPU-side code paths.
+//The calling thread always takes part in the work, so a pool of N threads spawns N - 1 workers.
+
+namespace ResRenderer {
+
+	class WorkerPool {
+	public:
+		explicit WorkerPool(int threadCount = 0) {
+			if (threadCount <= 0)
+				threadCount = HardwareThreadCount();
+			for (int i = 1; i < threadCount; i++)
+			{
+				threads.emplace_back(&WorkerPool::WorkerMain, this, i);
+			}
+		}
+
+		~WorkerPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				quit = true;
+			}
+			wakeCv.notify_all();
+			for (auto& t : threads)
+				t.join();
+		}
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		int GetThreadCount() const {
+			return static_cast<int>(threads.size()) + 1;
+		}
+
+		static int HardwareThreadCount() {
+			auto n = static_cast<int>(std::thread::hardware_concurrency());
+			return n > 0 ? n : 1;
+		}
+
+		//Runs func(index, threadIndex) for every index in [0, count), returns when all are done.
+		//Indices are handed out dynamically, so uneven work items balance themselves. Once func throws no more indices are
+		//handed out, the first exception is rethrown on the calling thread after every thread is done.
+		template<typename F>
+		void ParallelFor(int count, F func) {
+			if (count <= 0)
+				return;
+			if (threads.empty() || count == 1) {
+				for (int i = 0; i < count; i++)
+					func(i, 0);
+				return;
+			}
+
+			std::function<void(int, int)> wrapped = func;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				job = &wrapped;
+				jobCount = count;
+				nextIndex.store(0, std::memory_order_relaxed);
+				pending = static_cast<int>(threads.size());
+				generation++;
+			}
+			wakeCv.notify_all();
+			RunJob(0);
+
+			std::unique_lock<std::mutex> lock(mutex);
+			doneCv.wait(lock, [this] { return pending == 0; });
+			job = nullptr;
+			auto thrown = error;
+			error = nullptr;
+			lock.unlock();
+			if (thrown)
+				std::rethrow_exception(thrown);
+		}
+
+	private:
+		void RunJob(int threadIndex) {
+			int i;
+			while ((i = nextIndex.fetch_add(1, std::memory_order_relaxed)) < jobCount)
+			{
+				try
+				{
+					(*job)(i, threadIndex);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					if (!error)
+						error = std::current_exception();
+					nextIndex.store(jobCount, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		void WorkerMain(int threadIndex) {
+			unsigned long long seenGeneration = 0;
+			for (;;)
+			{
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					wakeCv.wait(lock, [&] { return quit || generation != seenGeneration; });
+					if (quit)
+						return;
+					seenGeneration = generation;
+				}
+				RunJob(threadIndex);
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					if (--pending == 0)
+						doneCv.notify_one();
+				}
+			}
+		}
+
+		std::vector<std::thread> threads;
+		std::mutex mutex;
+		std::condition_variable wakeCv;
+		std::condition_variable doneCv;
+		std::function<void(int, int)>* job = nullptr;
+		int jobCount = 0;
+		std::atomic<int> nextIndex{ 0 };
+		int pending = 0;
+		std::exception_ptr error;
+		unsigned long long generation = 0;
+		bool quit = false;
+	};
+
+	//Pool shared by the backend independent mesh processing. Holds it for its lifetime if no one else does,
+	//otherwise runs everything serially on the calling thread, so concurrent callers never wait for each other.
+	//Not reentrant, don't create one while another is alive on the same thread.
+	class SharedWorkerPool {
+	public:
+		SharedWorkerPool() : lock(Mutex(), std::try_to_lock) {}
+
+		SharedWorkerPool(const SharedWorkerPool&) = delete;
+		SharedWorkerPool& operator=(const SharedWorkerPool&) = delete;
+
+		//Upper bound of the threadIndex passed to ParallelFor.
+		int GetThreadCount() const {
+			return lock.owns_lock() ? Pool().GetThreadCount() : 1;
+		}
+
+		template<typename F>
+		void ParallelFor(int count, F func) {
+			if (lock.owns_lock()) {
+				Pool().ParallelFor(count, func);
+				return;
+			}
+			for (int i = 0; i < count; i++)
+				func(i, 0);
+		}
+
+	private:
+		static WorkerPool& Pool() {
+			static WorkerPool pool;
+			return pool;
+		}
+
+		static std::mutex& Mutex() {
+			static std::mutex mutex;
+			return mutex;
+		}
+
+		std::unique_lock<std::mutex> lock;
+	};
+}
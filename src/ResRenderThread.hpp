@@ -0,0 +1,130 @@
+#pragma once
+#include <ResCommandRing.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+//Render thread consuming a CommandRing. The API thread is the only producer.
+//Commands run in submit order, errors thrown by asynchronous commands are reported to std::cerr.
+
+namespace ResRenderer {
+
+	class RenderThread {
+	public:
+		RenderThread(int _framesInFlight, size_t ringBytes) : ring(ringBytes), framesInFlight(_framesInFlight) {
+		}
+
+		~RenderThread()
+		{
+			Stop();
+		}
+
+		//onStart runs on the new thread before any command, e.g. to make a context current.
+		void Start(std::function<void()> onStart) {
+			thread = std::thread([this, onStart] {
+				onStart();
+				Run();
+			});
+		}
+
+		//Executes everything submitted so far, then joins the thread.
+		void Stop() {
+			if (!thread.joinable())
+				return;
+			Enqueue([this] { quit = true; });
+			thread.join();
+		}
+
+		//Returns false when func is larger than half the ring, it's dropped and reported.
+		template<typename F>
+		bool Enqueue(F&& func) {
+			if (!ring.Push(std::forward<F>(func))) {
+				std::cerr << "Render command is larger than half the command ring, dropped." << std::endl;
+				return false;
+			}
+			if (sleeping.load())
+			{
+				std::lock_guard<std::mutex> lock(wakeMutex);
+				wakeCv.notify_one();
+			}
+			return true;
+		}
+
+		//Blocks until func has run on the render thread, returns its result and rethrows its exceptions.
+		template<typename F>
+		auto ExecuteSync(F func) -> decltype(func()) {
+			typedef decltype(func()) R;
+			std::packaged_task<R()> task(func);
+			auto result = task.get_future();
+			if (!Enqueue(std::move(task)))
+				throw std::runtime_error("Render command is larger than half the command ring");
+			return result.get();
+		}
+
+		//Called after a swap was submitted, blocks while the render thread is more than framesInFlight frames behind.
+		void EndFrame() {
+			submittedFrames++;
+			Enqueue([this] { completedFrames.fetch_add(1, std::memory_order_release); });
+			int spins = 0;
+			while (submittedFrames - completedFrames.load(std::memory_order_acquire) > static_cast<unsigned long long>(framesInFlight))
+			{
+				if (++spins > 64)
+					std::this_thread::sleep_for(std::chrono::microseconds(50));
+			}
+		}
+
+		bool IsRenderThread() const {
+			return std::this_thread::get_id() == thread.get_id();
+		}
+
+	private:
+		void Run() {
+			while (!quit)
+			{
+				bool executed = false;
+				try
+				{
+					executed = ring.Execute();
+				}
+				catch (...)
+				{
+					std::cerr << "Asynchronous render command failed." << std::endl;
+					executed = true;
+				}
+				if (!executed)
+					Idle();
+			}
+		}
+
+		//Spin a little since commands usually come in bursts, then sleep until the producer wakes us up.
+		void Idle() {
+			for (int i = 0; i < 256; i++)
+			{
+				if (!ring.Empty())
+					return;
+				std::this_thread::yield();
+			}
+			std::unique_lock<std::mutex> lock(wakeMutex);
+			sleeping.store(true);
+			//Timeout guards against a wake up racing with the flag.
+			wakeCv.wait_for(lock, std::chrono::milliseconds(1), [this] { return !ring.Empty(); });
+			sleeping.store(false);
+		}
+
+		CommandRing ring;
+		std::thread thread;
+		int framesInFlight;
+		bool quit = false;
+		unsigned long long submittedFrames = 0;
+		std::atomic<unsigned long long> completedFrames{ 0 };
+		std::atomic<bool> sleeping{ false };
+		std::mutex wakeMutex;
+		std::condition_variable wakeCv;
+	};
+}
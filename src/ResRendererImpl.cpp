@@ -1,5 +1,8 @@
 #include <ResRenderer.hpp>
+#include <ResMeshValidation.hpp>
 #include <algorithm>
+#include <atomic>
+#include <vector>
 
 namespace ResRenderer {
 
@@ -9,17 +12,30 @@ namespace ResRenderer {
 		case ResRenderer::VertexAttribType::ResFloat:
 			return 4;
 			break;
+		case ResRenderer::VertexAttribType::ResHalfFloat:
+		case ResRenderer::VertexAttribType::ResShort:
+			return 2;
+			break;
+		case ResRenderer::VertexAttribType::ResUnsignedByte:
+		case ResRenderer::VertexAttribType::ResByte:
+		case ResRenderer::VertexAttribType::ResInt10_10_10_2:
+			return 1;
+			break;
 		default:
 			return 0;
 			break;
 		}
 	}
 
-	ErrorCode RES_RENDERER_API MeshDataAppendAttrib(MeshData* data, VertexAttribType type, int count, bool normalize){
-		if (data->attribCount >= MESH_DATA_MAX_ATTRIB_COUNT) {
+	//MeshData and InstanceData share attribute layout.
+	static ErrorCode AppendAttrib(VertexAttribDescription* descriptions, int* attribCount, VertexAttribType type, int count, bool normalize) {
+		if (*attribCount >= MESH_DATA_MAX_ATTRIB_COUNT) {
 			return ErrorCode::MESH_DATA_ATTRIB_OVERFLOW;
 		}
-		if (data->attribCount < 0) {
+		if (*attribCount < 0 || count < 1 || count > 4 || GetVertexAttribSize(type) == 0) {
+			return ErrorCode::MESH_DATA_BROKEN;
+		}
+		if (type == VertexAttribType::ResInt10_10_10_2 && count != 4) {
 			return ErrorCode::MESH_DATA_BROKEN;
 		}
 
@@ -27,22 +43,44 @@ namespace ResRenderer {
 		vad.type = type;
 		vad.normalize = normalize;
 		vad.count = count;
-		data->attribDescriptions[data->attribCount++] = vad;
+		descriptions[(*attribCount)++] = vad;
 
 		return ErrorCode::RES_NO_ERROR;
 	}
 
-	size_t RES_RENDERER_API GetMeshVertexSize(const MeshData* data) {
-		size_t vertSize = 0;
-		for (size_t i = 0; i < data->attribCount; i++)
+	static size_t GetAttribsSize(const VertexAttribDescription* descriptions, int attribCount) {
+		size_t size = 0;
+		for (int i = 0; i < attribCount; i++)
 		{
-			auto desc = data->attribDescriptions[i];
-			vertSize += desc.count * GetVertexAttribSize(desc.type);
+			auto desc = descriptions[i];
+			size += desc.count * GetVertexAttribSize(desc.type);
 		}
-		return vertSize;
+		return size;
+	}
+
+	ErrorCode RES_RENDERER_API MeshDataAppendAttrib(MeshData* data, VertexAttribType type, int count, bool normalize){
+		return AppendAttrib(data->attribDescriptions, &data->attribCount, type, count, normalize);
+	}
+
+	size_t RES_RENDERER_API GetMeshVertexSize(const MeshData* data) {
+		return GetAttribsSize(data->attribDescriptions, data->attribCount);
+	}
+
+	static std::atomic<int> meshDataValidation{ static_cast<int>(MeshDataValidation::Layout) };
+
+	void RES_RENDERER_API SetMeshDataValidation(MeshDataValidation level) {
+		meshDataValidation.store(static_cast<int>(level));
+	}
+
+	MeshDataValidation RES_RENDERER_API GetMeshDataValidation() {
+		return static_cast<MeshDataValidation>(meshDataValidation.load());
 	}
 
 	ErrorCode RES_RENDERER_API MeshDataVerify(const MeshData* data) {
+		return MeshDataVerify(data, GetMeshDataValidation());
+	}
+
+	ErrorCode RES_RENDERER_API MeshDataVerify(const MeshData* data, MeshDataValidation level) {
 		if (data->attribCount >= MESH_DATA_MAX_ATTRIB_COUNT || data->vertCount <= 0 || data->data == nullptr || data->indicies == nullptr || data->dataSize <= 0 || data->indiciesCount <= 0) {
 			return ErrorCode::MESH_DATA_BROKEN;
 		}
@@ -55,6 +93,69 @@ namespace ResRenderer {
 			return ErrorCode::MESH_DATA_LENGTH_ERROR;
 		}
 
+		if (level == MeshDataValidation::Full) {
+			return VerifyMeshDataContents(data);
+		}
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	bool RES_RENDERER_API MeshDataSameLayout(const MeshData* a, const MeshData* b) {
+		if (a->attribCount != b->attribCount) {
+			return false;
+		}
+		for (int i = 0; i < a->attribCount; i++)
+		{
+			auto& da = a->attribDescriptions[i];
+			auto& db = b->attribDescriptions[i];
+			if (da.type != db.type || da.count != db.count || da.normalize != db.normalize) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	ErrorCode RES_RENDERER_API InstanceDataAppendAttrib(InstanceData* data, VertexAttribType type, int count, bool normalize) {
+		return AppendAttrib(data->attribDescriptions, &data->attribCount, type, count, normalize);
+	}
+
+	size_t RES_RENDERER_API GetInstanceSize(const InstanceData* data) {
+		return GetAttribsSize(data->attribDescriptions, data->attribCount);
+	}
+
+	ErrorCode RES_RENDERER_API InstanceDataVerify(const InstanceData* data) {
+		if (data->attribCount <= 0 || data->attribCount > MESH_DATA_MAX_ATTRIB_COUNT || data->instanceCount <= 0 || data->data == nullptr) {
+			return ErrorCode::MESH_DATA_BROKEN;
+		}
+		if (GetInstanceSize(data) * data->instanceCount != data->dataSize) {
+			return ErrorCode::MESH_DATA_LENGTH_ERROR;
+		}
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API MeshDataAnalyzeVertexCache(const MeshData* data, int cacheSize, VertexCacheStats* outStats) {
+		if (data->vertCount <= 0 || data->indicies == nullptr || data->indiciesCount < 3 || cacheSize <= 0) {
+			return ErrorCode::MESH_DATA_BROKEN;
+		}
+
+		//insertedAt holds the miss count right after a vertex got into the cache(0: never),
+		//it's still cached if less than cacheSize misses happened since.
+		std::vector<size_t> insertedAt(data->vertCount, 0);
+		size_t misses = 0;
+		for (size_t i = 0; i < data->indiciesCount; i++)
+		{
+			auto index = data->indicies[i];
+			if (index >= static_cast<VertexIndex_t>(data->vertCount)) {
+				return ErrorCode::MESH_DATA_BROKEN;
+			}
+			auto& inserted = insertedAt[index];
+			if (inserted == 0 || misses - inserted >= static_cast<size_t>(cacheSize)) {
+				inserted = ++misses;
+			}
+		}
+
+		outStats->acmr = static_cast<float>(misses) / (data->indiciesCount / 3);
+		outStats->atvr = static_cast<float>(misses) / data->vertCount;
+		outStats->hitRate = 1.0f - static_cast<float>(misses) / data->indiciesCount;
 		return ErrorCode::RES_NO_ERROR;
 	}
 }
\ No newline at end of file
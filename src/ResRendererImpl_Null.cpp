@@ -0,0 +1,594 @@
+#include <ResRenderer.hpp>
+#include <ResRendererNull.hpp>
+#include <ResCommandList.hpp>
+#include <ResMeshLOD.hpp>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ResRenderer {
+
+	static NullBackendStats stats;
+	static std::chrono::steady_clock::time_point startTime;
+
+	static ErrorCode Result(ErrorCode code) {
+		if (code != ErrorCode::RES_NO_ERROR)
+			stats.failedCalls++;
+		return code;
+	}
+
+	class MeshImpl
+	{
+	public:
+		void UploadMeshData(const MeshData* data) {
+			vertCount = data->vertCount;
+			indiciesCount = data->indiciesCount;
+			lods.assign(1, MeshLOD{ 0, static_cast<unsigned int>(indiciesCount), 0.0f });
+			meshInitialized = true;
+		}
+
+		bool meshInitialized = false;
+		int vertCount = 0;
+		size_t indiciesCount = 0;
+		//Level 0 is the whole index buffer.
+		std::vector<MeshLOD> lods;
+	};
+
+	struct InstanceBufferImpl {
+		int instanceCount = 0;
+	};
+
+	struct MeshBatchImpl {
+		MeshData layout;
+		std::vector<size_t> indiciesCounts;
+	};
+
+	struct UniformBufferImpl {
+		size_t size;
+	};
+
+	class ShaderImpl {
+	public:
+		//Every name is an active uniform, names are only kept as ids.
+		int GetUniformLocation(UniformId id) {
+			if (!compiled)
+				return -1;
+			auto ite = locations.find(id);
+			if (ite != locations.end())
+				return ite->second;
+			auto location = static_cast<int>(locations.size());
+			locations.insert(std::pair<UniformId, int>(id, location));
+			return location;
+		}
+
+		//Setting by id doesn't register names, only ids looked up before are uniforms of the shader.
+		bool HasUniform(UniformId id) const {
+			return compiled && locations.find(id) != locations.end();
+		}
+
+		bool compiled = false;
+		ShaderCompileStatus asyncStatus = ShaderCompileStatus::None;
+		std::map<UniformId, int> locations;
+	};
+
+	class WindowImpl {
+	public:
+		WindowImpl(int _width, int _height) : width(_width), height(_height) {
+		}
+
+		int width, height;
+		WindowResizeCallback callback = nullptr;
+		bool isClosing = false;
+		int frameLimit = 0;
+		int frameCount = 0;
+	};
+
+	struct FrameBufferImpl {
+		FrameBufferDescriptor descriptor;
+	};
+
+	struct TextureImpl {
+		TextureDescriptor descriptor;
+	};
+
+	bool RES_RENDERER_API Init() {
+		stats.apiCalls++;
+		startTime = std::chrono::steady_clock::now();
+		return true;
+	}
+
+	float RES_RENDERER_API GetTime() {
+		stats.apiCalls++;
+		std::chrono::duration<float> t = std::chrono::steady_clock::now() - startTime;
+		return t.count();
+	}
+
+	void RES_RENDERER_API Terminate() {
+		stats.apiCalls++;
+	}
+
+	void RES_RENDERER_API GetNullBackendStats(NullBackendStats* outStats) {
+		*outStats = stats;
+	}
+
+	void RES_RENDERER_API ResetNullBackendStats() {
+		stats = NullBackendStats();
+	}
+
+	//Mesh
+	ErrorCode RES_RENDERER_API CreateMesh(Mesh* outMesh) {
+		stats.apiCalls++;
+		if (outMesh == nullptr)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		*outMesh = static_cast<Mesh>(new MeshImpl());
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	//Nothing to stream, same as a static mesh.
+	ErrorCode RES_RENDERER_API CreateDynamicMesh(Mesh* outMesh) {
+		return CreateMesh(outMesh);
+	}
+
+	ErrorCode RES_RENDERER_API UploadMeshData(Mesh mesh, const MeshData* data) {
+		stats.apiCalls++;
+		if (mesh == nullptr || data == nullptr)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		auto t = MeshDataVerify(data);
+		if (t != ErrorCode::RES_NO_ERROR)
+			return Result(t);
+
+		static_cast<MeshImpl*>(mesh)->UploadMeshData(data);
+		stats.meshUploads++;
+		stats.uploadedBytes += data->dataSize + data->indiciesCount * sizeof(VertexIndex_t);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API UploadMeshDataWithLODs(Mesh mesh, const MeshData* data, const MeshLODSettings* settings) {
+		stats.apiCalls++;
+		if (mesh == nullptr || data == nullptr)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		MeshLODSettings defaults;
+		std::vector<VertexIndex_t> indicies;
+		std::vector<MeshLOD> lods;
+		auto t = GenerateMeshLODs(data, settings != nullptr ? *settings : defaults, &indicies, &lods);
+		if (t != ErrorCode::RES_NO_ERROR)
+			return Result(t);
+
+		auto pMesh = static_cast<MeshImpl*>(mesh);
+		//Other draws keep to level 0, data's own indicies.
+		pMesh->UploadMeshData(data);
+		pMesh->lods = lods;
+		stats.meshUploads++;
+		stats.uploadedBytes += data->dataSize + indicies.size() * sizeof(VertexIndex_t);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API CreateInstanceBuffer(InstanceBuffer* outBuffer) {
+		stats.apiCalls++;
+		if (outBuffer == nullptr)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		*outBuffer = static_cast<InstanceBuffer>(new InstanceBufferImpl());
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API UploadInstanceData(InstanceBuffer buffer, const InstanceData* data) {
+		stats.apiCalls++;
+		if (buffer == nullptr || data == nullptr)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		auto t = InstanceDataVerify(data);
+		if (t != ErrorCode::RES_NO_ERROR)
+			return Result(t);
+
+		static_cast<InstanceBufferImpl*>(buffer)->instanceCount = data->instanceCount;
+		stats.instanceUploads++;
+		stats.uploadedBytes += data->dataSize;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API DestroyInstanceBuffer(InstanceBuffer buffer) {
+		stats.apiCalls++;
+		delete static_cast<InstanceBufferImpl*>(buffer);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API CreateMeshBatch(MeshBatch* outBatch) {
+		stats.apiCalls++;
+		if (outBatch == nullptr)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		*outBatch = static_cast<MeshBatch>(new MeshBatchImpl());
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API MeshBatchAddMesh(MeshBatch batch, const MeshData* data, int* outSubMesh) {
+		stats.apiCalls++;
+		if (batch == nullptr || data == nullptr || outSubMesh == nullptr)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		auto t = MeshDataVerify(data);
+		if (t != ErrorCode::RES_NO_ERROR)
+			return Result(t);
+		auto pBatch = static_cast<MeshBatchImpl*>(batch);
+		if (pBatch->indiciesCounts.empty())
+			pBatch->layout = *data;
+		else if (!MeshDataSameLayout(&pBatch->layout, data))
+			return Result(ErrorCode::MESH_DATA_BROKEN);
+
+		*outSubMesh = static_cast<int>(pBatch->indiciesCounts.size());
+		pBatch->indiciesCounts.push_back(data->indiciesCount);
+		stats.meshUploads++;
+		stats.uploadedBytes += data->dataSize + data->indiciesCount * sizeof(VertexIndex_t);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API DestroyMeshBatch(MeshBatch batch) {
+		stats.apiCalls++;
+		delete static_cast<MeshBatchImpl*>(batch);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API DestroyMesh(Mesh mesh) {
+		stats.apiCalls++;
+		delete static_cast<MeshImpl*>(mesh);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	//Texture
+	Texture RES_RENDERER_API CreateTexture(const TextureDescriptor& descriptor) {
+		stats.apiCalls++;
+		if (descriptor.width <= 0 || descriptor.height <= 0) {
+			stats.failedCalls++;
+			return nullptr;
+		}
+		auto t = new TextureImpl();
+		t->descriptor = descriptor;
+		return static_cast<Texture>(t);
+	}
+
+	void RES_RENDERER_API DestroyTexture(Texture texture) {
+		stats.apiCalls++;
+		delete static_cast<TextureImpl*>(texture);
+	}
+
+	//Shader
+	ErrorCode RES_RENDERER_API CreateShader(Shader* outShader) {
+		stats.apiCalls++;
+		if (outShader == nullptr)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		*outShader = static_cast<Shader>(new ShaderImpl());
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API CompileShader(Shader shader, const char* source, char* compileErrorLog, size_t compileErrorMaxLength, size_t* compileErrorLength) {
+		stats.apiCalls++;
+		if (shader == nullptr || source == nullptr)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		if (compileErrorLog != nullptr && compileErrorMaxLength > 0)
+			compileErrorLog[0] = '\0';
+		if (compileErrorLength != nullptr)
+			*compileErrorLength = 0;
+		static_cast<ShaderImpl*>(shader)->compiled = true;
+		stats.shaderCompiles++;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	//Compiles never take time here, they're done before returning.
+	ErrorCode RES_RENDERER_API CompileShaderAsync(Shader shader, const char* source) {
+		auto t = CompileShader(shader, source, nullptr, 0, nullptr);
+		if (shader != nullptr)
+			static_cast<ShaderImpl*>(shader)->asyncStatus = t == ErrorCode::RES_NO_ERROR ? ShaderCompileStatus::Succeeded : ShaderCompileStatus::Failed;
+		return shader != nullptr ? ErrorCode::RES_NO_ERROR : t;
+	}
+
+	ErrorCode RES_RENDERER_API PollShaderCompile(Shader shader, ShaderCompileStatus* outStatus, char* compileErrorLog, size_t compileErrorMaxLength, size_t* compileErrorLength) {
+		stats.apiCalls++;
+		if (shader == nullptr || outStatus == nullptr)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		*outStatus = static_cast<ShaderImpl*>(shader)->asyncStatus;
+		if (compileErrorLog != nullptr && compileErrorMaxLength > 0)
+			compileErrorLog[0] = '\0';
+		if (compileErrorLength != nullptr)
+			*compileErrorLength = 0;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API GetUniformLocation(Shader shader, const char* name, int* outLocation) {
+		stats.apiCalls++;
+		if (shader == nullptr || name == nullptr || outLocation == nullptr)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		*outLocation = static_cast<ShaderImpl*>(shader)->GetUniformLocation(MakeUniformId(name));
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API GetUniformLocationById(Shader shader, UniformId id, int* outLocation) {
+		stats.apiCalls++;
+		if (shader == nullptr || outLocation == nullptr)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		*outLocation = static_cast<ShaderImpl*>(shader)->GetUniformLocation(id);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API SetUniformVecById(Shader shader, UniformId id, Vector4) {
+		stats.apiCalls++;
+		if (shader == nullptr)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		//Unknown ids are ignored, so they aren't counted either.
+		if (!static_cast<ShaderImpl*>(shader)->HasUniform(id))
+			return ErrorCode::RES_NO_ERROR;
+		stats.uniformSets++;
+		stats.uniformBytes += sizeof(Vector4);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API SetUniformVec(Shader shader, int, Vector4) {
+		stats.apiCalls++;
+		if (shader == nullptr)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		//Like glUniform, unknown locations are silently ignored.
+		stats.uniformSets++;
+		stats.uniformBytes += sizeof(Vector4);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API UseShader(Shader shader) {
+		stats.apiCalls++;
+		if (shader == nullptr)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		stats.shaderUses++;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API DestroyShader(Shader shader) {
+		stats.apiCalls++;
+		delete static_cast<ShaderImpl*>(shader);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API SetUniformBlockSlot(Shader shader, const char* blockName, int slot) {
+		stats.apiCalls++;
+		if (shader == nullptr || blockName == nullptr || slot < 0 || slot >= UNIFORM_BUFFER_MAX_SLOT_COUNT)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		//No source to look the block up in, only a linked program could have one.
+		if (!static_cast<ShaderImpl*>(shader)->compiled)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	//Uniform buffer
+	ErrorCode RES_RENDERER_API CreateUniformBuffer(size_t size, UniformBuffer* outBuffer) {
+		stats.apiCalls++;
+		if (outBuffer == nullptr)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		if (size == 0)
+			return Result(ErrorCode::BUFFER_TOO_SMALL);
+		*outBuffer = static_cast<UniformBuffer>(new UniformBufferImpl{ size });
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API UpdateUniformBuffer(UniformBuffer buffer, const void* data, size_t size, size_t offset) {
+		stats.apiCalls++;
+		if (buffer == nullptr || data == nullptr)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		auto bufferSize = static_cast<UniformBufferImpl*>(buffer)->size;
+		if (offset > bufferSize || size > bufferSize - offset)
+			return Result(ErrorCode::BUFFER_TOO_SMALL);
+		stats.uniformBufferUpdates++;
+		stats.uniformBytes += size;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API BindUniformBuffer(UniformBuffer buffer, int slot) {
+		stats.apiCalls++;
+		if (buffer == nullptr || slot < 0 || slot >= UNIFORM_BUFFER_MAX_SLOT_COUNT)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		stats.uniformBufferBinds++;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API DestroyUniformBuffer(UniformBuffer buffer) {
+		stats.apiCalls++;
+		delete static_cast<UniformBufferImpl*>(buffer);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	//FrameBuffer
+	FrameBuffer RES_RENDERER_API CreateFrameBuffer(FrameBufferDescriptor& descriptor) {
+		stats.apiCalls++;
+		if (descriptor.width <= 0 || descriptor.height <= 0) {
+			stats.failedCalls++;
+			return nullptr;
+		}
+		auto t = new FrameBufferImpl();
+		t->descriptor = descriptor;
+		return static_cast<FrameBuffer>(t);
+	}
+
+	void RES_RENDERER_API DestroyFrameBuffer(FrameBuffer frameBuffer) {
+		stats.apiCalls++;
+		delete static_cast<FrameBufferImpl*>(frameBuffer);
+	}
+
+	//Control
+	void RES_RENDERER_API SetViewPort(int, int, int, int) {
+		stats.apiCalls++;
+	}
+
+	void RES_RENDERER_API SetRenderWindow(Window) {
+		stats.apiCalls++;
+	}
+
+	void RES_RENDERER_API SetRenderTarget(FrameBuffer) {
+		stats.apiCalls++;
+	}
+
+	ErrorCode RES_RENDERER_API DrawMesh(Mesh mesh) {
+		stats.apiCalls++;
+		auto pMesh = static_cast<MeshImpl*>(mesh);
+		if (pMesh == nullptr || !pMesh->meshInitialized)
+			return Result(ErrorCode::MESH_NOT_CREATED);
+		stats.drawCalls++;
+		stats.drawnIndices += pMesh->indiciesCount;
+		stats.drawnInstances++;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API DrawMeshInstanced(Mesh mesh, InstanceBuffer instances, int instanceCount) {
+		stats.apiCalls++;
+		auto pMesh = static_cast<MeshImpl*>(mesh);
+		auto pInstances = static_cast<InstanceBufferImpl*>(instances);
+		if (pMesh == nullptr || !pMesh->meshInitialized)
+			return Result(ErrorCode::MESH_NOT_CREATED);
+		if (pInstances == nullptr || instanceCount < 0)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		if (instanceCount > pInstances->instanceCount)
+			return Result(ErrorCode::BUFFER_TOO_SMALL);
+		stats.drawCalls++;
+		stats.drawnIndices += pMesh->indiciesCount * instanceCount;
+		stats.drawnInstances += instanceCount;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API DrawMeshBatch(MeshBatch batch, const int* subMeshes, int count, InstanceBuffer instances) {
+		stats.apiCalls++;
+		auto pBatch = static_cast<MeshBatchImpl*>(batch);
+		auto pInstances = static_cast<InstanceBufferImpl*>(instances);
+		if (pBatch == nullptr || count < 0 || (count > 0 && subMeshes == nullptr))
+			return Result(ErrorCode::INTERNAL_ERROR);
+		if (pInstances != nullptr && count > pInstances->instanceCount)
+			return Result(ErrorCode::BUFFER_TOO_SMALL);
+		unsigned long long indicies = 0;
+		for (int i = 0; i < count; i++)
+		{
+			if (subMeshes[i] < 0 || subMeshes[i] >= static_cast<int>(pBatch->indiciesCounts.size()))
+				return Result(ErrorCode::MESH_NOT_CREATED);
+			indicies += pBatch->indiciesCounts[subMeshes[i]];
+		}
+		stats.drawCalls++;
+		stats.drawnIndices += indicies;
+		stats.drawnInstances += count;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API DrawMeshLOD(Mesh mesh, float projectedSize, float maxPixelError) {
+		stats.apiCalls++;
+		auto pMesh = static_cast<MeshImpl*>(mesh);
+		if (pMesh == nullptr || !pMesh->meshInitialized)
+			return Result(ErrorCode::MESH_NOT_CREATED);
+		stats.drawCalls++;
+		stats.drawnIndices += SelectMeshLOD(pMesh->lods, projectedSize, maxPixelError).indexCount;
+		stats.drawnInstances++;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API DrawMeshRanges(Mesh mesh, const IndexRange* ranges, int count) {
+		stats.apiCalls++;
+		auto pMesh = static_cast<MeshImpl*>(mesh);
+		if (pMesh == nullptr || !pMesh->meshInitialized)
+			return Result(ErrorCode::MESH_NOT_CREATED);
+		if (count < 0 || (count > 0 && ranges == nullptr))
+			return Result(ErrorCode::INTERNAL_ERROR);
+		unsigned long long indicies = 0;
+		for (int i = 0; i < count; i++)
+		{
+			if (ranges[i].firstIndex > pMesh->indiciesCount || ranges[i].indexCount > pMesh->indiciesCount - ranges[i].firstIndex)
+				return Result(ErrorCode::MESH_DATA_LENGTH_ERROR);
+			indicies += ranges[i].indexCount;
+		}
+		if (count == 0)
+			return ErrorCode::RES_NO_ERROR;
+		stats.drawCalls++;
+		stats.drawnIndices += indicies;
+		stats.drawnInstances++;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	void RES_RENDERER_API Clear(Color, ClearType) {
+		stats.apiCalls++;
+		stats.clears++;
+	}
+
+	//Window
+	ErrorCode RES_RENDERER_API CreateResWindow(int width, int height, const char*, Window* outWindow) {
+		stats.apiCalls++;
+		if (width <= 0 || height <= 0 || outWindow == nullptr)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		*outWindow = static_cast<Window>(new WindowImpl(width, height));
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	void RES_RENDERER_API RegisterWindowResizeCallback(Window window, WindowResizeCallback callback) {
+		stats.apiCalls++;
+		static_cast<WindowImpl*>(window)->callback = callback;
+	}
+
+	bool RES_RENDERER_API ShouldCloseWindow(Window window) {
+		stats.apiCalls++;
+		auto pWindow = static_cast<WindowImpl*>(window);
+		if (pWindow->frameLimit > 0 && pWindow->frameCount >= pWindow->frameLimit)
+			return true;
+		return pWindow->isClosing;
+	}
+
+	void RES_RENDERER_API SwapBuffer(Window window) {
+		stats.apiCalls++;
+		stats.swaps++;
+		static_cast<WindowImpl*>(window)->frameCount++;
+	}
+
+	void RES_RENDERER_API PollEvents() {
+		stats.apiCalls++;
+	}
+
+	void RES_RENDERER_API SetWindowFrameLimit(Window window, int frameCount) {
+		stats.apiCalls++;
+		static_cast<WindowImpl*>(window)->frameLimit = frameCount;
+	}
+
+	ErrorCode RES_RENDERER_API ReadWindowPixels(Window window, void* outPixels, size_t bufferSize) {
+		stats.apiCalls++;
+		auto pWindow = static_cast<WindowImpl*>(window);
+		auto size = static_cast<size_t>(pWindow->width) * pWindow->height * 4;
+		if (outPixels == nullptr || bufferSize < size)
+			return Result(ErrorCode::BUFFER_TOO_SMALL);
+		//Nothing is ever rendered.
+		memset(outPixels, 0, size);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API EnableRenderThread(int framesInFlight) {
+		stats.apiCalls++;
+		//Nothing to execute, so nothing to move to another thread.
+		if (framesInFlight < 0)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API SubmitCommandLists(const CommandList* lists, int count) {
+		stats.apiCalls++;
+		if (count > 0 && lists == nullptr)
+			return Result(ErrorCode::INTERNAL_ERROR);
+		auto result = ErrorCode::RES_NO_ERROR;
+		for (int i = 0; i < count; i++)
+		{
+			//Replayed through the immediate functions, so they're validated and counted the same way.
+			static_cast<const CommandListImpl*>(lists[i])->ForEach([&result](const RecordedCommand& command) {
+				auto t = ErrorCode::RES_NO_ERROR;
+				switch (command.type)
+				{
+				case RecordedCommandType::UseShader:
+					t = UseShader(command.object);
+					break;
+				case RecordedCommandType::SetUniformVec:
+					t = SetUniformVec(command.object, command.location, Color(command.v[0], command.v[1], command.v[2], command.v[3]));
+					break;
+				case RecordedCommandType::DrawMesh:
+					t = DrawMesh(command.object);
+					break;
+				}
+				if (result == ErrorCode::RES_NO_ERROR)
+					result = t;
+			});
+		}
+		return result;
+	}
+}
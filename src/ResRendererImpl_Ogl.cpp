@@ -1,6 +1,18 @@
 #include <ResRenderer.hpp>
 #include <ResRendererImpl_Ogl.hpp>
-#include <GL\glew.h>
+#include <ResCommandList.hpp>
+#include <ResFileWatcher.hpp>
+#include <ResMeshLOD.hpp>
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
 namespace ResRenderer {
 
 	static GLenum GetGLAttribType(VertexAttribType otype) {
@@ -9,16 +21,255 @@ namespace ResRenderer {
 		case ResRenderer::VertexAttribType::ResFloat:
 			return GL_FLOAT;
 			break;
+		case ResRenderer::VertexAttribType::ResHalfFloat:
+			return GL_HALF_FLOAT;
+			break;
+		case ResRenderer::VertexAttribType::ResShort:
+			return GL_SHORT;
+			break;
+		case ResRenderer::VertexAttribType::ResUnsignedByte:
+			return GL_UNSIGNED_BYTE;
+			break;
+		case ResRenderer::VertexAttribType::ResByte:
+			return GL_BYTE;
+			break;
+		case ResRenderer::VertexAttribType::ResInt10_10_10_2:
+			return GL_INT_2_10_10_10_REV;
+			break;
 		default:
 			return GL_FLOAT;
 			break;
 		}
 	}
 
+	//Points locations [firstLocation, firstLocation + attribCount) into the bound array buffer. VAO must be bound.
+	static void SetupVertexAttribs(const VertexAttribDescription* descriptions, int attribCount, GLsizei stride, GLuint firstLocation, GLuint divisor, size_t baseOffset) {
+		char* startOffset = nullptr;
+		startOffset += baseOffset;
+		for (int i = 0; i < attribCount; i++)
+		{
+			auto desc = descriptions[i];
+			auto location = firstLocation + static_cast<GLuint>(i);
+			CHECKED(glEnableVertexAttribArray(location));
+			CHECKED(glVertexAttribDivisor(location, divisor));
+			CHECKED(glVertexAttribPointer(location, desc.count, GetGLAttribType(desc.type), desc.normalize, stride, startOffset));
+			startOffset += desc.count * GetVertexAttribSize(desc.type);
+		}
+	}
+
+	//Uploads to the bound element buffer, narrowed to 16 bits when every index fits, which halves index bandwidth.
+	//Returns the index type.
+	static bool IndicesFit16Bits(const VertexIndex_t* indicies, size_t count) {
+		return std::all_of(indicies, indicies + count, [](VertexIndex_t i) { return i <= 0xFFFF; });
+	}
+
+	static GLenum UploadIndexBuffer(const VertexIndex_t* indicies, size_t count, GLenum usage = GL_STATIC_DRAW) {
+		if (IndicesFit16Bits(indicies, count)) {
+			std::vector<GLushort> narrowed(indicies, indicies + count);
+			CHECKED(glBufferData(GL_ELEMENT_ARRAY_BUFFER, narrowed.size() * sizeof(GLushort), narrowed.data(), usage));
+			return GL_UNSIGNED_SHORT;
+		}
+		CHECKED(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(VertexIndex_t), indicies, usage));
+		return GL_UNSIGNED_INT;
+	}
+
+	static GLsizei GetIndexSize(GLenum indexType) {
+		return indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+	}
+
+	//Vertex attribute locations guaranteed by every GL 3.3 implementation.
+	static const GLuint MaxVertexAttribs = 16;
+	//Identifies an uploaded instance layout, so meshes know when to rebuild their instance attributes.
+	static unsigned long long instanceLayoutSerial = 0;
+
+	class InstanceBufferImpl
+	{
+	public:
+		InstanceBufferImpl() {
+			VBO = 0;
+			CHECKED(glGenBuffers(1, &VBO));
+		}
+
+		~InstanceBufferImpl() {
+			GetGLState().OnDeleteBuffer(VBO);
+			glDeleteBuffers(1, &VBO);
+		}
+
+		void UploadInstanceData(const InstanceData* data) {
+			layoutSerial = 0;
+			GetGLState().BindArrayBuffer(VBO);
+			CHECKED(glBufferData(GL_ARRAY_BUFFER, data->dataSize, data->data, GL_DYNAMIC_DRAW));
+			attribCount = data->attribCount;
+			for (int i = 0; i < attribCount; i++)
+				attribDescriptions[i] = data->attribDescriptions[i];
+			stride = static_cast<GLsizei>(GetInstanceSize(data));
+			layoutSerial = ++instanceLayoutSerial;
+		}
+
+		//Instance attributes take locations right after vertex attributes. firstInstance is for drawing without base instance.
+		ErrorCode SetupAttribs(GLuint firstLocation, size_t firstInstance) {
+			if (firstLocation + static_cast<GLuint>(attribCount) > MaxVertexAttribs)
+				return ErrorCode::MESH_DATA_ATTRIB_OVERFLOW;
+			GetGLState().BindArrayBuffer(VBO);
+			SetupVertexAttribs(attribDescriptions, attribCount, stride, firstLocation, 1, firstInstance * stride);
+			return ErrorCode::RES_NO_ERROR;
+		}
+
+		//Set on API thread, so draws could be validated without waiting for render thread.
+		int instanceCount = 0;
+		//Render thread only.
+		GLuint VBO;
+		VertexAttribDescription attribDescriptions[MESH_DATA_MAX_ATTRIB_COUNT];
+		int attribCount = 0;
+		GLsizei stride = 0;
+		unsigned long long layoutSerial = 0;
+	};
+
+	//Persistently mapped buffer for dynamic meshes, split into one slice per frame in flight.
+	//Uploads are plain copies into mapped memory. Before a slice is written again, the fence of the frame
+	//that used it last is waited on. Needs GL 4.4 or ARB_buffer_storage.
+	class StreamingBuffer {
+	public:
+		static const size_t SliceBytes = 16 << 20;
+		static const int Slices = 3;
+
+		StreamingBuffer() {
+			buffer = 0;
+			CHECKED(glGenBuffers(1, &buffer));
+			auto& state = GetGLState();
+			state.BindArrayBuffer(buffer);
+			GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			CHECKED(glBufferStorage(GL_ARRAY_BUFFER, SliceBytes * Slices, nullptr, flags));
+			mapped = static_cast<unsigned char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, SliceBytes * Slices, flags));
+			if (mapped == nullptr) {
+				state.OnDeleteBuffer(buffer);
+				glDeleteBuffers(1, &buffer);
+				throw static_cast<GLenum>(GL_OUT_OF_MEMORY);
+			}
+		}
+
+		~StreamingBuffer() {
+			for (auto fence : fences)
+			{
+				if (fence != nullptr)
+					glDeleteSync(fence);
+			}
+			auto& state = GetGLState();
+			state.BindArrayBuffer(buffer);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+			state.OnDeleteBuffer(buffer);
+			glDeleteBuffers(1, &buffer);
+		}
+
+		//Byte offset into buffer, or -1 if what's left of this frame's slice is too small.
+		GLintptr Allocate(size_t bytes) {
+			//Vertex attributes and indices only need 4 byte alignment, 16 keeps SIMD copies aligned.
+			size_t offset = (sliceUsed + 15) & ~static_cast<size_t>(15);
+			if (offset + bytes > SliceBytes)
+				return -1;
+			if (!sliceReady)
+				WaitSlice();
+			sliceUsed = offset + bytes;
+			stats.streamedBytes += bytes;
+			return static_cast<GLintptr>(slice * SliceBytes + offset);
+		}
+
+		unsigned char* Pointer(GLintptr offset) {
+			return mapped + offset;
+		}
+
+		void EndFrame() {
+			if (sliceUsed == 0)
+				return;
+			fences[slice] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			slice = (slice + 1) % Slices;
+			sliceUsed = 0;
+			sliceReady = false;
+		}
+
+		GLuint buffer;
+		GLStreamingStats stats;
+
+	private:
+		void WaitSlice() {
+			auto fence = fences[slice];
+			if (fence != nullptr) {
+				auto status = glClientWaitSync(fence, 0, 0);
+				if (status == GL_TIMEOUT_EXPIRED) {
+					stats.fenceWaits++;
+					while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {}
+				}
+				glDeleteSync(fence);
+				fences[slice] = nullptr;
+			}
+			sliceReady = true;
+		}
+
+		unsigned char* mapped = nullptr;
+		GLsync fences[Slices] = {};
+		int slice = 0;
+		size_t sliceUsed = 0;
+		bool sliceReady = false;
+	};
+
+	static StreamingBuffer* streamingBuffer = nullptr;
+	static bool streamingUnsupported = false;
+	//Survives ReleaseStreamingBuffer, so fallbacks are counted too.
+	static GLStreamingStats streamingStats;
+
+	static StreamingBuffer* GetStreamingBuffer() {
+		if (streamingBuffer != nullptr || streamingUnsupported)
+			return streamingBuffer;
+		if (!GLEW_VERSION_4_4 && !GLEW_ARB_buffer_storage) {
+			streamingUnsupported = true;
+			return nullptr;
+		}
+		try
+		{
+			streamingBuffer = new StreamingBuffer();
+		}
+		catch (GLenum)
+		{
+			std::cerr << "Persistently mapped streaming buffer unavailable, dynamic meshes use glBufferData." << std::endl;
+			streamingUnsupported = true;
+		}
+		return streamingBuffer;
+	}
+
+	void EndStreamingFrame() {
+		if (streamingBuffer != nullptr)
+			streamingBuffer->EndFrame();
+	}
+
+	void ReleaseStreamingBuffer() {
+		if (streamingBuffer != nullptr) {
+			streamingStats.streamedBytes += streamingBuffer->stats.streamedBytes;
+			streamingStats.fenceWaits += streamingBuffer->stats.fenceWaits;
+			delete streamingBuffer;
+			streamingBuffer = nullptr;
+		}
+		streamingUnsupported = false;
+	}
+
+	GLStreamingStats GetStreamingStats() {
+		auto t = streamingStats;
+		if (streamingBuffer != nullptr) {
+			t.streamedBytes += streamingBuffer->stats.streamedBytes;
+			t.fenceWaits += streamingBuffer->stats.fenceWaits;
+		}
+		return t;
+	}
+
+	void ResetStreamingStats() {
+		streamingStats = GLStreamingStats();
+		if (streamingBuffer != nullptr)
+			streamingBuffer->stats = GLStreamingStats();
+	}
+
 	class MeshImpl
 	{
 	public:
-		MeshImpl() {
+		explicit MeshImpl(bool _dynamic = false) : dynamic(_dynamic) {
 			VBO = 0;	
 			EBO = 0;
 			VAO = 0;
@@ -28,6 +279,10 @@ namespace ResRenderer {
 		}
 		
 		~MeshImpl() {	
+			auto& state = GetGLState();
+			state.OnDeleteBuffer(VBO);
+			state.OnDeleteBuffer(EBO);
+			state.OnDeleteVertexArray(VAO);
 			glDeleteBuffers(1, &VBO);
 			glDeleteBuffers(1, &EBO);
 			glDeleteVertexArrays(1, &VAO);
@@ -35,24 +290,46 @@ namespace ResRenderer {
 		
 		void UploadMeshData(const MeshData* data) {
 			meshInitialized = false;
-			CHECKED(glBindVertexArray(VAO));
-			CHECKED(glBindBuffer(GL_ARRAY_BUFFER, VBO));
+			auto& state = GetGLState();
+			state.BindVertexArray(VAO);
 			auto vertSize = static_cast<GLsizei>(GetMeshVertexSize(data));
-			CHECKED(glBufferData(GL_ARRAY_BUFFER, data->vertCount * vertSize, data->data, GL_STATIC_DRAW));
-
-			CHECKED(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO));
-			CHECKED(glBufferData(GL_ELEMENT_ARRAY_BUFFER, data->indiciesCount * sizeof(VertexIndex_t), data->indicies, GL_STATIC_DRAW));
+			indexCount = static_cast<GLsizei>(data->indiciesCount);
+			if (!dynamic || !UploadStreamed(data, vertSize)) {
+				if (dynamic)
+					streamingStats.fallbackUploads++;
+				auto usage = dynamic ? GL_STREAM_DRAW : GL_STATIC_DRAW;
+				state.BindArrayBuffer(VBO);
+				CHECKED(glBufferData(GL_ARRAY_BUFFER, data->vertCount * vertSize, data->data, usage));
+				state.BindElementBuffer(EBO);
+				indexType = UploadIndexBuffer(data->indicies, data->indiciesCount, usage);
+				indexOffset = 0;
+				SetupVertexAttribs(data->attribDescriptions, data->attribCount, vertSize, 0, 0, 0);
+			}
+			attribCount = static_cast<GLuint>(data->attribCount);
+			DisableAttribsFrom(attribCount);
+			instanceLayout = 0;
+			lods.assign(1, MeshLOD{ 0, static_cast<unsigned int>(indexCount), 0.0f });
+			meshInitialized = true;
+		}
 
-			char* startOffset = 0;
-			for (GLuint i = 0; i < (GLuint)data->attribCount; i++)
+		ErrorCode DrawInstanced(InstanceBufferImpl* instances, int instanceCount) {
+			if (!meshInitialized || instances->layoutSerial == 0)
+				return ErrorCode::MESH_NOT_CREATED;
+			try
 			{
-				auto desc = data->attribDescriptions[i];
-				CHECKED(glEnableVertexAttribArray(i));
-				CHECKED(glVertexAttribPointer(i, desc.count, GetGLAttribType(desc.type), desc.normalize, vertSize, startOffset));
-				startOffset += desc.count * GetVertexAttribSize(desc.type);
+				GetGLState().BindVertexArray(VAO);
+				if (instanceLayout != instances->layoutSerial) {
+					auto t = BindInstanceAttribs(instances);
+					if (t != ErrorCode::RES_NO_ERROR)
+						return t;
+				}
+				CHECKED(glDrawElementsInstanced(GL_TRIANGLES, indexCount, indexType, static_cast<char*>(nullptr) + indexOffset, instanceCount));
+				return ErrorCode::RES_NO_ERROR;
+			}
+			catch (GLenum)
+			{
+				return ErrorCode::INTERNAL_ERROR;
 			}
-			vertCount = data->vertCount;
-			meshInitialized = true;
 		}
 
 		ErrorCode Draw() {
@@ -60,8 +337,56 @@ namespace ResRenderer {
 				return ErrorCode::MESH_NOT_CREATED;
 			try
 			{
-				CHECKED(glBindVertexArray(VAO));
-				CHECKED(glDrawArrays(GL_TRIANGLES, 0, vertCount));
+				GetGLState().BindVertexArray(VAO);
+				CHECKED(glDrawElements(GL_TRIANGLES, indexCount, indexType, static_cast<char*>(nullptr) + indexOffset));
+				return ErrorCode::RES_NO_ERROR;
+			}
+			catch (GLenum)
+			{
+				return ErrorCode::INTERNAL_ERROR;
+			}
+		}
+
+		//Levels indexing into the buffer last uploaded by UploadMeshData. Other draws keep to level 0, the full mesh.
+		void SetLODs(const std::vector<MeshLOD>& levels) {
+			lods = levels;
+			indexCount = static_cast<GLsizei>(lods[0].indexCount);
+		}
+
+		ErrorCode DrawLOD(float projectedSize, float maxPixelError) {
+			if (!meshInitialized)
+				return ErrorCode::MESH_NOT_CREATED;
+			auto& lod = SelectMeshLOD(lods, projectedSize, maxPixelError);
+			try
+			{
+				GetGLState().BindVertexArray(VAO);
+				auto offset = static_cast<char*>(nullptr) + indexOffset + lod.firstIndex * GetIndexSize(indexType);
+				CHECKED(glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(lod.indexCount), indexType, offset));
+				return ErrorCode::RES_NO_ERROR;
+			}
+			catch (GLenum)
+			{
+				return ErrorCode::INTERNAL_ERROR;
+			}
+		}
+
+		ErrorCode DrawRanges(const IndexRange* ranges, int count) {
+			if (!meshInitialized)
+				return ErrorCode::MESH_NOT_CREATED;
+			counts.resize(count);
+			offsets.resize(count);
+			auto indexSize = GetIndexSize(indexType);
+			for (int i = 0; i < count; i++)
+			{
+				if (ranges[i].firstIndex > static_cast<unsigned int>(indexCount) || ranges[i].indexCount > indexCount - ranges[i].firstIndex)
+					return ErrorCode::MESH_DATA_LENGTH_ERROR;
+				counts[i] = static_cast<GLsizei>(ranges[i].indexCount);
+				offsets[i] = static_cast<char*>(nullptr) + indexOffset + ranges[i].firstIndex * indexSize;
+			}
+			try
+			{
+				GetGLState().BindVertexArray(VAO);
+				CHECKED(glMultiDrawElements(GL_TRIANGLES, counts.data(), indexType, offsets.data(), count));
 				return ErrorCode::RES_NO_ERROR;
 			}
 			catch (GLenum)
@@ -71,19 +396,104 @@ namespace ResRenderer {
 		}
 
 	private:
+		//Writes straight into the streaming buffer and points the VAO at it. VAO must be bound.
+		bool UploadStreamed(const MeshData* data, GLsizei vertSize) {
+			auto ring = GetStreamingBuffer();
+			if (ring == nullptr)
+				return false;
+			bool narrow = IndicesFit16Bits(data->indicies, data->indiciesCount);
+			size_t indexBytes = data->indiciesCount * (narrow ? sizeof(GLushort) : sizeof(VertexIndex_t));
+			auto vertexOffset = ring->Allocate(data->dataSize);
+			if (vertexOffset < 0)
+				return false;
+			auto offset = ring->Allocate(indexBytes);
+			if (offset < 0)
+				return false;
+
+			memcpy(ring->Pointer(vertexOffset), data->data, data->dataSize);
+			if (narrow) {
+				auto out = reinterpret_cast<GLushort*>(ring->Pointer(offset));
+				for (size_t i = 0; i < data->indiciesCount; i++)
+					out[i] = static_cast<GLushort>(data->indicies[i]);
+			}
+			else {
+				memcpy(ring->Pointer(offset), data->indicies, indexBytes);
+			}
+
+			auto& state = GetGLState();
+			state.BindArrayBuffer(ring->buffer);
+			SetupVertexAttribs(data->attribDescriptions, data->attribCount, vertSize, 0, 0, static_cast<size_t>(vertexOffset));
+			state.BindElementBuffer(ring->buffer);
+			indexType = narrow ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+			indexOffset = offset;
+			return true;
+		}
+
+		//Instance attributes live in the VAO too, right after vertex attributes.
+		ErrorCode BindInstanceAttribs(InstanceBufferImpl* instances) {
+			auto t = instances->SetupAttribs(attribCount, 0);
+			if (t != ErrorCode::RES_NO_ERROR)
+				return t;
+			DisableAttribsFrom(attribCount + static_cast<GLuint>(instances->attribCount));
+			instanceLayout = instances->layoutSerial;
+			return ErrorCode::RES_NO_ERROR;
+		}
+
+		//VAO must be bound.
+		void DisableAttribsFrom(GLuint first) {
+			for (GLuint i = first; i < enabledAttribEnd; i++)
+			{
+				CHECKED(glDisableVertexAttribArray(i));
+			}
+			enabledAttribEnd = first;
+		}
+
+		bool dynamic;
 		bool meshInitialized = false;
-		int vertCount = 0;
+		GLsizei indexCount = 0;
+		GLintptr indexOffset = 0;
+		GLenum indexType = GL_UNSIGNED_INT;
+		GLuint attribCount = 0;
+		GLuint enabledAttribEnd = 0;
+		unsigned long long instanceLayout = 0;
 		GLuint VAO, VBO, EBO;
+		//DrawRanges scratch.
+		std::vector<GLsizei> counts;
+		std::vector<const void*> offsets;
+		//Level 0 is the whole index buffer.
+		std::vector<MeshLOD> lods;
 	};
 
 	void RES_RENDERER_API SetViewPort(int x, int y, int width, int height) {
-		glViewport(x, y, width, height);
+		Dispatch([=] {
+			try
+			{
+				GetGLState().Viewport(x, y, width, height);
+			}
+			catch (GLenum)
+			{
+			}
+		});
 	}
 
+	//Owns a copy of mesh data, so it could be uploaded later on render thread.
+	struct MeshDataCopy {
+		explicit MeshDataCopy(const MeshData* source) : meshData(*source) {
+			auto bytes = static_cast<const unsigned char*>(source->data);
+			data.assign(bytes, bytes + source->dataSize);
+			indicies.assign(source->indicies, source->indicies + source->indiciesCount);
+			meshData.data = data.data();
+			meshData.indicies = indicies.data();
+		}
+		MeshData meshData;
+		std::vector<unsigned char> data;
+		std::vector<VertexIndex_t> indicies;
+	};
+
 	ErrorCode RES_RENDERER_API CreateMesh(Mesh* outMesh){
 		try
 		{
-			auto t = static_cast<Mesh>(new MeshImpl());
+			auto t = static_cast<Mesh>(DispatchSync([] { return new MeshImpl(); }));
 			*outMesh = t;
 			return ErrorCode::RES_NO_ERROR;
 		}
@@ -93,15 +503,82 @@ namespace ResRenderer {
 		}
 	}
 
+	ErrorCode RES_RENDERER_API CreateDynamicMesh(Mesh* outMesh) {
+		try
+		{
+			*outMesh = static_cast<Mesh>(DispatchSync([] { return new MeshImpl(true); }));
+			return ErrorCode::RES_NO_ERROR;
+		}
+		catch (GLenum)
+		{
+			return ErrorCode::INTERNAL_ERROR;
+		}
+	}
+
 	ErrorCode RES_RENDERER_API UploadMeshData(Mesh mesh, const MeshData* data) {
 		auto t = MeshDataVerify(data);
 		if (t != ErrorCode::RES_NO_ERROR)
 			return t;
 
 		auto pMesh = static_cast<MeshImpl*>(mesh);
+		std::shared_ptr<MeshDataCopy> copy;
+		if (GetRenderThread() != nullptr) {
+			//Caller may free data right after return.
+			copy = std::make_shared<MeshDataCopy>(data);
+			data = &copy->meshData;
+		}
+		return DispatchChecked("UploadMeshData", [pMesh, data, copy] {
+			try
+			{
+				pMesh->UploadMeshData(data);
+				return ErrorCode::RES_NO_ERROR;
+			}
+			catch (GLenum)
+			{
+				return ErrorCode::INTERNAL_ERROR;
+			}
+		});
+	}
+
+	ErrorCode RES_RENDERER_API UploadMeshDataWithLODs(Mesh mesh, const MeshData* data, const MeshLODSettings* settings) {
+		MeshLODSettings defaults;
+		std::vector<VertexIndex_t> indicies;
+		std::vector<MeshLOD> lods;
+		auto t = GenerateMeshLODs(data, settings != nullptr ? *settings : defaults, &indicies, &lods);
+		if (t != ErrorCode::RES_NO_ERROR)
+			return t;
+		MeshData combined = *data;
+		combined.indicies = indicies.data();
+		combined.indiciesCount = indicies.size();
+		t = UploadMeshData(mesh, &combined);
+		if (t != ErrorCode::RES_NO_ERROR)
+			return t;
+		auto pMesh = static_cast<MeshImpl*>(mesh);
+		return DispatchChecked("UploadMeshDataWithLODs", [pMesh, lods] {
+			pMesh->SetLODs(lods);
+			return ErrorCode::RES_NO_ERROR;
+		});
+	}
+
+	ErrorCode RES_RENDERER_API DestroyMesh(Mesh mesh) {
+		Dispatch([mesh] { delete static_cast<MeshImpl*>(mesh); });
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	struct InstanceDataCopy {
+		explicit InstanceDataCopy(const InstanceData* source) : instanceData(*source) {
+			auto bytes = static_cast<const unsigned char*>(source->data);
+			data.assign(bytes, bytes + source->dataSize);
+			instanceData.data = data.data();
+		}
+		InstanceData instanceData;
+		std::vector<unsigned char> data;
+	};
+
+	ErrorCode RES_RENDERER_API CreateInstanceBuffer(InstanceBuffer* outBuffer) {
 		try
 		{
-			pMesh->UploadMeshData(data);
+			*outBuffer = static_cast<InstanceBuffer>(DispatchSync([] { return new InstanceBufferImpl(); }));
 			return ErrorCode::RES_NO_ERROR;
 		}
 		catch (GLenum)
@@ -110,8 +587,297 @@ namespace ResRenderer {
 		}
 	}
 
-	ErrorCode RES_RENDERER_API DestroyMesh(Mesh mesh) {
-		delete static_cast<MeshImpl*>(mesh);
+	ErrorCode RES_RENDERER_API UploadInstanceData(InstanceBuffer buffer, const InstanceData* data) {
+		auto t = InstanceDataVerify(data);
+		if (t != ErrorCode::RES_NO_ERROR)
+			return t;
+
+		auto pBuffer = static_cast<InstanceBufferImpl*>(buffer);
+		pBuffer->instanceCount = data->instanceCount;
+		std::shared_ptr<InstanceDataCopy> copy;
+		if (GetRenderThread() != nullptr) {
+			copy = std::make_shared<InstanceDataCopy>(data);
+			data = &copy->instanceData;
+		}
+		return DispatchChecked("UploadInstanceData", [pBuffer, data, copy] {
+			try
+			{
+				pBuffer->UploadInstanceData(data);
+				return ErrorCode::RES_NO_ERROR;
+			}
+			catch (GLenum)
+			{
+				return ErrorCode::INTERNAL_ERROR;
+			}
+		});
+	}
+
+	ErrorCode RES_RENDERER_API DestroyInstanceBuffer(InstanceBuffer buffer) {
+		Dispatch([buffer] { delete static_cast<InstanceBufferImpl*>(buffer); });
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	//Layout of GL_DRAW_INDIRECT_BUFFER entries.
+	struct DrawElementsIndirectCommand {
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+
+	//Sub meshes are collected on CPU and appended to the buffers on the next draw after a change, then CPU copies are freed.
+	class MeshBatchImpl
+	{
+	public:
+		MeshBatchImpl() {
+			VAO = 0; VBO = 0; EBO = 0; indirectBuffer = 0;
+			CHECKED(glGenVertexArrays(1, &VAO));
+			CHECKED(glGenBuffers(1, &VBO));
+			CHECKED(glGenBuffers(1, &EBO));
+			CHECKED(glGenBuffers(1, &indirectBuffer));
+		}
+
+		~MeshBatchImpl() {
+			auto& state = GetGLState();
+			state.OnDeleteVertexArray(VAO);
+			state.OnDeleteBuffer(VBO);
+			state.OnDeleteBuffer(EBO);
+			glDeleteVertexArrays(1, &VAO);
+			glDeleteBuffers(1, &VBO);
+			glDeleteBuffers(1, &EBO);
+			glDeleteBuffers(1, &indirectBuffer);
+		}
+
+		void AddMesh(const MeshData* data) {
+			if (subMeshes.empty()) {
+				layout = *data;
+				vertSize = static_cast<GLsizei>(GetMeshVertexSize(data));
+			}
+			SubMesh sub;
+			sub.firstIndex = static_cast<GLuint>(uploadedIndexCount + pendingIndicies.size());
+			sub.indexCount = static_cast<GLuint>(data->indiciesCount);
+			sub.baseVertex = vertCount;
+			subMeshes.push_back(sub);
+
+			auto bytes = static_cast<const unsigned char*>(data->data);
+			pendingVertices.insert(pendingVertices.end(), bytes, bytes + data->dataSize);
+			pendingIndicies.insert(pendingIndicies.end(), data->indicies, data->indicies + data->indiciesCount);
+			vertCount += data->vertCount;
+			dirty = true;
+		}
+
+		ErrorCode Draw(const int* ids, int count, InstanceBufferImpl* instances) {
+			if (subMeshes.empty())
+				return ErrorCode::MESH_NOT_CREATED;
+			try
+			{
+				auto& state = GetGLState();
+				state.BindVertexArray(VAO);
+				if (dirty)
+					Upload();
+
+				bool baseInstance = GLEW_VERSION_4_2 || GLEW_ARB_base_instance;
+				if (instances != nullptr && instanceLayout != instances->layoutSerial) {
+					auto t = instances->SetupAttribs(static_cast<GLuint>(layout.attribCount), 0);
+					if (t != ErrorCode::RES_NO_ERROR)
+						return t;
+					DisableAttribsFrom(static_cast<GLuint>(layout.attribCount + instances->attribCount));
+					instanceLayout = instances->layoutSerial;
+				}
+				else if (instances == nullptr && instanceLayout != 0) {
+					DisableAttribsFrom(static_cast<GLuint>(layout.attribCount));
+					instanceLayout = 0;
+				}
+
+				if (GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect) {
+					commands.resize(count);
+					for (int i = 0; i < count; i++)
+					{
+						auto& sub = subMeshes[ids[i]];
+						auto& command = commands[i];
+						command.count = sub.indexCount;
+						command.instanceCount = 1;
+						command.firstIndex = sub.firstIndex;
+						command.baseVertex = sub.baseVertex;
+						command.baseInstance = instances != nullptr ? static_cast<GLuint>(i) : 0;
+					}
+					CHECKED(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer));
+					CHECKED(glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_STREAM_DRAW));
+					CHECKED(glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, nullptr, count, 0));
+				}
+				else if (instances == nullptr) {
+					//GL 3.2 fallback, still one call.
+					counts.resize(count);
+					offsets.resize(count);
+					baseVertices.resize(count);
+					auto indexSize = GetIndexSize(indexType);
+					for (int i = 0; i < count; i++)
+					{
+						auto& sub = subMeshes[ids[i]];
+						counts[i] = static_cast<GLsizei>(sub.indexCount);
+						offsets[i] = static_cast<char*>(nullptr) + sub.firstIndex * indexSize;
+						baseVertices[i] = sub.baseVertex;
+					}
+					CHECKED(glMultiDrawElementsBaseVertex(GL_TRIANGLES, counts.data(), indexType, offsets.data(), count, baseVertices.data()));
+				}
+				else {
+					//No way to pass per draw data in one call, one draw each.
+					auto indexSize = GetIndexSize(indexType);
+					for (int i = 0; i < count; i++)
+					{
+						auto& sub = subMeshes[ids[i]];
+						auto offset = static_cast<char*>(nullptr) + sub.firstIndex * indexSize;
+						if (baseInstance) {
+							CHECKED(glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, sub.indexCount, indexType, offset, 1, sub.baseVertex, i));
+						}
+						else {
+							auto t = instances->SetupAttribs(static_cast<GLuint>(layout.attribCount), i);
+							if (t != ErrorCode::RES_NO_ERROR) {
+								instanceLayout = 0;
+								return t;
+							}
+							CHECKED(glDrawElementsBaseVertex(GL_TRIANGLES, sub.indexCount, indexType, offset, sub.baseVertex));
+						}
+					}
+					if (!baseInstance)
+						instanceLayout = 0;
+				}
+				return ErrorCode::RES_NO_ERROR;
+			}
+			catch (GLenum)
+			{
+				return ErrorCode::INTERNAL_ERROR;
+			}
+		}
+
+		//Set on API thread, for validation.
+		MeshData apiLayout;
+		int apiSubMeshCount = 0;
+
+	private:
+		struct SubMesh {
+			GLuint firstIndex;
+			GLuint indexCount;
+			GLint baseVertex;
+		};
+
+		//VAO must be bound. Indices are local to sub meshes, so they usually fit in 16 bits.
+		void Upload() {
+			auto& state = GetGLState();
+			bool narrow = (uploadedIndexCount == 0 || indexType == GL_UNSIGNED_SHORT) && IndicesFit16Bits(pendingIndicies.data(), pendingIndicies.size());
+			if (uploadedIndexCount > 0 && indexType == GL_UNSIGNED_SHORT && !narrow) {
+				//Widening needs the uploaded indices back, all of them are uploaded again.
+				std::vector<GLushort> uploaded(uploadedIndexCount);
+				state.BindElementBuffer(EBO);
+				CHECKED(glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, uploaded.size() * sizeof(GLushort), uploaded.data()));
+				pendingIndicies.insert(pendingIndicies.begin(), uploaded.begin(), uploaded.end());
+				uploadedIndexCount = 0;
+			}
+			indexType = narrow ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+			auto indexSize = static_cast<size_t>(GetIndexSize(indexType));
+			std::vector<GLushort> narrowed;
+			const void* indexData = pendingIndicies.data();
+			if (narrow) {
+				narrowed.assign(pendingIndicies.begin(), pendingIndicies.end());
+				indexData = narrowed.data();
+			}
+			AppendToBuffer(VBO, uploadedVertexBytes, pendingVertices.data(), pendingVertices.size());
+			AppendToBuffer(EBO, uploadedIndexCount * indexSize, indexData, pendingIndicies.size() * indexSize);
+			uploadedVertexBytes += pendingVertices.size();
+			uploadedIndexCount += pendingIndicies.size();
+			std::vector<unsigned char>().swap(pendingVertices);
+			std::vector<VertexIndex_t>().swap(pendingIndicies);
+
+			state.BindArrayBuffer(VBO);
+			SetupVertexAttribs(layout.attribDescriptions, layout.attribCount, vertSize, 0, 0, 0);
+			state.BindElementBuffer(EBO);
+			dirty = false;
+		}
+
+		//Replaces buffer by one holding its first oldBytes followed by data. The copy stays on GPU.
+		static void AppendToBuffer(GLuint& buffer, size_t oldBytes, const void* data, size_t bytes) {
+			if (oldBytes == 0) {
+				CHECKED(glBindBuffer(GL_COPY_WRITE_BUFFER, buffer));
+				CHECKED(glBufferData(GL_COPY_WRITE_BUFFER, bytes, data, GL_STATIC_DRAW));
+				return;
+			}
+			GLuint grown = 0;
+			CHECKED(glGenBuffers(1, &grown));
+			CHECKED(glBindBuffer(GL_COPY_WRITE_BUFFER, grown));
+			CHECKED(glBufferData(GL_COPY_WRITE_BUFFER, oldBytes + bytes, nullptr, GL_STATIC_DRAW));
+			CHECKED(glBindBuffer(GL_COPY_READ_BUFFER, buffer));
+			CHECKED(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldBytes));
+			CHECKED(glBufferSubData(GL_COPY_WRITE_BUFFER, oldBytes, bytes, data));
+			GetGLState().OnDeleteBuffer(buffer);
+			glDeleteBuffers(1, &buffer);
+			buffer = grown;
+		}
+
+		//VAO must be bound.
+		void DisableAttribsFrom(GLuint first) {
+			for (GLuint i = first; i < enabledAttribEnd; i++)
+			{
+				CHECKED(glDisableVertexAttribArray(i));
+			}
+			enabledAttribEnd = first;
+		}
+
+		GLuint VAO, VBO, EBO, indirectBuffer;
+		MeshData layout;
+		GLsizei vertSize = 0;
+		std::vector<SubMesh> subMeshes;
+		//Added since the last upload.
+		std::vector<unsigned char> pendingVertices;
+		std::vector<VertexIndex_t> pendingIndicies;
+		size_t uploadedVertexBytes = 0;
+		size_t uploadedIndexCount = 0;
+		GLint vertCount = 0;
+		GLenum indexType = GL_UNSIGNED_INT;
+		bool dirty = false;
+		GLuint enabledAttribEnd = 0;
+		unsigned long long instanceLayout = 0;
+		//Scratch for building draws.
+		std::vector<DrawElementsIndirectCommand> commands;
+		std::vector<GLsizei> counts;
+		std::vector<void*> offsets;
+		std::vector<GLint> baseVertices;
+	};
+
+	ErrorCode RES_RENDERER_API CreateMeshBatch(MeshBatch* outBatch) {
+		try
+		{
+			*outBatch = static_cast<MeshBatch>(DispatchSync([] { return new MeshBatchImpl(); }));
+			return ErrorCode::RES_NO_ERROR;
+		}
+		catch (GLenum)
+		{
+			return ErrorCode::INTERNAL_ERROR;
+		}
+	}
+
+	ErrorCode RES_RENDERER_API MeshBatchAddMesh(MeshBatch batch, const MeshData* data, int* outSubMesh) {
+		auto t = MeshDataVerify(data);
+		if (t != ErrorCode::RES_NO_ERROR)
+			return t;
+		auto pBatch = static_cast<MeshBatchImpl*>(batch);
+		if (pBatch->apiSubMeshCount == 0)
+			pBatch->apiLayout = *data;
+		else if (!MeshDataSameLayout(&pBatch->apiLayout, data))
+			return ErrorCode::MESH_DATA_BROKEN;
+		*outSubMesh = pBatch->apiSubMeshCount++;
+
+		std::shared_ptr<MeshDataCopy> copy;
+		if (GetRenderThread() != nullptr) {
+			copy = std::make_shared<MeshDataCopy>(data);
+			data = &copy->meshData;
+		}
+		Dispatch([pBatch, data, copy] { pBatch->AddMesh(data); });
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API DestroyMeshBatch(MeshBatch batch) {
+		Dispatch([batch] { delete static_cast<MeshBatchImpl*>(batch); });
 		return ErrorCode::RES_NO_ERROR;
 	}
 
@@ -138,6 +904,327 @@ namespace ResRenderer {
 		"	}\n"
 		"#endif\n";
 
+	static const char ProgramCacheMagic[] = "RESPROG1";
+
+	//Program binaries on disk, one file per program: ProgramCacheHeader followed by the binary.
+	//Only used on the thread owning the context.
+	class ProgramCache {
+	public:
+		void SetDirectory(const char* path) {
+			std::lock_guard<std::mutex> lock(mutex);
+			directory = path != nullptr ? path : "";
+			checked = false;
+		}
+
+		bool Enabled() {
+			std::lock_guard<std::mutex> lock(mutex);
+			if (directory.empty())
+				return false;
+			if (!checked) {
+				checked = true;
+				GLint formats = 0;
+				if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+					glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+				supported = formats > 0;
+				driverKey = 14695981039346656037ull;
+				for (auto name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+				{
+					auto t = reinterpret_cast<const char*>(glGetString(name));
+					driverKey = Hash(driverKey, t != nullptr ? t : "");
+				}
+			}
+			return supported;
+		}
+
+		//Covers everything assembled into both stages.
+		unsigned long long Key(const char* version, const char* header, const char* source) const {
+			return Hash(Hash(Hash(driverKey, version), header), source);
+		}
+
+		bool Load(unsigned long long key, GLuint program) {
+			std::lock_guard<std::mutex> lock(mutex);
+			std::ifstream file(Path(key), std::ios::binary | std::ios::ate);
+			auto fileSize = static_cast<long long>(file.tellg());
+			file.seekg(0);
+			ProgramCacheHeader header;
+			if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || memcmp(header.magic, ProgramCacheMagic, sizeof(header.magic)) != 0 || header.key != key) {
+				stats.misses++;
+				return false;
+			}
+			//Corrupt or truncated files may claim any length, never allocate more than is there.
+			if (header.length == 0 || header.length > fileSize - static_cast<long long>(sizeof(header))) {
+				stats.misses++;
+				return false;
+			}
+			std::vector<char> binary(header.length);
+			if (!file.read(binary.data(), binary.size())) {
+				stats.misses++;
+				return false;
+			}
+			file.close();
+
+			glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+			GLint success = 0;
+			glGetProgramiv(program, GL_LINK_STATUS, &success);
+			if (!success) {
+				//Unknown formats raise GL errors, a rejection isn't one for us. Bounded, a lost context never runs out of errors.
+				for (int i = 0; i < 4 && glGetError() != GL_NO_ERROR; i++) {}
+				stats.rejected++;
+				stats.misses++;
+				std::remove(Path(key).c_str());
+				return false;
+			}
+			stats.hits++;
+			return true;
+		}
+
+		void Store(unsigned long long key, GLuint program) {
+			std::lock_guard<std::mutex> lock(mutex);
+			GLint length = 0;
+			glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+			if (length <= 0)
+				return;
+			ProgramCacheHeader header;
+			memcpy(header.magic, ProgramCacheMagic, sizeof(header.magic));
+			header.key = key;
+			std::vector<char> binary(length);
+			GLsizei written = 0;
+			CHECKED(glGetProgramBinary(program, length, &written, &header.format, binary.data()));
+			header.length = static_cast<unsigned int>(written);
+
+			//Readers never see half written files.
+			auto path = Path(key);
+			auto temp = path + ".tmp";
+			{
+				std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+				file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+				file.write(binary.data(), written);
+				if (!file)
+					return;
+			}
+			std::remove(path.c_str());
+			if (std::rename(temp.c_str(), path.c_str()) == 0)
+				stats.stores++;
+		}
+
+		GLProgramCacheStats GetStats() {
+			std::lock_guard<std::mutex> lock(mutex);
+			return stats;
+		}
+
+		void ResetStats() {
+			std::lock_guard<std::mutex> lock(mutex);
+			stats = GLProgramCacheStats();
+		}
+
+	private:
+		struct ProgramCacheHeader {
+			char magic[8];
+			unsigned long long key;
+			GLenum format;
+			unsigned int length;
+		};
+
+		//FNV-1a, 64 bits.
+		static unsigned long long Hash(unsigned long long hash, const char* s) {
+			for (; *s != '\0'; s++)
+				hash = (hash ^ static_cast<unsigned char>(*s)) * 1099511628211ull;
+			//Separator, so moving characters between strings changes the key.
+			return (hash ^ 0xFF) * 1099511628211ull;
+		}
+
+		std::string Path(unsigned long long key) const {
+			char name[32];
+			snprintf(name, sizeof(name), "/%016llx.glprog", key);
+			return directory + name;
+		}
+
+		//Compile workers use it too.
+		std::mutex mutex;
+		GLProgramCacheStats stats;
+		std::string directory;
+		bool checked = false;
+		bool supported = false;
+		unsigned long long driverKey = 0;
+	};
+
+	static ProgramCache programCache;
+
+	void RES_RENDERER_API SetGLProgramCacheDirectory(const char* directory) {
+		std::string t = directory != nullptr ? directory : "";
+		DispatchSync([t] { programCache.SetDirectory(t.c_str()); });
+	}
+
+	void RES_RENDERER_API GetGLProgramCacheStats(GLProgramCacheStats* outStats) {
+		*outStats = DispatchSync([] { return programCache.GetStats(); });
+	}
+
+	void RES_RENDERER_API ResetGLProgramCacheStats() {
+		DispatchSync([] { programCache.ResetStats(); });
+	}
+
+	//Active uniforms of a linked program by id, open addressing with linear probing.
+	//Built on the thread owning the context after linking, read-only until next link.
+	class UniformTable {
+	public:
+		void Build(GLuint program) {
+			entries.clear();
+			GLint count = 0, maxLength = 0;
+			glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+			glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+			size_t capacity = 8;
+			while (capacity < static_cast<size_t>(count) * 2)
+				capacity *= 2;
+			entries.resize(capacity);
+			mask = capacity - 1;
+
+			std::vector<char> name(maxLength + 1);
+			for (GLint i = 0; i < count; i++)
+			{
+				GLsizei length;
+				GLint size;
+				GLenum type;
+				glGetActiveUniform(program, i, static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+				auto location = glGetUniformLocation(program, name.data());
+				//Members of uniform blocks have no location.
+				if (location < 0)
+					continue;
+				std::string t(name.data(), length);
+				//Arrays are reported as "name[0]", but looked up by "name".
+				if (t.size() > 3 && t.compare(t.size() - 3, 3, "[0]") == 0)
+					t.resize(t.size() - 3);
+				Insert(t, location);
+			}
+		}
+
+		GLint Find(UniformId id) const {
+			for (size_t i = id & mask; i < entries.size() && entries[i].used; i = (i + 1) & mask)
+			{
+				if (entries[i].id == id)
+					return entries[i].location;
+			}
+			return -1;
+		}
+
+		//-1 if not in the table, for names that hash to the same id too.
+		GLint Find(const char* name) const {
+			auto id = MakeUniformId(name);
+			for (size_t i = id & mask; i < entries.size() && entries[i].used; i = (i + 1) & mask)
+			{
+				if (entries[i].id == id && entries[i].name == name)
+					return entries[i].location;
+			}
+			return -1;
+		}
+
+	private:
+		struct Entry {
+			bool used = false;
+			UniformId id = 0;
+			GLint location = -1;
+			std::string name;
+		};
+
+		void Insert(const std::string& name, GLint location) {
+			auto id = MakeUniformId(name.c_str());
+			auto i = id & mask;
+			for (; entries[i].used; i = (i + 1) & mask)
+			{
+				if (entries[i].id == id)
+					std::cerr << "Uniforms " << entries[i].name << " and " << name << " have the same id, id lookups find the first one." << std::endl;
+			}
+			entries[i].used = true;
+			entries[i].id = id;
+			entries[i].location = location;
+			entries[i].name = name;
+		}
+
+		std::vector<Entry> entries;
+		size_t mask = 0;
+	};
+
+	//Active uniforms outside blocks by name(arrays without "[0]"), with type and array size.
+	struct ActiveUniform {
+		GLenum type;
+		GLint size;
+	};
+
+	static std::map<std::string, ActiveUniform> GetActiveUniforms(GLuint program) {
+		std::map<std::string, ActiveUniform> uniforms;
+		GLint count = 0, maxLength = 0;
+		glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+		glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+		std::vector<char> name(maxLength + 1);
+		for (GLint i = 0; i < count; i++)
+		{
+			GLsizei length;
+			GLint size;
+			GLenum type;
+			glGetActiveUniform(program, i, static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+			//Members of uniform blocks have no location, their values live in buffers.
+			if (glGetUniformLocation(program, name.data()) < 0)
+				continue;
+			std::string t(name.data(), length);
+			if (t.size() > 3 && t.compare(t.size() - 3, 3, "[0]") == 0)
+				t.resize(t.size() - 3);
+			uniforms[t] = ActiveUniform{ type, size };
+		}
+		return uniforms;
+	}
+
+	//Copies one value of type from location src of program from to location dst of the program in use.
+	static void CopyUniformValue(GLuint from, GLint src, GLint dst, GLenum type) {
+		GLfloat f[16];
+		GLint i[4];
+		GLuint u[4];
+		switch (type)
+		{
+		case GL_FLOAT: glGetUniformfv(from, src, f); glUniform1fv(dst, 1, f); break;
+		case GL_FLOAT_VEC2: glGetUniformfv(from, src, f); glUniform2fv(dst, 1, f); break;
+		case GL_FLOAT_VEC3: glGetUniformfv(from, src, f); glUniform3fv(dst, 1, f); break;
+		case GL_FLOAT_VEC4: glGetUniformfv(from, src, f); glUniform4fv(dst, 1, f); break;
+		case GL_FLOAT_MAT2: glGetUniformfv(from, src, f); glUniformMatrix2fv(dst, 1, GL_FALSE, f); break;
+		case GL_FLOAT_MAT3: glGetUniformfv(from, src, f); glUniformMatrix3fv(dst, 1, GL_FALSE, f); break;
+		case GL_FLOAT_MAT4: glGetUniformfv(from, src, f); glUniformMatrix4fv(dst, 1, GL_FALSE, f); break;
+		case GL_FLOAT_MAT2x3: glGetUniformfv(from, src, f); glUniformMatrix2x3fv(dst, 1, GL_FALSE, f); break;
+		case GL_FLOAT_MAT2x4: glGetUniformfv(from, src, f); glUniformMatrix2x4fv(dst, 1, GL_FALSE, f); break;
+		case GL_FLOAT_MAT3x2: glGetUniformfv(from, src, f); glUniformMatrix3x2fv(dst, 1, GL_FALSE, f); break;
+		case GL_FLOAT_MAT3x4: glGetUniformfv(from, src, f); glUniformMatrix3x4fv(dst, 1, GL_FALSE, f); break;
+		case GL_FLOAT_MAT4x2: glGetUniformfv(from, src, f); glUniformMatrix4x2fv(dst, 1, GL_FALSE, f); break;
+		case GL_FLOAT_MAT4x3: glGetUniformfv(from, src, f); glUniformMatrix4x3fv(dst, 1, GL_FALSE, f); break;
+		case GL_INT_VEC2: case GL_BOOL_VEC2: glGetUniformiv(from, src, i); glUniform2iv(dst, 1, i); break;
+		case GL_INT_VEC3: case GL_BOOL_VEC3: glGetUniformiv(from, src, i); glUniform3iv(dst, 1, i); break;
+		case GL_INT_VEC4: case GL_BOOL_VEC4: glGetUniformiv(from, src, i); glUniform4iv(dst, 1, i); break;
+		case GL_UNSIGNED_INT: glGetUniformuiv(from, src, u); glUniform1uiv(dst, 1, u); break;
+		case GL_UNSIGNED_INT_VEC2: glGetUniformuiv(from, src, u); glUniform2uiv(dst, 1, u); break;
+		case GL_UNSIGNED_INT_VEC3: glGetUniformuiv(from, src, u); glUniform3uiv(dst, 1, u); break;
+		case GL_UNSIGNED_INT_VEC4: glGetUniformuiv(from, src, u); glUniform4uiv(dst, 1, u); break;
+		//int, bool and every sampler type are a single int.
+		default: glGetUniformiv(from, src, i); glUniform1iv(dst, 1, i); break;
+		}
+	}
+
+	//Uniform values belong to a program, so a reload would reset them. Copies those with the same name and type in both,
+	//to must be in use.
+	static void CopyUniformValues(GLuint from, GLuint to) {
+		auto target = GetActiveUniforms(to);
+		for (auto& uniform : GetActiveUniforms(from))
+		{
+			auto ite = target.find(uniform.first);
+			if (ite == target.end() || ite->second.type != uniform.second.type)
+				continue;
+			auto size = std::min(uniform.second.size, ite->second.size);
+			for (GLint e = 0; e < size; e++)
+			{
+				auto name = uniform.second.size > 1 ? uniform.first + "[" + std::to_string(e) + "]" : uniform.first;
+				auto src = glGetUniformLocation(from, name.c_str());
+				auto dst = glGetUniformLocation(to, name.c_str());
+				if (src >= 0 && dst >= 0)
+					CopyUniformValue(from, src, dst, uniform.second.type);
+			}
+		}
+	}
+
 	class ShaderImpl {
 	public:
 		ShaderImpl()
@@ -146,95 +1233,223 @@ namespace ResRenderer {
 			vs = CHECKED(glCreateShader(GL_VERTEX_SHADER));
 			ps = CHECKED(glCreateShader(GL_FRAGMENT_SHADER));
 			program = CHECKED(glCreateProgram());
+			//Stay attached, recompiling only replaces sources.
+			glAttachShader(program, vs);
+			glAttachShader(program, ps);
 		}
 
-		bool CompileVertexShader(const char* source, char* compileErrorLog, size_t compileErrorLogSize, size_t* logLength) {
-			int success;
-
+		//Compile and link requests only, nothing waits for the driver until results are queried.
+		void Submit(const char* source) {
 			const char* sourcesvs[] = { OpenGLShaderVersion, "#define VERTEX\n", OpenGLShaderHeader, source };
 			glShaderSource(vs, 4, sourcesvs, NULL);
 			glCompileShader(vs);
-			glGetShaderiv(vs, GL_COMPILE_STATUS, &success);
-
-			GLsizei mlogLength;
-			if (!success) {
-				glGetShaderInfoLog(vs, static_cast<GLsizei>(compileErrorLogSize), &mlogLength, compileErrorLog);
-				*logLength = static_cast<size_t>(mlogLength);
-			}
-			return success;
+			const char* sourcesps[] = { OpenGLShaderVersion, "#define FRAGMENT\n", OpenGLShaderHeader, source };
+			glShaderSource(ps, 4, sourcesps, NULL);
+			glCompileShader(ps);
+			glLinkProgram(program);
 		}
 
-		bool CompileFragShader(const char* source, char* compileErrorLog, size_t compileErrorLogSize, size_t* logLength) {
+		bool StageResult(GLuint shader, char* compileErrorLog, size_t compileErrorLogSize, size_t* logLength) {
 			int success;
+			glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
 
-			const char* sourcesvs[] = { OpenGLShaderVersion, "#define FRAGMENT\n",OpenGLShaderHeader, source };
-			glShaderSource(ps, 4, sourcesvs, NULL);
-			glCompileShader(ps);
-			glGetShaderiv(ps, GL_COMPILE_STATUS, &success);
-
-			GLsizei mlogLength;
-			if (!success) {
-				glGetShaderInfoLog(ps, static_cast<GLsizei>(compileErrorLogSize), &mlogLength, compileErrorLog);
-				*logLength = static_cast<size_t>(mlogLength);
-			}
+			GLsizei mlogLength = 0;
+			if (!success && compileErrorLogSize > 0)
+				glGetShaderInfoLog(shader, static_cast<GLsizei>(compileErrorLogSize), &mlogLength, compileErrorLog);
+			*logLength = static_cast<size_t>(mlogLength);
 			return success;
 		}
 
-		bool Link(char* errorLog, size_t logBufferSize, size_t* logLength) {
-			glAttachShader(program, vs);
-			glAttachShader(program, ps);
-			glLinkProgram(program);
-
+		bool LinkResult(char* errorLog, size_t logBufferSize, size_t* logLength) {
 			int success;
 			glGetProgramiv(program, GL_LINK_STATUS, &success);
-			GLsizei mlogLength;
-			if (!success) {
+			GLsizei mlogLength = 0;
+			if (!success && logBufferSize > 0)
 				glGetProgramInfoLog(program, static_cast<GLsizei>(logBufferSize), &mlogLength, errorLog);
-				*logLength = static_cast<size_t>(mlogLength);
-			}
+			*logLength = static_cast<size_t>(mlogLength);
 			return success;
 		}
 
-		bool Compile(const char* source, char* compileErrorLog, size_t compileErrorLogSize, size_t* errorLength) {
+		//Waits for submitted compile and link, then stores the program and its uniforms.
+		bool Collect(char* compileErrorLog, size_t compileErrorLogSize, size_t* errorLength) {
 			bool success = true;
 			size_t errorLogStart = 0;
 			size_t partErrLogSize = 0;
-			success &= CompileVertexShader(source, compileErrorLog, compileErrorLogSize, &partErrLogSize);
+			success &= StageResult(vs, compileErrorLog, compileErrorLogSize, &partErrLogSize);
 			errorLogStart += partErrLogSize;
-			success &= CompileFragShader(source, compileErrorLog + errorLogStart, compileErrorLogSize - errorLogStart, &partErrLogSize);
+			success &= StageResult(ps, compileErrorLog + errorLogStart, compileErrorLogSize - errorLogStart, &partErrLogSize);
 			errorLogStart += partErrLogSize;
-			success &= Link(compileErrorLog + errorLogStart, compileErrorLogSize - errorLogStart, &partErrLogSize);
+			success &= LinkResult(compileErrorLog + errorLogStart, compileErrorLogSize - errorLogStart, &partErrLogSize);
 			errorLogStart += partErrLogSize;
 
 			if (errorLength != nullptr) {
 				*errorLength = errorLogStart;
 			}
 
+			if (success) {
+				if (cacheKey != 0)
+					programCache.Store(cacheKey, program);
+				uniforms.Build(program);
+			}
 			return success;
 		}
 
+		//True if the program was loaded from cache, otherwise prepares for Submit.
+		bool LoadCached(const char* source) {
+			cacheKey = 0;
+			if (!programCache.Enabled())
+				return false;
+			auto key = programCache.Key(OpenGLShaderVersion, OpenGLShaderHeader, source);
+			if (programCache.Load(key, program)) {
+				uniforms.Build(program);
+				return true;
+			}
+			cacheKey = key;
+			glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+			return false;
+		}
+
+		bool Compile(const char* source, char* compileErrorLog, size_t compileErrorLogSize, size_t* errorLength) {
+			if (LoadCached(source)) {
+				if (errorLength != nullptr)
+					*errorLength = 0;
+				return true;
+			}
+			Submit(source);
+			return Collect(compileErrorLog, compileErrorLogSize, errorLength);
+		}
+
+		//Asynchronous compiles. Status and log are written by the compiling thread, read by API thread.
+		void FinishAsync(bool success, const char* log, size_t logLength) {
+			asyncLog.assign(log, logLength);
+			asyncStatus.store(static_cast<int>(success ? ShaderCompileStatus::Succeeded : ShaderCompileStatus::Failed), std::memory_order_release);
+		}
+
+		//KHR_parallel_shader_compile, on the thread owning the render context. Completion is polled with PollParallel.
+		void BeginParallel(const char* source) {
+			try
+			{
+				if (LoadCached(source)) {
+					FinishAsync(true, "", 0);
+					return;
+				}
+				Submit(source);
+			}
+			catch (GLenum)
+			{
+				FinishAsync(false, "", 0);
+			}
+		}
+
+		void PollParallel() {
+			if (asyncStatus.load(std::memory_order_acquire) != static_cast<int>(ShaderCompileStatus::Compiling))
+				return;
+			GLint done = GL_FALSE;
+			glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &done);
+			if (!done)
+				return;
+			char log[4096];
+			size_t length = 0;
+			bool success = false;
+			try
+			{
+				success = Collect(log, sizeof(log), &length);
+			}
+			catch (GLenum)
+			{
+			}
+			FinishAsync(success, log, length);
+		}
+
+		//On a compile worker owning a context shared with the render context.
+		void CompileOnWorker(const char* source) {
+			char log[4096];
+			size_t length = 0;
+			bool success = false;
+			try
+			{
+				success = Compile(source, log, sizeof(log), &length);
+			}
+			catch (GLenum)
+			{
+			}
+			//Other contexts only see a finished program.
+			glFinish();
+			FinishAsync(success, log, length);
+		}
+
+		std::atomic<int> asyncStatus{ static_cast<int>(ShaderCompileStatus::None) };
+		//API thread only, compile needs PollParallel to finish.
+		bool parallel = false;
+		//Set while a PollParallel is queued on the render thread.
+		std::atomic<bool> pollQueued{ false };
+		std::string asyncLog;
+
 		int GetUniformLocation(const char* name) {
 			return glGetUniformLocation(program, name);
 		}
 
+		bool SetUniformBlockSlot(const char* name, int slot) {
+			auto index = glGetUniformBlockIndex(program, name);
+			if (index == GL_INVALID_INDEX) {
+				std::cerr << "Uniform block " << name << " not found." << std::endl;
+				return false;
+			}
+			CHECKED(glUniformBlockBinding(program, index, static_cast<GLuint>(slot)));
+			blockSlots[name] = slot;
+			return true;
+		}
+
+		//Takes over objects of staging, which compiled successfully, and deletes it with the old ones.
+		//Uniform values and block bindings carry over. Uniform table is moved separately on API thread.
+		void AdoptProgram(ShaderImpl* staging) {
+			auto& state = GetGLState();
+			//Copying values needs the new program in use, whatever was in use before is restored after.
+			GLint previous = 0;
+			glGetIntegerv(GL_CURRENT_PROGRAM, &previous);
+			bool bound = state.IsProgramBound(program) || static_cast<GLuint>(previous) == program;
+			std::swap(vs, staging->vs);
+			std::swap(ps, staging->ps);
+			std::swap(program, staging->program);
+			Use();
+			CopyUniformValues(staging->program, program);
+			delete staging;
+			for (auto& blockSlot : blockSlots)
+			{
+				auto index = glGetUniformBlockIndex(program, blockSlot.first.c_str());
+				if (index != GL_INVALID_INDEX)
+					glUniformBlockBinding(program, index, static_cast<GLuint>(blockSlot.second));
+			}
+			//Draws after the reload shouldn't need another UseShader.
+			if (!bound)
+				state.UseProgram(static_cast<GLuint>(previous));
+		}
+
 		void Use() {
-			CHECKED(glUseProgram(program));
+			GetGLState().UseProgram(program);
 		}
 
 		~ShaderImpl()
 		{
+			GetGLState().OnDeleteProgram(program);
 			glDeleteShader(vs);
 			glDeleteShader(ps);
 			glDeleteProgram(program);
 		}
+
+		//Written only by CompileShader, which waits for the render thread, or before a compile polls as done.
+		//So it's readable on API thread.
+		UniformTable uniforms;
 	private:
 		GLuint vs, ps, program;
+		unsigned long long cacheKey = 0;
+		std::map<std::string, int> blockSlots;
 	};
 
 	ErrorCode RES_RENDERER_API CreateShader(Shader* outShader) {
 		try
 		{
-			auto t = new ShaderImpl();
+			auto t = DispatchSync([] { return new ShaderImpl(); });
 			*outShader = static_cast<Shader>(t);
 			return ErrorCode::RES_NO_ERROR;
 		}
@@ -246,17 +1461,102 @@ namespace ResRenderer {
 
 	ErrorCode RES_RENDERER_API CompileShader(Shader shader, const char* source, char* compileErrorLog, size_t compileErrorMaxLength, size_t* compileErrorLength) {
 		auto pShader = static_cast<ShaderImpl*>(shader);
-		if (!pShader->Compile(source, compileErrorLog, compileErrorMaxLength, compileErrorLength)) {
+		auto success = DispatchSync([=] { return pShader->Compile(source, compileErrorLog, compileErrorMaxLength, compileErrorLength); });
+		if (!success) {
 			return ErrorCode::INTERNAL_ERROR;
 		}
 		return ErrorCode::RES_NO_ERROR;
 	}
 
+	static bool ParallelCompileSupported() {
+		return GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+	}
+
+	//On the thread owning the render context, before the first parallel compile.
+	static void UseParallelCompileThreads() {
+		static bool threadsSet = false;
+		if (threadsSet)
+			return;
+		threadsSet = true;
+		if (GLEW_KHR_parallel_shader_compile)
+			glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+		else
+			glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+	}
+
+	ErrorCode RES_RENDERER_API CompileShaderAsync(Shader shader, const char* source) {
+		if (source == nullptr)
+			return ErrorCode::INTERNAL_ERROR;
+		auto pShader = static_cast<ShaderImpl*>(shader);
+		auto copy = std::make_shared<std::string>(source);
+		pShader->asyncStatus.store(static_cast<int>(ShaderCompileStatus::Compiling));
+		//Driver compiles in the background, results are picked up by polling.
+		pShader->parallel = ParallelCompileSupported();
+		if (pShader->parallel) {
+			Dispatch([pShader, copy] {
+				UseParallelCompileThreads();
+				pShader->BeginParallel(copy->c_str());
+			});
+			return ErrorCode::RES_NO_ERROR;
+		}
+		if (DispatchToCompileWorker([pShader, copy] { pShader->CompileOnWorker(copy->c_str()); }))
+			return ErrorCode::RES_NO_ERROR;
+		//No shared contexts, compiled like CompileShader. Still returns right away with a render thread.
+		Dispatch([pShader, copy] {
+			char log[4096];
+			size_t length = 0;
+			bool success = false;
+			try
+			{
+				success = pShader->Compile(copy->c_str(), log, sizeof(log), &length);
+			}
+			catch (GLenum)
+			{
+			}
+			pShader->FinishAsync(success, log, length);
+		});
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API PollShaderCompile(Shader shader, ShaderCompileStatus* outStatus, char* compileErrorLog, size_t compileErrorMaxLength, size_t* compileErrorLength) {
+		auto pShader = static_cast<ShaderImpl*>(shader);
+		auto status = static_cast<ShaderCompileStatus>(pShader->asyncStatus.load(std::memory_order_acquire));
+		if (status == ShaderCompileStatus::Compiling && pShader->parallel) {
+			//Result shows up in a later poll with a render thread. One poll in flight at a time, spinning callers don't flood the ring.
+			if (!pShader->pollQueued.exchange(true, std::memory_order_acq_rel)) {
+				Dispatch([pShader] {
+					pShader->PollParallel();
+					pShader->pollQueued.store(false, std::memory_order_release);
+				});
+			}
+			status = static_cast<ShaderCompileStatus>(pShader->asyncStatus.load(std::memory_order_acquire));
+		}
+		*outStatus = status;
+		if (status == ShaderCompileStatus::Failed) {
+			auto& log = pShader->asyncLog;
+			size_t length = 0;
+			if (compileErrorLog != nullptr && compileErrorMaxLength > 0) {
+				length = std::min(log.size(), compileErrorMaxLength - 1);
+				memcpy(compileErrorLog, log.data(), length);
+				compileErrorLog[length] = '\0';
+			}
+			if (compileErrorLength != nullptr)
+				*compileErrorLength = length;
+		}
+		return ErrorCode::RES_NO_ERROR;
+	}
+
 	ErrorCode RES_RENDERER_API GetUniformLocation(Shader shader, const char* name, int* outLocation) {
 		auto pShader = static_cast<ShaderImpl*>(shader);
+		auto location = pShader->uniforms.Find(name);
+		if (location >= 0) {
+			*outLocation = location;
+			return ErrorCode::RES_NO_ERROR;
+		}
+		//Array elements, or not linked yet.
 		try
 		{
-			*outLocation = pShader->GetUniformLocation(name);
+			*outLocation = DispatchSync([=] { return pShader->GetUniformLocation(name); });
 			return ErrorCode::RES_NO_ERROR;
 		}
 		catch (GLenum)
@@ -267,16 +1567,315 @@ namespace ResRenderer {
 
 	ErrorCode RES_RENDERER_API SetUniformVec(Shader shader, int location, Vector4 v) {
 		auto pShader = static_cast<ShaderImpl*>(shader);
-		pShader->Use();
-		glUniform4fv(location, 1, (GLfloat*)&v);
+		Dispatch([=] {
+			try
+			{
+				pShader->Use();
+				glUniform4fv(location, 1, (const GLfloat*)&v);
+			}
+			catch (GLenum)
+			{
+			}
+		});
 		return ErrorCode::RES_NO_ERROR;
 	}
 
+	ErrorCode RES_RENDERER_API GetUniformLocationById(Shader shader, UniformId id, int* outLocation) {
+		*outLocation = static_cast<ShaderImpl*>(shader)->uniforms.Find(id);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API SetUniformVecById(Shader shader, UniformId id, Vector4 v) {
+		auto location = static_cast<ShaderImpl*>(shader)->uniforms.Find(id);
+		if (location < 0)
+			return ErrorCode::RES_NO_ERROR;
+		return SetUniformVec(shader, location, v);
+	}
+
 	ErrorCode RES_RENDERER_API UseShader(Shader shader) {
 		auto pShader = static_cast<ShaderImpl*>(shader);
+		return DispatchChecked("UseShader", [pShader] {
+			try
+			{
+				pShader->Use();
+				return ErrorCode::RES_NO_ERROR;
+			}
+			catch (GLenum)
+			{
+				return ErrorCode::INTERNAL_ERROR;
+			}
+		});
+	}
+
+
+	ErrorCode RES_RENDERER_API DestroyShader(Shader shader) {
+		auto pShader = static_cast<ShaderImpl*>(shader);
+		UnwatchGLShaderFile(shader);
+		Dispatch([pShader] { delete pShader; });
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API SetUniformBlockSlot(Shader shader, const char* blockName, int slot) {
+		if (slot < 0 || slot >= UNIFORM_BUFFER_MAX_SLOT_COUNT)
+			return ErrorCode::INTERNAL_ERROR;
+		auto pShader = static_cast<ShaderImpl*>(shader);
+		try
+		{
+			auto found = DispatchSync([=] { return pShader->SetUniformBlockSlot(blockName, slot); });
+			return found ? ErrorCode::RES_NO_ERROR : ErrorCode::INTERNAL_ERROR;
+		}
+		catch (GLenum)
+		{
+			return ErrorCode::INTERNAL_ERROR;
+		}
+	}
+
+	//Shader hot reload. Everything here is API thread only, except staging and done, written by the compile job.
+	//Compiles run on a compile worker. Without one, KHR_parallel_shader_compile is started and polled on the render context.
+	struct ShaderReload {
+		ShaderImpl* target;
+		std::string path;
+		int watchId;
+		bool parallel = false;
+		bool compiling = false;
+		bool dirty = false;		//Changed again while compiling.
+		ShaderImpl* staging = nullptr;
+		std::atomic<bool> done{ false };
+		//Set while a poll of a parallel compile is queued.
+		std::atomic<bool> pollQueued{ false };
+	};
+	static FileWatcher* shaderWatcher = nullptr;
+	static std::map<ShaderImpl*, std::shared_ptr<ShaderReload>> shaderReloads;
+	//Unwatched while compiling, kept until the compile is done so staging could be deleted.
+	static std::vector<std::shared_ptr<ShaderReload>> retiredReloads;
+
+	static void StartReload(const std::shared_ptr<ShaderReload>& reload) {
+		reload->compiling = true;
+		reload->dirty = false;
+		if (reload->parallel) {
+			//File is read here, the render context only starts the compile. done is set by PollParallelReload.
+			std::ifstream file(reload->path);
+			std::ostringstream source;
+			source << file.rdbuf();
+			auto copy = std::make_shared<std::string>(source.str());
+			Dispatch([reload, copy] {
+				ShaderImpl* staging = nullptr;
+				try
+				{
+					staging = new ShaderImpl();
+				}
+				catch (GLenum)
+				{
+				}
+				if (staging != nullptr) {
+					UseParallelCompileThreads();
+					staging->asyncStatus.store(static_cast<int>(ShaderCompileStatus::Compiling));
+					staging->BeginParallel(copy->c_str());
+				}
+				reload->staging = staging;
+			});
+			return;
+		}
+		auto dispatched = DispatchToCompileWorker([reload] {
+			std::ifstream file(reload->path);
+			std::ostringstream source;
+			source << file.rdbuf();
+			ShaderImpl* staging = nullptr;
+			try
+			{
+				staging = new ShaderImpl();
+			}
+			catch (GLenum)
+			{
+			}
+			if (staging != nullptr)
+				staging->CompileOnWorker(source.str().c_str());
+			reload->staging = staging;
+			reload->done.store(true, std::memory_order_release);
+		});
+		//Workers outlive every watch, this is a failed reload just in case.
+		if (!dispatched)
+			reload->done.store(true, std::memory_order_release);
+	}
+
+	//One poll in flight at a time. staging isn't touched after done is set, API thread takes it over then.
+	static void PollParallelReload(const std::shared_ptr<ShaderReload>& reload) {
+		if (reload->pollQueued.exchange(true, std::memory_order_acq_rel))
+			return;
+		Dispatch([reload] {
+			auto staging = reload->staging;
+			if (staging != nullptr)
+				staging->PollParallel();
+			if (staging == nullptr || staging->asyncStatus.load(std::memory_order_acquire) != static_cast<int>(ShaderCompileStatus::Compiling))
+				reload->done.store(true, std::memory_order_release);
+			reload->pollQueued.store(false, std::memory_order_release);
+		});
+	}
+
+	//True if the target got a new program.
+	static bool FinishReload(ShaderReload& reload) {
+		reload.compiling = false;
+		reload.done.store(false);
+		auto staging = reload.staging;
+		reload.staging = nullptr;
+		if (reload.target != nullptr && staging != nullptr && staging->asyncStatus.load(std::memory_order_acquire) == static_cast<int>(ShaderCompileStatus::Succeeded)) {
+			auto target = reload.target;
+			//Uniform calls made after this are dispatched after the swap, so ids and locations stay consistent.
+			target->uniforms = std::move(staging->uniforms);
+			Dispatch([target, staging] { target->AdoptProgram(staging); });
+			return true;
+		}
+		if (reload.target != nullptr)
+			std::cerr << "Reloading " << reload.path << " failed, old program is kept." << std::endl << (staging != nullptr ? staging->asyncLog : "") << std::endl;
+		if (staging != nullptr)
+			Dispatch([staging] { delete staging; });
+		return false;
+	}
+
+	ErrorCode RES_RENDERER_API WatchGLShaderFile(Shader shader, const char* path) {
+		if (shader == nullptr || path == nullptr)
+			return ErrorCode::INTERNAL_ERROR;
+		//Reloads never compile on the frame loop, there has to be a background context or parallel compile.
+		bool parallel = !HasCompileWorkers();
+		if (parallel && !ParallelCompileSupported())
+			return ErrorCode::INTERNAL_ERROR;
+		if (shaderWatcher == nullptr)
+			shaderWatcher = new FileWatcher();
+		auto watchId = shaderWatcher->Add(path);
+		if (watchId < 0)
+			return ErrorCode::INTERNAL_ERROR;
+		UnwatchGLShaderFile(shader);
+		auto reload = std::make_shared<ShaderReload>();
+		reload->parallel = parallel;
+		reload->target = static_cast<ShaderImpl*>(shader);
+		reload->path = path;
+		reload->watchId = watchId;
+		shaderReloads[reload->target] = reload;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API UnwatchGLShaderFile(Shader shader) {
+		auto ite = shaderReloads.find(static_cast<ShaderImpl*>(shader));
+		if (ite == shaderReloads.end())
+			return ErrorCode::RES_NO_ERROR;
+		auto reload = ite->second;
+		shaderReloads.erase(ite);
+		shaderWatcher->Remove(reload->watchId);
+		reload->target = nullptr;
+		if (reload->compiling)
+			retiredReloads.push_back(reload);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	int RES_RENDERER_API PollGLShaderReloads() {
+		if (shaderWatcher == nullptr)
+			return 0;
+		for (auto id : shaderWatcher->Poll())
+		{
+			for (auto& reload : shaderReloads)
+			{
+				if (reload.second->watchId != id)
+					continue;
+				if (reload.second->compiling)
+					reload.second->dirty = true;
+				else
+					StartReload(reload.second);
+			}
+		}
+
+		int reloaded = 0;
+		for (auto& reload : shaderReloads)
+		{
+			if (!reload.second->compiling)
+				continue;
+			if (!reload.second->done.load(std::memory_order_acquire)) {
+				if (reload.second->parallel)
+					PollParallelReload(reload.second);
+				continue;
+			}
+			if (FinishReload(*reload.second))
+				reloaded++;
+			if (reload.second->dirty)
+				StartReload(reload.second);
+		}
+		for (size_t i = 0; i < retiredReloads.size();)
+		{
+			if (retiredReloads[i]->done.load(std::memory_order_acquire)) {
+				FinishReload(*retiredReloads[i]);
+				retiredReloads.erase(retiredReloads.begin() + i);
+			}
+			else {
+				if (retiredReloads[i]->parallel)
+					PollParallelReload(retiredReloads[i]);
+				i++;
+			}
+		}
+		return reloaded;
+	}
+
+	void ReleaseShaderReloads() {
+		//Compile workers are stopped already, every started compile is done.
+		for (auto& reload : shaderReloads)
+		{
+			reload.second->target = nullptr;
+			if (reload.second->compiling)
+				retiredReloads.push_back(reload.second);
+		}
+		shaderReloads.clear();
+		for (auto& reload : retiredReloads)
+		{
+			//Parallel compiles finish on the render context, waited for here since nothing polls them any more.
+			while (!reload->done.load(std::memory_order_acquire))
+			{
+				PollParallelReload(reload);
+				DispatchSync([] { return 0; });
+			}
+			FinishReload(*reload);
+		}
+		retiredReloads.clear();
+		delete shaderWatcher;
+		shaderWatcher = nullptr;
+	}
+
+	class UniformBufferImpl {
+	public:
+		explicit UniformBufferImpl(size_t _size) : size(_size) {
+			UBO = 0;
+			CHECKED(glGenBuffers(1, &UBO));
+			GetGLState().BindUniformBuffer(UBO);
+			CHECKED(glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW));
+		}
+
+		void Update(const void* data, size_t bytes, size_t offset) {
+			GetGLState().BindUniformBuffer(UBO);
+			//Whole buffer rewrites orphan old storage, so updating between draws doesn't wait for them.
+			if (offset == 0 && bytes == size) {
+				CHECKED(glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW));
+			}
+			CHECKED(glBufferSubData(GL_UNIFORM_BUFFER, offset, bytes, data));
+		}
+
+		void Bind(int slot) {
+			GetGLState().BindUniformBufferSlot(slot, UBO);
+		}
+
+		~UniformBufferImpl() {
+			GetGLState().OnDeleteBuffer(UBO);
+			glDeleteBuffers(1, &UBO);
+		}
+
+		//Never changes, readable on API thread.
+		const size_t size;
+	private:
+		GLuint UBO;
+	};
+
+	ErrorCode RES_RENDERER_API CreateUniformBuffer(size_t size, UniformBuffer* outBuffer) {
+		if (size == 0)
+			return ErrorCode::BUFFER_TOO_SMALL;
 		try
 		{
-			pShader->Use();
+			*outBuffer = static_cast<UniformBuffer>(DispatchSync([size] { return new UniformBufferImpl(size); }));
 			return ErrorCode::RES_NO_ERROR;
 		}
 		catch (GLenum)
@@ -285,17 +1884,239 @@ namespace ResRenderer {
 		}
 	}
 
+	ErrorCode RES_RENDERER_API UpdateUniformBuffer(UniformBuffer buffer, const void* data, size_t size, size_t offset) {
+		auto pBuffer = static_cast<UniformBufferImpl*>(buffer);
+		if (offset > pBuffer->size || size > pBuffer->size - offset)
+			return ErrorCode::BUFFER_TOO_SMALL;
+		std::shared_ptr<std::vector<unsigned char>> copy;
+		if (GetRenderThread() != nullptr) {
+			auto bytes = static_cast<const unsigned char*>(data);
+			copy = std::make_shared<std::vector<unsigned char>>(bytes, bytes + size);
+			data = copy->data();
+		}
+		return DispatchChecked("UpdateUniformBuffer", [pBuffer, data, size, offset, copy] {
+			try
+			{
+				pBuffer->Update(data, size, offset);
+				return ErrorCode::RES_NO_ERROR;
+			}
+			catch (GLenum)
+			{
+				return ErrorCode::INTERNAL_ERROR;
+			}
+		});
+	}
 
-	ErrorCode RES_RENDERER_API DestroyShader(Shader shader) {
-		auto pShader = static_cast<ShaderImpl*>(shader);
-		delete pShader;
+	ErrorCode RES_RENDERER_API BindUniformBuffer(UniformBuffer buffer, int slot) {
+		if (slot < 0 || slot >= UNIFORM_BUFFER_MAX_SLOT_COUNT)
+			return ErrorCode::INTERNAL_ERROR;
+		auto pBuffer = static_cast<UniformBufferImpl*>(buffer);
+		return DispatchChecked("BindUniformBuffer", [pBuffer, slot] {
+			try
+			{
+				pBuffer->Bind(slot);
+				return ErrorCode::RES_NO_ERROR;
+			}
+			catch (GLenum)
+			{
+				return ErrorCode::INTERNAL_ERROR;
+			}
+		});
+	}
+
+	ErrorCode RES_RENDERER_API DestroyUniformBuffer(UniformBuffer buffer) {
+		auto pBuffer = static_cast<UniformBufferImpl*>(buffer);
+		Dispatch([pBuffer] { delete pBuffer; });
 		return ErrorCode::RES_NO_ERROR;
 	}
 	
 
+	class FrameBufferImpl {
+	public:
+		FrameBufferImpl(const FrameBufferDescriptor& descriptor) {
+			FBO = 0; colorTexture = 0; depthBuffer = 0;
+			CHECKED(glGenFramebuffers(1, &FBO));
+			CHECKED(glGenTextures(1, &colorTexture));
+			CHECKED(glGenRenderbuffers(1, &depthBuffer));
+
+			GLint internalFormat = descriptor.colorBufferFormat == RGBAFloat ? GL_RGBA32F : GL_RGBA8;
+			GLenum type = descriptor.colorBufferFormat == RGBAFloat ? GL_FLOAT : GL_UNSIGNED_BYTE;
+			CHECKED(glBindTexture(GL_TEXTURE_2D, colorTexture));
+			CHECKED(glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, descriptor.width, descriptor.height, 0, GL_RGBA, type, nullptr));
+			CHECKED(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+			CHECKED(glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer));
+			CHECKED(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, descriptor.width, descriptor.height));
+
+			auto& state = GetGLState();
+			state.BindFrameBuffer(FBO);
+			CHECKED(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0));
+			CHECKED(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer));
+			auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+			state.BindFrameBuffer(0);
+			if (status != GL_FRAMEBUFFER_COMPLETE) {
+				std::cerr << "Framebuffer incomplete: " << status << std::endl;
+				throw static_cast<GLenum>(GL_INVALID_FRAMEBUFFER_OPERATION);
+			}
+		}
+
+		~FrameBufferImpl() {
+			GetGLState().OnDeleteFrameBuffer(FBO);
+			glDeleteFramebuffers(1, &FBO);
+			glDeleteTextures(1, &colorTexture);
+			glDeleteRenderbuffers(1, &depthBuffer);
+		}
+
+		void Bind() {
+			GetGLState().BindFrameBuffer(FBO);
+		}
+
+	private:
+		GLuint FBO, colorTexture, depthBuffer;
+	};
+
+	FrameBuffer RES_RENDERER_API CreateFrameBuffer(FrameBufferDescriptor& descriptor) {
+		try
+		{
+			auto desc = descriptor;
+			return static_cast<FrameBuffer>(DispatchSync([desc] { return new FrameBufferImpl(desc); }));
+		}
+		catch (GLenum)
+		{
+			return nullptr;
+		}
+	}
+
+	void RES_RENDERER_API DestroyFrameBuffer(FrameBuffer frameBuffer) {
+		auto pFrameBuffer = static_cast<FrameBufferImpl*>(frameBuffer);
+		Dispatch([pFrameBuffer] { delete pFrameBuffer; });
+	}
+
+	void RES_RENDERER_API SetRenderTarget(FrameBuffer frameBuffer) {
+		auto pFrameBuffer = static_cast<FrameBufferImpl*>(frameBuffer);
+		Dispatch([pFrameBuffer] {
+			try
+			{
+				if (pFrameBuffer != nullptr)
+					pFrameBuffer->Bind();
+				else
+					GetGLState().BindFrameBuffer(0);
+			}
+			catch (GLenum)
+			{
+			}
+		});
+	}
+
 	ErrorCode RES_RENDERER_API DrawMesh(Mesh mesh) {
 
 		auto pMesh = static_cast<MeshImpl*>(mesh);
-		return pMesh->Draw();
+		return DispatchChecked("DrawMesh", [pMesh] { return pMesh->Draw(); });
+	}
+
+	ErrorCode RES_RENDERER_API DrawMeshInstanced(Mesh mesh, InstanceBuffer instances, int instanceCount) {
+		auto pMesh = static_cast<MeshImpl*>(mesh);
+		auto pInstances = static_cast<InstanceBufferImpl*>(instances);
+		if (pInstances == nullptr || instanceCount < 0)
+			return ErrorCode::INTERNAL_ERROR;
+		if (instanceCount > pInstances->instanceCount)
+			return ErrorCode::BUFFER_TOO_SMALL;
+		if (instanceCount == 0)
+			return ErrorCode::RES_NO_ERROR;
+		return DispatchChecked("DrawMeshInstanced", [=] { return pMesh->DrawInstanced(pInstances, instanceCount); });
+	}
+
+	ErrorCode RES_RENDERER_API DrawMeshBatch(MeshBatch batch, const int* subMeshes, int count, InstanceBuffer instances) {
+		auto pBatch = static_cast<MeshBatchImpl*>(batch);
+		auto pInstances = static_cast<InstanceBufferImpl*>(instances);
+		if (pBatch == nullptr || count < 0 || (count > 0 && subMeshes == nullptr))
+			return ErrorCode::INTERNAL_ERROR;
+		if (pInstances != nullptr && count > pInstances->instanceCount)
+			return ErrorCode::BUFFER_TOO_SMALL;
+		for (int i = 0; i < count; i++)
+		{
+			if (subMeshes[i] < 0 || subMeshes[i] >= pBatch->apiSubMeshCount)
+				return ErrorCode::MESH_NOT_CREATED;
+		}
+		if (count == 0)
+			return ErrorCode::RES_NO_ERROR;
+
+		if (GetRenderThread() == nullptr)
+			return pBatch->Draw(subMeshes, count, pInstances);
+		auto ids = std::make_shared<std::vector<int>>(subMeshes, subMeshes + count);
+		return DispatchChecked("DrawMeshBatch", [pBatch, ids, pInstances] {
+			return pBatch->Draw(ids->data(), static_cast<int>(ids->size()), pInstances);
+		});
+	}
+
+	ErrorCode RES_RENDERER_API DrawMeshLOD(Mesh mesh, float projectedSize, float maxPixelError) {
+		auto pMesh = static_cast<MeshImpl*>(mesh);
+		return DispatchChecked("DrawMeshLOD", [pMesh, projectedSize, maxPixelError] { return pMesh->DrawLOD(projectedSize, maxPixelError); });
+	}
+
+	ErrorCode RES_RENDERER_API DrawMeshRanges(Mesh mesh, const IndexRange* ranges, int count) {
+		auto pMesh = static_cast<MeshImpl*>(mesh);
+		if (pMesh == nullptr || count < 0 || (count > 0 && ranges == nullptr))
+			return ErrorCode::INTERNAL_ERROR;
+		if (count == 0)
+			return ErrorCode::RES_NO_ERROR;
+
+		if (GetRenderThread() == nullptr)
+			return pMesh->DrawRanges(ranges, count);
+		auto copy = std::make_shared<std::vector<IndexRange>>(ranges, ranges + count);
+		return DispatchChecked("DrawMeshRanges", [pMesh, copy] {
+			return pMesh->DrawRanges(copy->data(), static_cast<int>(copy->size()));
+		});
+	}
+
+	static ErrorCode ExecuteRecordedCommand(const RecordedCommand& command) {
+		try
+		{
+			switch (command.type)
+			{
+			case RecordedCommandType::UseShader:
+				static_cast<ShaderImpl*>(command.object)->Use();
+				return ErrorCode::RES_NO_ERROR;
+			case RecordedCommandType::SetUniformVec:
+				static_cast<ShaderImpl*>(command.object)->Use();
+				glUniform4fv(command.location, 1, command.v);
+				return ErrorCode::RES_NO_ERROR;
+			case RecordedCommandType::DrawMesh:
+				return static_cast<MeshImpl*>(command.object)->Draw();
+			}
+		}
+		catch (GLenum)
+		{
+		}
+		return ErrorCode::INTERNAL_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API SubmitCommandLists(const CommandList* lists, int count) {
+		auto result = ErrorCode::RES_NO_ERROR;
+		auto execute = [&result](const RecordedCommand& command) {
+			auto t = ExecuteRecordedCommand(command);
+			if (result == ErrorCode::RES_NO_ERROR)
+				result = t;
+		};
+
+		if (GetRenderThread() == nullptr) {
+			for (int i = 0; i < count; i++)
+				static_cast<const CommandListImpl*>(lists[i])->ForEach(execute);
+			return result;
+		}
+
+		//Lists could be reset right after return, render thread gets a copy.
+		auto commands = std::make_shared<std::vector<RecordedCommand>>();
+		for (int i = 0; i < count; i++)
+			static_cast<const CommandListImpl*>(lists[i])->AppendTo(*commands);
+		return DispatchChecked("SubmitCommandLists", [commands] {
+			auto result = ErrorCode::RES_NO_ERROR;
+			for (auto& command : *commands)
+			{
+				auto t = ExecuteRecordedCommand(command);
+				if (result == ErrorCode::RES_NO_ERROR)
+					result = t;
+			}
+			return result;
+		});
 	}
 }
\ No newline at end of file
@@ -1,15 +1,39 @@
 #pragma once
+#ifdef _WIN32
 #include <windows.h>
-#include <GL\glew.h>
+#endif
+#include <GL/glew.h>
 #include <ResRenderer.hpp>
+#include <ResRendererOpenGL.hpp>
+#include <ResRenderThread.hpp>
 //This header places common used functions.
 //Not all classes are required to be here.
+#include <atomic>
 #include <iostream>
+#include <cstring>
+
+//Highest validation level compiled in, see GLValidationLevel.
+#ifndef RES_GL_VALIDATION
+#ifdef NDEBUG
+#define RES_GL_VALIDATION 0
+#else
+#define RES_GL_VALIDATION 2
+#endif
+#endif
 
 namespace ResRenderer {
 
+	//Runtime level, never above RES_GL_VALIDATION.
+	extern std::atomic<int> glValidationLevel;
+
+#if RES_GL_VALIDATION >= 2
 #define CHECKED(x) x; \
-					CheckOpenGLErrorAndThrow(__FILE__, __LINE__, __FUNCTION__);\
+					if (glValidationLevel.load(std::memory_order_relaxed) >= 2) CheckOpenGLErrorAndThrow(__FILE__, __LINE__, __FUNCTION__);\
+
+#else
+//No glGetError and nothing throws.
+#define CHECKED(x) x;
+#endif
 
 	inline void CheckOpenGLErrorAndThrow(const char* file, int line, const char* func) {
 		GLenum err;
@@ -18,4 +42,215 @@ namespace ResRenderer {
 			throw err;
 		}
 	}
+
+	//Shadows bind state of current context, so redundant binds never reach the driver.
+	//Only used on the thread owning the context. Any code binding these objects must go through it.
+	class GLStateCache {
+	public:
+		GLStateCache() {
+			Invalidate();
+		}
+
+		//Called when another context becomes current, nothing is known about it.
+		void Invalidate() {
+			program = vertexArray = arrayBuffer = elementBuffer = frameBuffer = uniformBuffer = Unknown;
+			for (auto& slot : uniformSlots)
+				slot = Unknown;
+			viewportValid = clearColorValid = false;
+		}
+
+		void UseProgram(GLuint _program) {
+			if (Elide(program == _program, stats.program))
+				return;
+			CHECKED(glUseProgram(_program));
+			program = _program;
+		}
+
+		void BindVertexArray(GLuint _vertexArray) {
+			if (Elide(vertexArray == _vertexArray, stats.vertexArray))
+				return;
+			CHECKED(glBindVertexArray(_vertexArray));
+			vertexArray = _vertexArray;
+			//Element buffer binding is part of vertex array state.
+			elementBuffer = Unknown;
+		}
+
+		void BindArrayBuffer(GLuint buffer) {
+			if (Elide(arrayBuffer == buffer, stats.arrayBuffer))
+				return;
+			CHECKED(glBindBuffer(GL_ARRAY_BUFFER, buffer));
+			arrayBuffer = buffer;
+		}
+
+		void BindElementBuffer(GLuint buffer) {
+			if (Elide(elementBuffer == buffer, stats.elementBuffer))
+				return;
+			CHECKED(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer));
+			elementBuffer = buffer;
+		}
+
+		void BindUniformBuffer(GLuint buffer) {
+			if (Elide(uniformBuffer == buffer, stats.uniformBuffer))
+				return;
+			CHECKED(glBindBuffer(GL_UNIFORM_BUFFER, buffer));
+			uniformBuffer = buffer;
+		}
+
+		void BindUniformBufferSlot(int slot, GLuint buffer) {
+			if (Elide(uniformSlots[slot] == buffer, stats.uniformBuffer))
+				return;
+			CHECKED(glBindBufferBase(GL_UNIFORM_BUFFER, slot, buffer));
+			uniformSlots[slot] = buffer;
+			//Indexed binding sets the generic one as well.
+			uniformBuffer = buffer;
+		}
+
+		void BindFrameBuffer(GLuint _frameBuffer) {
+			if (Elide(frameBuffer == _frameBuffer, stats.frameBuffer))
+				return;
+			CHECKED(glBindFramebuffer(GL_FRAMEBUFFER, _frameBuffer));
+			frameBuffer = _frameBuffer;
+		}
+
+		void Viewport(int x, int y, int width, int height) {
+			GLint t[4] = { x, y, width, height };
+			if (Elide(viewportValid && memcmp(viewport, t, sizeof(t)) == 0, stats.viewport))
+				return;
+			CHECKED(glViewport(x, y, width, height));
+			memcpy(viewport, t, sizeof(t));
+			viewportValid = true;
+		}
+
+		void ClearColor(const Color& color) {
+			GLfloat t[4] = { color.r, color.g, color.b, color.a };
+			if (Elide(clearColorValid && memcmp(clearColor, t, sizeof(t)) == 0, stats.clearColor))
+				return;
+			CHECKED(glClearColor(t[0], t[1], t[2], t[3]));
+			memcpy(clearColor, t, sizeof(t));
+			clearColorValid = true;
+		}
+
+		bool IsProgramBound(GLuint _program) const {
+			return program == _program;
+		}
+
+		//Deleting a bound object resets the binding to 0, and names get reused.
+		void OnDeleteProgram(GLuint _program) {
+			if (program == _program)
+				program = 0;
+		}
+
+		void OnDeleteVertexArray(GLuint _vertexArray) {
+			if (vertexArray == _vertexArray) {
+				vertexArray = 0;
+				elementBuffer = Unknown;
+			}
+		}
+
+		void OnDeleteBuffer(GLuint buffer) {
+			if (arrayBuffer == buffer)
+				arrayBuffer = 0;
+			if (elementBuffer == buffer)
+				elementBuffer = 0;
+			if (uniformBuffer == buffer)
+				uniformBuffer = 0;
+			for (auto& slot : uniformSlots)
+			{
+				if (slot == buffer)
+					slot = 0;
+			}
+		}
+
+		void OnDeleteFrameBuffer(GLuint _frameBuffer) {
+			if (frameBuffer == _frameBuffer)
+				frameBuffer = 0;
+		}
+
+		GLStateCacheStats GetStats() const {
+			auto t = stats;
+			const GLStateCounter* counters[] = { &t.program, &t.vertexArray, &t.arrayBuffer, &t.elementBuffer, &t.frameBuffer, &t.viewport, &t.clearColor, &t.uniformBuffer };
+			for (auto counter : counters)
+			{
+				t.total.issued += counter->issued;
+				t.total.elided += counter->elided;
+			}
+			return t;
+		}
+
+		void ResetStats() {
+			stats = GLStateCacheStats();
+		}
+
+	private:
+		static const GLuint Unknown = ~0u;
+
+		static bool Elide(bool same, GLStateCounter& counter) {
+			if (same)
+				counter.elided++;
+			else
+				counter.issued++;
+			return same;
+		}
+
+		GLuint program, vertexArray, arrayBuffer, elementBuffer, frameBuffer, uniformBuffer;
+		GLuint uniformSlots[UNIFORM_BUFFER_MAX_SLOT_COUNT];
+		GLint viewport[4];
+		GLfloat clearColor[4];
+		bool viewportValid, clearColorValid;
+		GLStateCacheStats stats;
+	};
+
+	//State cache of the context used for rendering.
+	GLStateCache& GetGLState();
+
+	//Dynamic mesh streaming, called on the thread owning the context.
+	void EndStreamingFrame();
+	void ReleaseStreamingBuffer();
+	GLStreamingStats GetStreamingStats();
+	void ResetStreamingStats();
+
+	//Shader hot reload, called by Terminate after compile workers stop and before the render thread does.
+	void ReleaseShaderReloads();
+
+	//Runs job on a thread owning a context that shares objects with the render context.
+	//Workers are started by the first call, which must be on API thread. False if there's no such context.
+	bool DispatchToCompileWorker(std::function<void()> job);
+	//Starts workers like DispatchToCompileWorker, API thread only. False if there's no such context.
+	bool HasCompileWorkers();
+
+	//Non-null after the first window is created, if EnableRenderThread was called.
+	RenderThread* GetRenderThread();
+
+	//Runs func on the render thread if there's one, otherwise right now.
+	template<typename F>
+	void Dispatch(F func) {
+		auto renderThread = GetRenderThread();
+		if (renderThread != nullptr)
+			renderThread->Enqueue(std::move(func));
+		else
+			func();
+	}
+
+	//Same as Dispatch, but func returns ErrorCode. In async mode it's reported instead of returned.
+	template<typename F>
+	ErrorCode DispatchChecked(const char* name, F func) {
+		auto renderThread = GetRenderThread();
+		if (renderThread == nullptr)
+			return func();
+		renderThread->Enqueue([name, func] {
+			auto result = func();
+			if (result != ErrorCode::RES_NO_ERROR)
+				std::cerr << name << " failed on render thread, error: " << static_cast<int>(result) << std::endl;
+		});
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	//Runs func on the render thread and waits for the result, exceptions are rethrown on calling thread.
+	template<typename F>
+	auto DispatchSync(F func) -> decltype(func()) {
+		auto renderThread = GetRenderThread();
+		if (renderThread != nullptr)
+			return renderThread->ExecuteSync(std::move(func));
+		return func();
+	}
 }
\ No newline at end of file
@@ -1,28 +1,158 @@
 #include <ResRenderer.hpp>
+#include <ResRendererImpl_Ogl.hpp>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <algorithm>
 #include <map>
 #include <iostream>
+#include <stdexcept>
+#include <vector>
 
 namespace ResRenderer {
 	static void GLFWOnFrameSizeChanged(GLFWwindow* _window, int width, int height);
 	bool contextInitialized = false;
+
+	//Async rendering.
+	static const size_t RenderThreadRingBytes = 4 << 20;
+	static int requestedFramesInFlight = 0;
+	static RenderThread* renderThread = nullptr;
+
+	RenderThread* GetRenderThread() {
+		return renderThread;
+	}
+
+	//Compile workers, each owning a hidden window with a context sharing objects with the first window's.
+	static const int MaxCompileWorkers = 4;
+	static const size_t CompileWorkerRingBytes = 256 << 10;
+	struct CompileWorker {
+		GLFWwindow* context;
+		RenderThread* thread;
+	};
+	static std::vector<CompileWorker> compileWorkers;
+	static GLFWwindow* shareContext = nullptr;
+	static bool compileWorkersFailed = false;
+	static size_t nextCompileWorker = 0;
+
+	static void StartCompileWorkers() {
+		if (shareContext == nullptr) {
+			compileWorkersFailed = true;
+			return;
+		}
+		int count = std::max(1, std::min(MaxCompileWorkers, static_cast<int>(std::thread::hardware_concurrency()) / 2));
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		for (int i = 0; i < count; i++)
+		{
+			auto context = glfwCreateWindow(1, 1, "", NULL, shareContext);
+			if (context == nullptr)
+				break;
+			auto thread = new RenderThread(1, CompileWorkerRingBytes);
+			thread->Start([context] { glfwMakeContextCurrent(context); });
+			compileWorkers.push_back({ context, thread });
+		}
+#ifndef RES_HEADLESS
+		glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+#endif
+		compileWorkersFailed = compileWorkers.empty();
+	}
+
+	static void StopCompileWorkers() {
+		for (auto& worker : compileWorkers)
+		{
+			worker.thread->Stop();
+			delete worker.thread;
+			glfwDestroyWindow(worker.context);
+		}
+		compileWorkers.clear();
+		compileWorkersFailed = false;
+		nextCompileWorker = 0;
+	}
+
+	bool HasCompileWorkers() {
+		if (compileWorkers.empty() && !compileWorkersFailed)
+			StartCompileWorkers();
+		return !compileWorkers.empty();
+	}
+
+	bool DispatchToCompileWorker(std::function<void()> job) {
+		if (!HasCompileWorkers())
+			return false;
+		compileWorkers[nextCompileWorker++ % compileWorkers.size()].thread->Enqueue(std::move(job));
+		return true;
+	}
+
+	//Windows are created one by one, state of the latest context is shadowed.
+	static GLStateCache glState;
+
+	GLStateCache& GetGLState() {
+		return glState;
+	}
+
+	static void MakeContextCurrent(GLFWwindow* context) {
+		glfwMakeContextCurrent(context);
+		glState.Invalidate();
+	}
+
+	std::atomic<int> glValidationLevel(RES_GL_VALIDATION);
+
+	static void GLAPIENTRY OnGLDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam) {
+		(void)source; (void)id; (void)length; (void)userParam;
+		std::cerr << "OpenGL " << (type == GL_DEBUG_TYPE_ERROR ? "error" : "message") << "(severity " << severity << "): " << message << std::endl;
+	}
+
+	//Applies DebugOutput level to current context.
+	static void ConfigureDebugOutput() {
+		if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug)
+			return;
+		if (glValidationLevel.load() >= static_cast<int>(GLValidationLevel::DebugOutput)) {
+			glEnable(GL_DEBUG_OUTPUT);
+			glDebugMessageCallback(OnGLDebugMessage, nullptr);
+			//Notifications are too chatty, e.g. buffer placement info on every upload.
+			glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+		}
+		else {
+			glDisable(GL_DEBUG_OUTPUT);
+		}
+	}
+
 	class WindowImpl {
 	public:
 		WindowImpl(int width, int height, const char* title) {
+			glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, glValidationLevel.load() >= static_cast<int>(GLValidationLevel::DebugOutput) ? GLFW_TRUE : GLFW_FALSE);
 			window = glfwCreateWindow(width, height, title, NULL, NULL);
-			glfwMakeContextCurrent(window);
-            if (!contextInitialized){
-                contextInitialized = true;
-                glewInit();
-            }
+			if (window == nullptr)
+				throw std::runtime_error("glfwCreateWindow failed");
+			if (shareContext == nullptr)
+				shareContext = window;
 			mMap.insert(std::pair<GLFWwindow*, WindowImpl*>(window, this));
 			glfwSetFramebufferSizeCallback(window, GLFWOnFrameSizeChanged);
+
+			auto context = window;
+			auto setupContext = [context] {
+				MakeContextCurrent(context);
+				if (!contextInitialized) {
+					contextInitialized = true;
+					glewInit();
+				}
+				ConfigureDebugOutput();
+			};
+			if (requestedFramesInFlight > 0) {
+				//The context belongs to render thread, which also owns glState. API thread never makes it current.
+				if (renderThread == nullptr) {
+					renderThread = new RenderThread(requestedFramesInFlight, RenderThreadRingBytes);
+					renderThread->Start([] {});
+				}
+				renderThread->ExecuteSync(setupContext);
+			}
+			else {
+				setupContext();
+			}
 		}
 
 		~WindowImpl()
 		{
 			mMap.erase(this->window);
+			if (shareContext == this->window)
+				shareContext = nullptr;
 			glfwDestroyWindow(this->window);
 		}
 
@@ -31,22 +161,63 @@ namespace ResRenderer {
 		}
 
 		bool ShouldCloseWindow() {
+			if (frameLimit > 0 && frameCount >= frameLimit)
+				return true;
 			return glfwWindowShouldClose(window);
 		}
 
+		//Called on render thread in async mode.
 		void Swapbuffer() {
 			glfwSwapBuffers(window);
 		}
+
+		void CountFrame() {
+			frameCount++;
+		}
+
+		void SetFrameLimit(int _frameLimit) {
+			frameLimit = _frameLimit;
+		}
+
+		ErrorCode ReadPixels(void* outPixels, size_t bufferSize) {
+			int width, height;
+			glfwGetFramebufferSize(window, &width, &height);
+			if (bufferSize < static_cast<size_t>(width) * height * 4)
+				return ErrorCode::BUFFER_TOO_SMALL;
+			auto context = window;
+			return DispatchSync([=] {
+				//Borrow the render thread's context, framebuffer binding and pack alignment, all go back to what they were.
+				auto previousContext = glfwGetCurrentContext();
+				if (previousContext != context)
+					MakeContextCurrent(context);
+				GLint previousFrameBuffer = 0;
+				glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFrameBuffer);
+				GLint previousPackAlignment = 4;
+				glGetIntegerv(GL_PACK_ALIGNMENT, &previousPackAlignment);
+				glState.BindFrameBuffer(0);
+				glPixelStorei(GL_PACK_ALIGNMENT, 1);
+				//Errors left by earlier calls aren't ours, unchecked builds never read them. Bounded, a lost context never runs out of errors.
+				for (int i = 0; i < 4 && glGetError() != GL_NO_ERROR; i++) {}
+				glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, outPixels);
+				auto result = glGetError() == GL_NO_ERROR ? ErrorCode::RES_NO_ERROR : ErrorCode::INTERNAL_ERROR;
+				glPixelStorei(GL_PACK_ALIGNMENT, previousPackAlignment);
+				glState.BindFrameBuffer(static_cast<GLuint>(previousFrameBuffer));
+				if (previousContext != context)
+					MakeContextCurrent(previousContext);
+				return result;
+			});
+		}
 		static std::map<GLFWwindow*, WindowImpl*> mMap;
 		WindowResizeCallback callback = nullptr;
 	private:
 		GLFWwindow* window = nullptr;
+		int frameLimit = 0;
+		int frameCount = 0;
 	};
 
 	std::map<GLFWwindow*, WindowImpl*> WindowImpl::mMap;
 
 	static void GLFWOnFrameSizeChanged(GLFWwindow* _window, int width, int height) {
-		static_cast<GLFWwindow*>(_window);
 		auto iteWindowImpl = WindowImpl::mMap.find(_window);
 		if (iteWindowImpl == WindowImpl::mMap.end()) {
 			std::cerr << "Glfw window error!" << std::endl;
@@ -63,7 +234,12 @@ namespace ResRenderer {
 		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-		
+#ifdef RES_HEADLESS
+		//GLFW is built for its null platform, windows are OSMesa offscreen buffers.
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+#endif
+
 		return true;
 	}
 
@@ -72,9 +248,28 @@ namespace ResRenderer {
 	}
 
 	void RES_RENDERER_API Terminate() {
+		StopCompileWorkers();
+		ReleaseShaderReloads();
+		shareContext = nullptr;
+		Dispatch([] { ReleaseStreamingBuffer(); });
+		if (renderThread != nullptr) {
+			renderThread->Stop();
+			delete renderThread;
+			renderThread = nullptr;
+		}
+		requestedFramesInFlight = 0;
+		contextInitialized = false;
 		glfwTerminate();
 	}
 
+	ErrorCode RES_RENDERER_API EnableRenderThread(int framesInFlight) {
+		//Context ownership is decided when first window is created.
+		if (contextInitialized || renderThread != nullptr)
+			return ErrorCode::INTERNAL_ERROR;
+		requestedFramesInFlight = framesInFlight > 0 ? framesInFlight : 1;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
 	ErrorCode RES_RENDERER_API CreateResWindow(int width, int height, const char* title, Window* outWindow) {
 		try {
 			auto t = static_cast<Window>(new WindowImpl(width, height, title));
@@ -98,7 +293,13 @@ namespace ResRenderer {
 
 	void RES_RENDERER_API SwapBuffer(Window window) {
 		auto pWindow = static_cast<WindowImpl*>(window);
-		pWindow->Swapbuffer();
+		pWindow->CountFrame();
+		Dispatch([pWindow] {
+			pWindow->Swapbuffer();
+			EndStreamingFrame();
+		});
+		if (renderThread != nullptr)
+			renderThread->EndFrame();
 	}
 
 	void RES_RENDERER_API PollEvents() {
@@ -106,7 +307,6 @@ namespace ResRenderer {
 	}
 
 	void RES_RENDERER_API Clear(Color color, ClearType clearType) {
-		glClearColor(color.r, color.g, color.b, color.a);
 		GLbitfield mask = 0;
 		if (clearType == ClearType::Color || clearType == ClearType::ColorAndDepth) {
 			mask |= GL_COLOR_BUFFER_BIT;
@@ -114,6 +314,55 @@ namespace ResRenderer {
 		if (clearType == ClearType::Depth || clearType == ClearType::ColorAndDepth) {
 			mask |= GL_DEPTH_BUFFER_BIT;
 		}
-		glClear(mask);
+		Dispatch([=] {
+			try
+			{
+				glState.ClearColor(color);
+			}
+			catch (GLenum)
+			{
+			}
+			glClear(mask);
+		});
+	}
+
+	void RES_RENDERER_API SetWindowFrameLimit(Window window, int frameCount) {
+		auto pWindow = static_cast<WindowImpl*>(window);
+		pWindow->SetFrameLimit(frameCount);
+	}
+
+	ErrorCode RES_RENDERER_API ReadWindowPixels(Window window, void* outPixels, size_t bufferSize) {
+		auto pWindow = static_cast<WindowImpl*>(window);
+		return pWindow->ReadPixels(outPixels, bufferSize);
+	}
+
+	void RES_RENDERER_API GetGLStateCacheStats(GLStateCacheStats* outStats) {
+		*outStats = DispatchSync([] { return glState.GetStats(); });
+	}
+
+	void RES_RENDERER_API ResetGLStateCacheStats() {
+		DispatchSync([] { glState.ResetStats(); });
+	}
+
+	GLValidationLevel RES_RENDERER_API SetGLValidationLevel(GLValidationLevel level) {
+		auto t = static_cast<int>(level);
+		if (t > RES_GL_VALIDATION)
+			t = RES_GL_VALIDATION;
+		glValidationLevel.store(t);
+		if (contextInitialized)
+			Dispatch([] { ConfigureDebugOutput(); });
+		return static_cast<GLValidationLevel>(t);
+	}
+
+	GLValidationLevel RES_RENDERER_API GetGLValidationLevel() {
+		return static_cast<GLValidationLevel>(glValidationLevel.load());
+	}
+
+	void RES_RENDERER_API GetGLStreamingStats(GLStreamingStats* outStats) {
+		*outStats = DispatchSync([] { return GetStreamingStats(); });
+	}
+
+	void RES_RENDERER_API ResetGLStreamingStats() {
+		DispatchSync([] { ResetStreamingStats(); });
 	}
 }
\ No newline at end of file
@@ -0,0 +1,1126 @@
+#include <ResRenderer.hpp>
+#include <ResRendererSoftware.hpp>
+#include <ResRendererImpl_Soft.hpp>
+#include <ResParallel.hpp>
+#include <ResCommandList.hpp>
+#include <ResMeshLOD.hpp>
+#include <ResVertexFormat.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace ResRenderer {
+
+	//Flush binned triangles before they take too much memory.
+	static const size_t MaxBinnedTriangles = 1 << 18;
+	//Draws smaller than this are set up on the calling thread.
+	static const size_t ParallelSetupThreshold = 4096;
+	//Keep fixed point coordinates far away from overflow, triangles reaching beyond are clipped.
+	static const float GuardBand = 32768.0f;
+	//Triangles are clipped this close to w = 0.
+	static const float NearW = 1e-5f;
+	//Marks bin entries of triangles made by clipping.
+	static const uint32_t ClippedTriangleBit = 0x80000000u;
+
+	struct SoftMeshVertex {
+		float pos[4];
+		float color[4];
+	};
+
+	class MeshImpl
+	{
+	public:
+		void UploadMeshData(const MeshData* data) {
+			meshInitialized = false;
+			auto vertSize = GetMeshVertexSize(data);
+			auto src = static_cast<const unsigned char*>(data->data);
+
+			//Find position and color attributes.
+			size_t offsets[MESH_DATA_MAX_ATTRIB_COUNT];
+			size_t offset = 0;
+			for (int i = 0; i < data->attribCount; i++)
+			{
+				offsets[i] = offset;
+				offset += data->attribDescriptions[i].count * GetVertexAttribSize(data->attribDescriptions[i].type);
+			}
+			int posCount = data->attribCount > 0 ? std::min(data->attribDescriptions[0].count, 4) : 0;
+			int colorCount = data->attribCount > 1 ? std::min(data->attribDescriptions[1].count, 4) : 0;
+
+			vertices.resize(data->vertCount);
+			for (int v = 0; v < data->vertCount; v++)
+			{
+				auto& out = vertices[v];
+				const unsigned char* vert = src + vertSize * v;
+				float pos[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+				float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+				if (posCount > 0)
+					UnpackVertexAttrib(data->attribDescriptions[0], vert + offsets[0], pos);
+				if (colorCount > 0)
+					UnpackVertexAttrib(data->attribDescriptions[1], vert + offsets[1], color);
+				memcpy(out.pos, pos, sizeof(pos));
+				memcpy(out.color, color, sizeof(color));
+			}
+			indices.assign(data->indicies, data->indicies + data->indiciesCount);
+			indexCount = indices.size();
+			lods.assign(1, MeshLOD{ 0, static_cast<unsigned int>(indices.size()), 0.0f });
+			meshInitialized = true;
+		}
+
+		bool meshInitialized = false;
+		std::vector<SoftMeshVertex> vertices;
+		std::vector<VertexIndex_t> indices;
+		//Indices of the full mesh, the only ones drawn outside DrawMeshLOD. Simplified levels follow them.
+		size_t indexCount = 0;
+		//Level 0 is the full mesh.
+		std::vector<MeshLOD> lods;
+	};
+
+	//Fixed pipeline instance: attribute 0 is added to clip space position, attribute 1 multiplies color.
+	struct SoftInstance {
+		float offset[4];
+		float color[4];
+	};
+
+	class InstanceBufferImpl
+	{
+	public:
+		void UploadInstanceData(const InstanceData* data) {
+			auto instanceSize = GetInstanceSize(data);
+			auto src = static_cast<const unsigned char*>(data->data);
+			int colorCount = data->attribCount > 1 ? std::min(data->attribDescriptions[1].count, 4) : 0;
+			size_t colorOffset = data->attribDescriptions[0].count * GetVertexAttribSize(data->attribDescriptions[0].type);
+
+			instances.resize(data->instanceCount);
+			for (int i = 0; i < data->instanceCount; i++)
+			{
+				auto& out = instances[i];
+				const unsigned char* instance = src + instanceSize * i;
+				float offset[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+				float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+				UnpackVertexAttrib(data->attribDescriptions[0], instance, offset);
+				if (colorCount > 0)
+					UnpackVertexAttrib(data->attribDescriptions[1], instance + colorOffset, color);
+				memcpy(out.offset, offset, sizeof(offset));
+				memcpy(out.color, color, sizeof(color));
+			}
+		}
+
+		std::vector<SoftInstance> instances;
+	};
+
+	//No vertex fetch cost to save here, a batch only keeps its meshes together.
+	struct MeshBatchImpl {
+		MeshData layout;
+		std::vector<std::unique_ptr<MeshImpl>> meshes;
+	};
+
+	//Not read by the fixed pipeline, data is only kept.
+	struct UniformBufferImpl {
+		explicit UniformBufferImpl(size_t size) : data(size) {}
+		std::vector<unsigned char> data;
+	};
+
+	class ShaderImpl {
+	public:
+		ShaderImpl() {
+			GetUniformLocation(MakeUniformId("_Tint"));
+		}
+
+		//No program to query, every uniform exists. Names are only kept as ids.
+		int GetUniformLocation(UniformId id) {
+			auto ite = locations.find(id);
+			if (ite != locations.end())
+				return ite->second;
+			auto location = static_cast<int>(values.size());
+			locations.insert(std::pair<UniformId, int>(id, location));
+			values.push_back(Color(1.0f, 1.0f, 1.0f, 1.0f));
+			return location;
+		}
+
+		void SetUniform(int location, const Vector4& v) {
+			if (location < 0 || location >= static_cast<int>(values.size()))
+				return;
+			values[location] = Color(v.x, v.y, v.z, v.w);
+		}
+
+		//_Tint is always registered first.
+		const Color& GetTint() const {
+			return values[0];
+		}
+
+		ShaderCompileStatus asyncStatus = ShaderCompileStatus::None;
+
+	private:
+		std::map<UniformId, int> locations;
+		std::vector<Color> values;
+	};
+
+	class WindowImpl {
+	public:
+		WindowImpl(int width, int height) : frameBuffer(width, height) {
+		}
+
+		FrameBufferImpl frameBuffer;
+		WindowResizeCallback callback = nullptr;
+		bool isClosing = false;
+		int frameLimit = 0;
+		int frameCount = 0;
+	};
+
+	class SoftDevice {
+	public:
+		explicit SoftDevice(int threadCount) {
+			pool.reset(new WorkerPool(threadCount));
+			startTime = std::chrono::steady_clock::now();
+		}
+
+		float GetTime() const {
+			std::chrono::duration<float> t = std::chrono::steady_clock::now() - startTime;
+			return t.count();
+		}
+
+		void SetThreadCount(int count) {
+			Flush();
+			pool.reset(new WorkerPool(count));
+		}
+
+		void SetTarget(FrameBufferImpl* frameBuffer) {
+			if (frameBuffer == target)
+				return;
+			Flush();
+			target = frameBuffer;
+		}
+
+		void SetViewPort(int x, int y, int width, int height) {
+			viewport[0] = static_cast<float>(x);
+			viewport[1] = static_cast<float>(y);
+			viewport[2] = static_cast<float>(width);
+			viewport[3] = static_cast<float>(height);
+		}
+
+		void Clear(Color color, ClearType clearType) {
+			//There's no depth buffer.
+			if (target == nullptr || (clearType != ClearType::Color && clearType != ClearType::ColorAndDepth))
+				return;
+			Flush();
+			auto packed = PackColorRGBA8(color.r, color.g, color.b, color.a);
+			auto fb = target;
+			pool->ParallelFor(fb->tilesY, [=](int tileRow, int) {
+				auto rowBegin = static_cast<size_t>(tileRow) * SoftTileSize * fb->width;
+				auto rowEnd = std::min(rowBegin + static_cast<size_t>(SoftTileSize) * fb->width, fb->color.size());
+				std::fill(fb->color.begin() + rowBegin, fb->color.begin() + rowEnd, packed);
+			});
+		}
+
+		//Triangles [firstTriangle, firstTriangle + triangleCount) of the mesh's indices, clamped to their size. By default
+		//the full mesh without its simplified levels.
+		ErrorCode Draw(const MeshImpl* mesh, const ShaderImpl* shader, const SoftInstance* instance = nullptr,
+			size_t firstTriangle = 0, size_t triangleCount = SIZE_MAX) {
+			if (!mesh->meshInitialized)
+				return ErrorCode::MESH_NOT_CREATED;
+			if (target == nullptr)
+				return ErrorCode::INTERNAL_ERROR;
+
+			Color tint = shader != nullptr ? shader->GetTint() : Color(1.0f, 1.0f, 1.0f, 1.0f);
+			static const float noOffset[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			const float* offset = noOffset;
+			if (instance != nullptr) {
+				tint = Color(tint.r * instance->color[0], tint.g * instance->color[1], tint.b * instance->color[2], tint.a * instance->color[3]);
+				offset = instance->offset;
+			}
+			if (triangleCount == SIZE_MAX)
+				triangleCount = mesh->indexCount / 3;
+			size_t triCount = mesh->indices.size() / 3;
+			size_t start = std::min(firstTriangle, triCount);
+			triCount = start + std::min(triangleCount, triCount - start);
+			while (start < triCount)
+			{
+				size_t piece = std::min(triCount - start, MaxBinnedTriangles);
+				if (triangles.size() + piece > MaxBinnedTriangles)
+					Flush();
+				size_t base = triangles.size();
+				triangles.resize(base + piece);
+
+				if (piece < ParallelSetupThreshold || pool->GetThreadCount() == 1) {
+					if (serialChunk < 0)
+						serialChunk = AcquireChunk();
+					binnedTriangles += SetupRange(mesh, tint, offset, start, piece, base, serialChunk);
+				}
+				else {
+					//Every slice bins into its own chunk, chunks are consumed in order so submit order is kept.
+					int sliceCount = pool->GetThreadCount();
+					int firstChunk = AcquireChunk();
+					for (int i = 1; i < sliceCount; i++)
+						AcquireChunk();
+					serialChunk = -1;
+					std::atomic<unsigned long long> binned(0);
+					pool->ParallelFor(sliceCount, [&](int slice, int) {
+						size_t sliceBegin = piece * slice / sliceCount;
+						size_t sliceEnd = piece * (slice + 1) / sliceCount;
+						binned += SetupRange(mesh, tint, offset, start + sliceBegin, sliceEnd - sliceBegin, base + sliceBegin, firstChunk + slice);
+					});
+					binnedTriangles += binned;
+				}
+				start += piece;
+			}
+			return ErrorCode::RES_NO_ERROR;
+		}
+
+		void Flush() {
+			if (target == nullptr || usedChunks == 0) {
+				triangles.clear();
+				usedChunks = 0;
+				serialChunk = -1;
+				return;
+			}
+
+			std::atomic<unsigned long long> pixels(0);
+			std::atomic<unsigned long long> jobs(0);
+			pool->ParallelFor(target->TileCount(), [&](int tile, int) {
+				auto n = RasterizeTile(tile);
+				if (n != ~0ull) {
+					pixels += n;
+					jobs++;
+				}
+			});
+			stats.pixels += pixels;
+			stats.tileJobs += jobs;
+			stats.triangles += binnedTriangles;
+			binnedTriangles = 0;
+
+			for (int i = 0; i < usedChunks; i++)
+			{
+				for (auto& bin : chunks[i].bins)
+					bin.clear();
+				chunks[i].clipped.clear();
+			}
+			triangles.clear();
+			usedChunks = 0;
+			serialChunk = -1;
+		}
+
+		std::unique_ptr<WorkerPool> pool;
+		FrameBufferImpl* target = nullptr;
+		WindowImpl* currentWindow = nullptr;
+		ShaderImpl* currentShader = nullptr;
+		RasterizerStats stats;
+
+	private:
+		int AcquireChunk() {
+			if (usedChunks == static_cast<int>(chunks.size()))
+				chunks.emplace_back();
+			auto& chunk = chunks[usedChunks];
+			if (static_cast<int>(chunk.bins.size()) != target->TileCount())
+				chunk.bins.resize(target->TileCount());
+			return usedChunks++;
+		}
+
+		//Sets up triangles [first, first + count) of the mesh, writes to triangles[base...] and bins them into the chunk.
+		//Triangles crossing w = 0 or the guard band are clipped, their pieces go to the chunk's own list.
+		unsigned long long SetupRange(const MeshImpl* mesh, const Color& tint, const float* offset, size_t first, size_t count, size_t base, int chunk) {
+			auto& bins = chunks[chunk].bins;
+			auto& clipped = chunks[chunk].clipped;
+			auto vertCount = mesh->vertices.size();
+			const float tintColor[4] = { tint.r, tint.g, tint.b, tint.a };
+			unsigned long long binned = 0;
+			for (size_t t = 0; t < count; t++)
+			{
+				const VertexIndex_t* idx = &mesh->indices[(first + t) * 3];
+				if (idx[0] >= vertCount || idx[1] >= vertCount || idx[2] >= vertCount)
+					continue;
+				ClipVertex v[3];
+				unsigned int codes[3];
+				for (int i = 0; i < 3; i++)
+				{
+					auto& src = mesh->vertices[idx[i]];
+					for (int c = 0; c < 4; c++)
+					{
+						v[i].pos[c] = src.pos[c] + offset[c];
+						v[i].color[c] = src.color[c] * tintColor[c];
+					}
+					codes[i] = ClipCodes(v[i]);
+				}
+				//Entirely outside one plane.
+				if (codes[0] & codes[1] & codes[2])
+					continue;
+
+				if ((codes[0] | codes[1] | codes[2]) == 0) {
+					auto& tri = triangles[base + t];
+					if (SetupTriangle(v[0], v[1], v[2], tri)) {
+						Bin(bins, tri, static_cast<uint32_t>(base + t));
+						binned++;
+					}
+					continue;
+				}
+
+				ClipVertex polygon[MaxClippedVertices];
+				int n = ClipTriangle(v, codes[0] | codes[1] | codes[2], polygon);
+				bool any = false;
+				for (int k = 1; k + 1 < n; k++)
+				{
+					SoftTriangle tri;
+					if (!SetupTriangle(polygon[0], polygon[k], polygon[k + 1], tri))
+						continue;
+					auto index = ClippedTriangleBit | static_cast<uint32_t>(clipped.size());
+					clipped.push_back(tri);
+					Bin(bins, tri, index);
+					any = true;
+				}
+				if (any)
+					binned++;
+			}
+			return binned;
+		}
+
+		//Vertex in clip space, color already tinted.
+		struct ClipVertex {
+			float pos[4];
+			float color[4];
+		};
+
+		//Planes: screen x <= GuardBand, x >= -GuardBand, same for y, then w >= NearW. Their distances are linear in
+		//clip space, screen x * w = (viewport x + viewport width / 2) * w + viewport width / 2 * x.
+		static const int ClipPlaneCount = 5;
+		static const int MaxClippedVertices = 3 + ClipPlaneCount;
+
+		float PlaneDistance(const ClipVertex& v, int plane) const {
+			float w = v.pos[3];
+			switch (plane)
+			{
+			case 0: return GuardBand * w - ((viewport[0] + viewport[2] * 0.5f) * w + viewport[2] * 0.5f * v.pos[0]);
+			case 1: return GuardBand * w + ((viewport[0] + viewport[2] * 0.5f) * w + viewport[2] * 0.5f * v.pos[0]);
+			case 2: return GuardBand * w - ((viewport[1] + viewport[3] * 0.5f) * w + viewport[3] * 0.5f * v.pos[1]);
+			case 3: return GuardBand * w + ((viewport[1] + viewport[3] * 0.5f) * w + viewport[3] * 0.5f * v.pos[1]);
+			default: return w - NearW;
+			}
+		}
+
+		unsigned int ClipCodes(const ClipVertex& v) const {
+			unsigned int codes = 0;
+			for (int p = 0; p < ClipPlaneCount; p++)
+			{
+				if (!(PlaneDistance(v, p) >= 0.0f))
+					codes |= 1u << p;
+			}
+			return codes;
+		}
+
+		//Sutherland-Hodgman against the planes in codes, returns the vertex count of the convex polygon left.
+		int ClipTriangle(const ClipVertex* v, unsigned int codes, ClipVertex* outPolygon) const {
+			ClipVertex buffers[2][MaxClippedVertices];
+			std::copy(v, v + 3, buffers[0]);
+			int n = 3;
+			int current = 0;
+			for (int p = 0; p < ClipPlaneCount && n > 0; p++)
+			{
+				if (!(codes & (1u << p)))
+					continue;
+				auto in = buffers[current];
+				auto out = buffers[current ^ 1];
+				int outCount = 0;
+				for (int i = 0; i < n; i++)
+				{
+					auto& a = in[i];
+					auto& b = in[(i + 1) % n];
+					float da = PlaneDistance(a, p);
+					float db = PlaneDistance(b, p);
+					if (da >= 0.0f)
+						out[outCount++] = a;
+					if ((da >= 0.0f) != (db >= 0.0f)) {
+						float f = da / (da - db);
+						auto& x = out[outCount++];
+						for (int c = 0; c < 4; c++)
+						{
+							x.pos[c] = a.pos[c] + (b.pos[c] - a.pos[c]) * f;
+							x.color[c] = a.color[c] + (b.color[c] - a.color[c]) * f;
+						}
+					}
+				}
+				n = outCount;
+				current ^= 1;
+			}
+			std::copy(buffers[current], buffers[current] + n, outPolygon);
+			return n;
+		}
+
+		//False if the triangle covers no pixel of the target. Vertices must be inside the clip planes.
+		bool SetupTriangle(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2, SoftTriangle& tri) const {
+			auto fb = target;
+			const ClipVertex* v[3] = { &v0, &v1, &v2 };
+			int64_t fx[3], fy[3];
+			float z[3], invW[3];
+			for (int i = 0; i < 3; i++)
+			{
+				invW[i] = 1.0f / v[i]->pos[3];
+				float sx = viewport[0] + (v[i]->pos[0] * invW[i] * 0.5f + 0.5f) * viewport[2];
+				float sy = viewport[1] + (v[i]->pos[1] * invW[i] * 0.5f + 0.5f) * viewport[3];
+				//Clipping leaves coordinates inside the guard band up to rounding.
+				sx = std::max(-GuardBand, std::min(GuardBand, sx));
+				sy = std::max(-GuardBand, std::min(GuardBand, sy));
+				fx[i] = static_cast<int64_t>(std::floor(sx * SoftSubPixelScale + 0.5f));
+				fy[i] = static_cast<int64_t>(std::floor(sy * SoftSubPixelScale + 0.5f));
+				z[i] = v[i]->pos[2] * invW[i] * 0.5f + 0.5f;
+			}
+
+			int order[3] = { 0, 1, 2 };
+			int64_t area = (fx[1] - fx[0]) * (fy[2] - fy[0]) - (fy[1] - fy[0]) * (fx[2] - fx[0]);
+			if (area == 0)
+				return false;
+			if (area < 0) {
+				order[1] = 2;
+				order[2] = 1;
+				area = -area;
+			}
+
+			int minX = static_cast<int>(std::min(fx[0], std::min(fx[1], fx[2])) >> SoftSubPixelBits);
+			int maxX = static_cast<int>(std::max(fx[0], std::max(fx[1], fx[2])) >> SoftSubPixelBits);
+			int minY = static_cast<int>(std::min(fy[0], std::min(fy[1], fy[2])) >> SoftSubPixelBits);
+			int maxY = static_cast<int>(std::max(fy[0], std::max(fy[1], fy[2])) >> SoftSubPixelBits);
+			minX = std::max(minX, 0);
+			minY = std::max(minY, 0);
+			maxX = std::min(maxX, fb->width - 1);
+			maxY = std::min(maxY, fb->height - 1);
+			if (minX > maxX || minY > maxY)
+				return false;
+
+			tri.minX = minX; tri.minY = minY;
+			tri.maxX = maxX; tri.maxY = maxY;
+			tri.invArea = 1.0f / static_cast<float>(area);
+			for (int e = 0; e < 3; e++)
+			{
+				//Edge opposite to vertex e goes from a to b.
+				int a = order[(e + 1) % 3];
+				int b = order[(e + 2) % 3];
+				int64_t dx = fx[b] - fx[a];
+				int64_t dy = fy[b] - fy[a];
+				tri.edgeA[e] = -dy;
+				tri.edgeB[e] = dx;
+				tri.edgeC[e] = dy * fx[a] - dx * fy[a];
+				//Top-left rule, so shared edges are only drawn once.
+				bool owner = dy > 0 || (dy == 0 && dx < 0);
+				if (!owner)
+					tri.edgeC[e] -= 1;
+
+				int src = order[e];
+				tri.z[e] = z[src];
+				tri.invW[e] = invW[src];
+				for (int c = 0; c < 4; c++)
+					tri.color[e][c] = v[src]->color[c] * invW[src];
+			}
+			return true;
+		}
+
+		void Bin(std::vector<std::vector<uint32_t>>& bins, const SoftTriangle& tri, uint32_t index) const {
+			for (int ty = tri.minY / SoftTileSize; ty <= tri.maxY / SoftTileSize; ty++)
+			{
+				for (int tx = tri.minX / SoftTileSize; tx <= tri.maxX / SoftTileSize; tx++)
+				{
+					bins[ty * target->tilesX + tx].push_back(index);
+				}
+			}
+		}
+
+		//Returns covered pixel count, or ~0 if the tile had no triangle.
+		unsigned long long RasterizeTile(int tile) {
+			auto fb = target;
+			int tileX0 = (tile % fb->tilesX) * SoftTileSize;
+			int tileY0 = (tile / fb->tilesX) * SoftTileSize;
+			int tileX1 = std::min(tileX0 + SoftTileSize, fb->width) - 1;
+			int tileY1 = std::min(tileY0 + SoftTileSize, fb->height) - 1;
+
+			bool any = false;
+			unsigned long long covered = 0;
+			for (int c = 0; c < usedChunks; c++)
+			{
+				auto& bin = chunks[c].bins[tile];
+				if (bin.empty())
+					continue;
+				any = true;
+				auto& clipped = chunks[c].clipped;
+				for (auto triIndex : bin)
+				{
+					auto& tri = (triIndex & ClippedTriangleBit) ? clipped[triIndex & ~ClippedTriangleBit] : triangles[triIndex];
+					covered += RasterizeTriangle(tri, tileX0, tileY0, tileX1, tileY1);
+				}
+			}
+			return any ? covered : ~0ull;
+		}
+
+		unsigned long long RasterizeTriangle(const SoftTriangle& tri, int tileX0, int tileY0, int tileX1, int tileY1) {
+			auto fb = target;
+			int x0 = std::max(tri.minX, tileX0);
+			int x1 = std::min(tri.maxX, tileX1);
+			int y0 = std::max(tri.minY, tileY0);
+			int y1 = std::min(tri.maxY, tileY1);
+
+			const int64_t half = SoftSubPixelScale / 2;
+			int64_t px = static_cast<int64_t>(x0) * SoftSubPixelScale + half;
+			int64_t py = static_cast<int64_t>(y0) * SoftSubPixelScale + half;
+			int64_t row[3], stepX[3], stepY[3];
+			for (int e = 0; e < 3; e++)
+			{
+				row[e] = tri.edgeA[e] * px + tri.edgeB[e] * py + tri.edgeC[e];
+				stepX[e] = tri.edgeA[e] * SoftSubPixelScale;
+				stepY[e] = tri.edgeB[e] * SoftSubPixelScale;
+			}
+
+			//Local pointer, so stores to the buffer don't force reloading it.
+			uint32_t* colorBuffer = fb->color.data();
+			const size_t pitch = static_cast<size_t>(fb->width);
+			unsigned long long covered = 0;
+			for (int y = y0; y <= y1; y++)
+			{
+				//Solve the covered span of this row from the edges, instead of testing every pixel of the bounding box.
+				//Near horizontal edges out in the guard band give quotients past int range, clamp before narrowing.
+				const int64_t spanMax = static_cast<int64_t>(x1) - x0 + 1;
+				int spanBegin = x0, spanEnd = x1;
+				for (int e = 0; e < 3; e++)
+				{
+					if (stepX[e] > 0) {
+						if (row[e] < 0)
+							spanBegin = std::max(spanBegin, x0 + static_cast<int>(std::min((-row[e] + stepX[e] - 1) / stepX[e], spanMax)));
+					}
+					else if (stepX[e] < 0) {
+						if (row[e] < 0)
+							spanEnd = x0 - 1;
+						else
+							spanEnd = std::min(spanEnd, x0 + static_cast<int>(std::min(row[e] / -stepX[e], spanMax)));
+					}
+					else if (row[e] < 0) {
+						spanEnd = x0 - 1;
+					}
+				}
+
+				int64_t e0 = row[0] + stepX[0] * (spanBegin - x0);
+				int64_t e1 = row[1] + stepX[1] * (spanBegin - x0);
+				int64_t e2 = row[2] + stepX[2] * (spanBegin - x0);
+				size_t pixel = static_cast<size_t>(y) * pitch + spanBegin;
+				if (spanEnd >= spanBegin)
+					covered += spanEnd - spanBegin + 1;
+				for (int x = spanBegin; x <= spanEnd; x++, pixel++, e0 += stepX[0], e1 += stepX[1], e2 += stepX[2])
+				{
+					float b0 = static_cast<float>(e0) * tri.invArea;
+					float b1 = static_cast<float>(e1) * tri.invArea;
+					float b2 = static_cast<float>(e2) * tri.invArea;
+					float depth = b0 * tri.z[0] + b1 * tri.z[1] + b2 * tri.z[2];
+					//No depth test, like the OpenGL backend. Near and far are clipped per pixel.
+					if (depth < 0.0f || depth > 1.0f)
+						continue;
+					float w = 1.0f / (b0 * tri.invW[0] + b1 * tri.invW[1] + b2 * tri.invW[2]);
+					float c[4];
+					for (int i = 0; i < 4; i++)
+						c[i] = (b0 * tri.color[0][i] + b1 * tri.color[1][i] + b2 * tri.color[2][i]) * w;
+					colorBuffer[pixel] = PackColorRGBA8(c[0], c[1], c[2], c[3]);
+				}
+				row[0] += stepY[0];
+				row[1] += stepY[1];
+				row[2] += stepY[2];
+			}
+			return covered;
+		}
+
+		std::chrono::steady_clock::time_point startTime;
+		float viewport[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+		std::vector<SoftTriangle> triangles;
+		//bins[tile] holds indices into triangles, or into clipped with ClippedTriangleBit set.
+		struct Chunk {
+			std::vector<std::vector<uint32_t>> bins;
+			std::vector<SoftTriangle> clipped;
+		};
+		std::vector<Chunk> chunks;
+		int usedChunks = 0;
+		int serialChunk = -1;
+		unsigned long long binnedTriangles = 0;
+	};
+
+	static SoftDevice* device = nullptr;
+	static int requestedThreadCount = 0;
+
+	bool RES_RENDERER_API Init() {
+		if (device != nullptr)
+			return true;
+		device = new SoftDevice(requestedThreadCount);
+		return true;
+	}
+
+	float RES_RENDERER_API GetTime() {
+		//Like glfwGetTime before glfwInit, no device is 0.
+		return device != nullptr ? device->GetTime() : 0.0f;
+	}
+
+	void RES_RENDERER_API Terminate() {
+		delete device;
+		device = nullptr;
+	}
+
+	void RES_RENDERER_API SetRasterizerThreadCount(int count) {
+		requestedThreadCount = count;
+		if (device != nullptr)
+			device->SetThreadCount(count);
+	}
+
+	int RES_RENDERER_API GetRasterizerThreadCount() {
+		if (device != nullptr)
+			return device->pool->GetThreadCount();
+		return requestedThreadCount > 0 ? requestedThreadCount : WorkerPool::HardwareThreadCount();
+	}
+
+	void RES_RENDERER_API GetRasterizerStats(RasterizerStats* outStats) {
+		*outStats = device != nullptr ? device->stats : RasterizerStats();
+	}
+
+	void RES_RENDERER_API ResetRasterizerStats() {
+		if (device != nullptr)
+			device->stats = RasterizerStats();
+	}
+
+	//Mesh
+	ErrorCode RES_RENDERER_API CreateMesh(Mesh* outMesh) {
+		*outMesh = static_cast<Mesh>(new MeshImpl());
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	//Meshes already live in system memory.
+	ErrorCode RES_RENDERER_API CreateDynamicMesh(Mesh* outMesh) {
+		return CreateMesh(outMesh);
+	}
+
+	ErrorCode RES_RENDERER_API UploadMeshData(Mesh mesh, const MeshData* data) {
+		auto t = MeshDataVerify(data);
+		if (t != ErrorCode::RES_NO_ERROR)
+			return t;
+
+		auto pMesh = static_cast<MeshImpl*>(mesh);
+		try
+		{
+			pMesh->UploadMeshData(data);
+			return ErrorCode::RES_NO_ERROR;
+		}
+		catch (std::bad_alloc&)
+		{
+			return ErrorCode::INTERNAL_ERROR;
+		}
+	}
+
+	ErrorCode RES_RENDERER_API DestroyMesh(Mesh mesh) {
+		//Binned triangles don't reference the mesh, nothing to flush.
+		delete static_cast<MeshImpl*>(mesh);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API CreateMeshBatch(MeshBatch* outBatch) {
+		*outBatch = static_cast<MeshBatch>(new MeshBatchImpl());
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API MeshBatchAddMesh(MeshBatch batch, const MeshData* data, int* outSubMesh) {
+		auto t = MeshDataVerify(data);
+		if (t != ErrorCode::RES_NO_ERROR)
+			return t;
+		auto pBatch = static_cast<MeshBatchImpl*>(batch);
+		if (pBatch->meshes.empty())
+			pBatch->layout = *data;
+		else if (!MeshDataSameLayout(&pBatch->layout, data))
+			return ErrorCode::MESH_DATA_BROKEN;
+
+		try
+		{
+			std::unique_ptr<MeshImpl> mesh(new MeshImpl());
+			mesh->UploadMeshData(data);
+			pBatch->meshes.push_back(std::move(mesh));
+			*outSubMesh = static_cast<int>(pBatch->meshes.size()) - 1;
+			return ErrorCode::RES_NO_ERROR;
+		}
+		catch (std::bad_alloc&)
+		{
+			return ErrorCode::INTERNAL_ERROR;
+		}
+	}
+
+	ErrorCode RES_RENDERER_API DestroyMeshBatch(MeshBatch batch) {
+		delete static_cast<MeshBatchImpl*>(batch);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API UploadMeshDataWithLODs(Mesh mesh, const MeshData* data, const MeshLODSettings* settings) {
+		MeshLODSettings defaults;
+		auto pMesh = static_cast<MeshImpl*>(mesh);
+		try
+		{
+			std::vector<VertexIndex_t> indicies;
+			std::vector<MeshLOD> lods;
+			auto t = GenerateMeshLODs(data, settings != nullptr ? *settings : defaults, &indicies, &lods);
+			if (t != ErrorCode::RES_NO_ERROR)
+				return t;
+			MeshData combined = *data;
+			combined.indicies = indicies.data();
+			combined.indiciesCount = indicies.size();
+			pMesh->UploadMeshData(&combined);
+			pMesh->indexCount = lods[0].indexCount;
+			pMesh->lods = lods;
+			return ErrorCode::RES_NO_ERROR;
+		}
+		catch (std::bad_alloc&)
+		{
+			return ErrorCode::INTERNAL_ERROR;
+		}
+	}
+
+	ErrorCode RES_RENDERER_API CreateInstanceBuffer(InstanceBuffer* outBuffer) {
+		*outBuffer = static_cast<InstanceBuffer>(new InstanceBufferImpl());
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API UploadInstanceData(InstanceBuffer buffer, const InstanceData* data) {
+		auto t = InstanceDataVerify(data);
+		if (t != ErrorCode::RES_NO_ERROR)
+			return t;
+
+		try
+		{
+			static_cast<InstanceBufferImpl*>(buffer)->UploadInstanceData(data);
+			return ErrorCode::RES_NO_ERROR;
+		}
+		catch (std::bad_alloc&)
+		{
+			return ErrorCode::INTERNAL_ERROR;
+		}
+	}
+
+	ErrorCode RES_RENDERER_API DestroyInstanceBuffer(InstanceBuffer buffer) {
+		delete static_cast<InstanceBufferImpl*>(buffer);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	//Shader
+	ErrorCode RES_RENDERER_API CreateShader(Shader* outShader) {
+		*outShader = static_cast<Shader>(new ShaderImpl());
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API CompileShader(Shader, const char* source, char* compileErrorLog, size_t compileErrorMaxLength, size_t* compileErrorLength) {
+		if (source == nullptr)
+			return ErrorCode::INTERNAL_ERROR;
+		if (compileErrorLog != nullptr && compileErrorMaxLength > 0)
+			compileErrorLog[0] = '\0';
+		if (compileErrorLength != nullptr)
+			*compileErrorLength = 0;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	//Nothing to compile, done before returning.
+	ErrorCode RES_RENDERER_API CompileShaderAsync(Shader shader, const char* source) {
+		auto t = CompileShader(shader, source, nullptr, 0, nullptr);
+		static_cast<ShaderImpl*>(shader)->asyncStatus = t == ErrorCode::RES_NO_ERROR ? ShaderCompileStatus::Succeeded : ShaderCompileStatus::Failed;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API PollShaderCompile(Shader shader, ShaderCompileStatus* outStatus, char* compileErrorLog, size_t compileErrorMaxLength, size_t* compileErrorLength) {
+		*outStatus = static_cast<ShaderImpl*>(shader)->asyncStatus;
+		if (compileErrorLog != nullptr && compileErrorMaxLength > 0)
+			compileErrorLog[0] = '\0';
+		if (compileErrorLength != nullptr)
+			*compileErrorLength = 0;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API GetUniformLocation(Shader shader, const char* name, int* outLocation) {
+		auto pShader = static_cast<ShaderImpl*>(shader);
+		*outLocation = pShader->GetUniformLocation(MakeUniformId(name));
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API GetUniformLocationById(Shader shader, UniformId id, int* outLocation) {
+		*outLocation = static_cast<ShaderImpl*>(shader)->GetUniformLocation(id);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API SetUniformVecById(Shader shader, UniformId id, Vector4 v) {
+		auto pShader = static_cast<ShaderImpl*>(shader);
+		return SetUniformVec(shader, pShader->GetUniformLocation(id), v);
+	}
+
+	ErrorCode RES_RENDERER_API SetUniformVec(Shader shader, int location, Vector4 v) {
+		auto pShader = static_cast<ShaderImpl*>(shader);
+		pShader->SetUniform(location, v);
+		device->currentShader = pShader;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API UseShader(Shader shader) {
+		device->currentShader = static_cast<ShaderImpl*>(shader);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API DestroyShader(Shader shader) {
+		auto pShader = static_cast<ShaderImpl*>(shader);
+		if (device != nullptr && device->currentShader == pShader)
+			device->currentShader = nullptr;
+		delete pShader;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API SetUniformBlockSlot(Shader, const char* blockName, int slot) {
+		if (blockName == nullptr || slot < 0 || slot >= UNIFORM_BUFFER_MAX_SLOT_COUNT)
+			return ErrorCode::INTERNAL_ERROR;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	//Uniform buffer
+	ErrorCode RES_RENDERER_API CreateUniformBuffer(size_t size, UniformBuffer* outBuffer) {
+		if (size == 0)
+			return ErrorCode::BUFFER_TOO_SMALL;
+		*outBuffer = static_cast<UniformBuffer>(new UniformBufferImpl(size));
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API UpdateUniformBuffer(UniformBuffer buffer, const void* data, size_t size, size_t offset) {
+		auto pBuffer = static_cast<UniformBufferImpl*>(buffer);
+		if (offset > pBuffer->data.size() || size > pBuffer->data.size() - offset)
+			return ErrorCode::BUFFER_TOO_SMALL;
+		memcpy(pBuffer->data.data() + offset, data, size);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API BindUniformBuffer(UniformBuffer, int slot) {
+		if (slot < 0 || slot >= UNIFORM_BUFFER_MAX_SLOT_COUNT)
+			return ErrorCode::INTERNAL_ERROR;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API DestroyUniformBuffer(UniformBuffer buffer) {
+		delete static_cast<UniformBufferImpl*>(buffer);
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	//FrameBuffer
+	FrameBuffer RES_RENDERER_API CreateFrameBuffer(FrameBufferDescriptor& descriptor) {
+		return static_cast<FrameBuffer>(new FrameBufferImpl(descriptor.width, descriptor.height));
+	}
+
+	void RES_RENDERER_API DestroyFrameBuffer(FrameBuffer frameBuffer) {
+		auto pFrameBuffer = static_cast<FrameBufferImpl*>(frameBuffer);
+		if (device->target == pFrameBuffer)
+			device->SetTarget(device->currentWindow != nullptr ? &device->currentWindow->frameBuffer : nullptr);
+		delete pFrameBuffer;
+	}
+
+	//Control
+	void RES_RENDERER_API SetViewPort(int x, int y, int width, int height) {
+		device->SetViewPort(x, y, width, height);
+	}
+
+	void RES_RENDERER_API SetRenderWindow(Window window) {
+		auto pWindow = static_cast<WindowImpl*>(window);
+		device->currentWindow = pWindow;
+		device->SetTarget(&pWindow->frameBuffer);
+	}
+
+	void RES_RENDERER_API SetRenderTarget(FrameBuffer frameBuffer) {
+		if (frameBuffer != nullptr)
+			device->SetTarget(static_cast<FrameBufferImpl*>(frameBuffer));
+		else
+			device->SetTarget(device->currentWindow != nullptr ? &device->currentWindow->frameBuffer : nullptr);
+	}
+
+	ErrorCode RES_RENDERER_API DrawMesh(Mesh mesh) {
+		auto pMesh = static_cast<MeshImpl*>(mesh);
+		try
+		{
+			return device->Draw(pMesh, device->currentShader);
+		}
+		catch (std::bad_alloc&)
+		{
+			return ErrorCode::INTERNAL_ERROR;
+		}
+	}
+
+	ErrorCode RES_RENDERER_API DrawMeshInstanced(Mesh mesh, InstanceBuffer instances, int instanceCount) {
+		auto pMesh = static_cast<MeshImpl*>(mesh);
+		auto pInstances = static_cast<InstanceBufferImpl*>(instances);
+		if (pInstances == nullptr || instanceCount < 0)
+			return ErrorCode::INTERNAL_ERROR;
+		if (instanceCount > static_cast<int>(pInstances->instances.size()))
+			return ErrorCode::BUFFER_TOO_SMALL;
+		try
+		{
+			for (int i = 0; i < instanceCount; i++)
+			{
+				auto t = device->Draw(pMesh, device->currentShader, &pInstances->instances[i]);
+				if (t != ErrorCode::RES_NO_ERROR)
+					return t;
+			}
+			return ErrorCode::RES_NO_ERROR;
+		}
+		catch (std::bad_alloc&)
+		{
+			return ErrorCode::INTERNAL_ERROR;
+		}
+	}
+
+	ErrorCode RES_RENDERER_API DrawMeshBatch(MeshBatch batch, const int* subMeshes, int count, InstanceBuffer instances) {
+		auto pBatch = static_cast<MeshBatchImpl*>(batch);
+		auto pInstances = static_cast<InstanceBufferImpl*>(instances);
+		if (pBatch == nullptr || count < 0 || (count > 0 && subMeshes == nullptr))
+			return ErrorCode::INTERNAL_ERROR;
+		if (pInstances != nullptr && count > static_cast<int>(pInstances->instances.size()))
+			return ErrorCode::BUFFER_TOO_SMALL;
+		for (int i = 0; i < count; i++)
+		{
+			if (subMeshes[i] < 0 || subMeshes[i] >= static_cast<int>(pBatch->meshes.size()))
+				return ErrorCode::MESH_NOT_CREATED;
+		}
+		try
+		{
+			for (int i = 0; i < count; i++)
+			{
+				auto instance = pInstances != nullptr ? &pInstances->instances[i] : nullptr;
+				auto t = device->Draw(pBatch->meshes[subMeshes[i]].get(), device->currentShader, instance);
+				if (t != ErrorCode::RES_NO_ERROR)
+					return t;
+			}
+			return ErrorCode::RES_NO_ERROR;
+		}
+		catch (std::bad_alloc&)
+		{
+			return ErrorCode::INTERNAL_ERROR;
+		}
+	}
+
+	ErrorCode RES_RENDERER_API DrawMeshLOD(Mesh mesh, float projectedSize, float maxPixelError) {
+		auto pMesh = static_cast<MeshImpl*>(mesh);
+		if (!pMesh->meshInitialized)
+			return ErrorCode::MESH_NOT_CREATED;
+		auto& lod = SelectMeshLOD(pMesh->lods, projectedSize, maxPixelError);
+		try
+		{
+			return device->Draw(pMesh, device->currentShader, nullptr, lod.firstIndex / 3, lod.indexCount / 3);
+		}
+		catch (std::bad_alloc&)
+		{
+			return ErrorCode::INTERNAL_ERROR;
+		}
+	}
+
+	ErrorCode RES_RENDERER_API DrawMeshRanges(Mesh mesh, const IndexRange* ranges, int count) {
+		auto pMesh = static_cast<MeshImpl*>(mesh);
+		if (pMesh == nullptr || count < 0 || (count > 0 && ranges == nullptr))
+			return ErrorCode::INTERNAL_ERROR;
+		if (!pMesh->meshInitialized)
+			return ErrorCode::MESH_NOT_CREATED;
+		auto indexCount = pMesh->indexCount;
+		for (int i = 0; i < count; i++)
+		{
+			if (ranges[i].firstIndex > indexCount || ranges[i].indexCount > indexCount - ranges[i].firstIndex)
+				return ErrorCode::MESH_DATA_LENGTH_ERROR;
+		}
+		try
+		{
+			for (int i = 0; i < count; i++)
+			{
+				auto t = device->Draw(pMesh, device->currentShader, nullptr, ranges[i].firstIndex / 3, ranges[i].indexCount / 3);
+				if (t != ErrorCode::RES_NO_ERROR)
+					return t;
+			}
+			return ErrorCode::RES_NO_ERROR;
+		}
+		catch (std::bad_alloc&)
+		{
+			return ErrorCode::INTERNAL_ERROR;
+		}
+	}
+
+	void RES_RENDERER_API Clear(Color color, ClearType clearType) {
+		device->Clear(color, clearType);
+	}
+
+	//Window, which is only an offscreen color buffer here.
+	ErrorCode RES_RENDERER_API CreateResWindow(int width, int height, const char*, Window* outWindow) {
+		try {
+			auto pWindow = new WindowImpl(width, height);
+			*outWindow = static_cast<Window>(pWindow);
+			//Same as the OpenGL backend, newly created window becomes current.
+			SetRenderWindow(pWindow);
+			device->SetViewPort(0, 0, width, height);
+			return ErrorCode::RES_NO_ERROR;
+		}
+		catch (std::bad_alloc&) {
+			return ErrorCode::INTERNAL_ERROR;
+		}
+	}
+
+	void RES_RENDERER_API RegisterWindowResizeCallback(Window window, WindowResizeCallback callback) {
+		auto pWindow = static_cast<WindowImpl*>(window);
+		pWindow->callback = callback;
+	}
+
+	bool RES_RENDERER_API ShouldCloseWindow(Window window) {
+		auto pWindow = static_cast<WindowImpl*>(window);
+		if (pWindow->frameLimit > 0 && pWindow->frameCount >= pWindow->frameLimit)
+			return true;
+		return pWindow->isClosing;
+	}
+
+	void RES_RENDERER_API SwapBuffer(Window window) {
+		auto pWindow = static_cast<WindowImpl*>(window);
+		if (device->target == &pWindow->frameBuffer)
+			device->Flush();
+		pWindow->frameCount++;
+	}
+
+	void RES_RENDERER_API PollEvents() {
+	}
+
+	void RES_RENDERER_API SetWindowFrameLimit(Window window, int frameCount) {
+		auto pWindow = static_cast<WindowImpl*>(window);
+		pWindow->frameLimit = frameCount;
+	}
+
+	ErrorCode RES_RENDERER_API ReadWindowPixels(Window window, void* outPixels, size_t bufferSize) {
+		auto pWindow = static_cast<WindowImpl*>(window);
+		auto& fb = pWindow->frameBuffer;
+		if (bufferSize < fb.color.size() * sizeof(uint32_t))
+			return ErrorCode::BUFFER_TOO_SMALL;
+		if (device->target == &fb)
+			device->Flush();
+		memcpy(outPixels, fb.color.data(), fb.color.size() * sizeof(uint32_t));
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API EnableRenderThread(int) {
+		//Rasterization already runs on the worker pool, API calls only record and bin.
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API SubmitCommandLists(const CommandList* lists, int count) {
+		auto result = ErrorCode::RES_NO_ERROR;
+		for (int i = 0; i < count; i++)
+		{
+			static_cast<const CommandListImpl*>(lists[i])->ForEach([&result](const RecordedCommand& command) {
+				auto t = ErrorCode::RES_NO_ERROR;
+				switch (command.type)
+				{
+				case RecordedCommandType::UseShader:
+					device->currentShader = static_cast<ShaderImpl*>(command.object);
+					break;
+				case RecordedCommandType::SetUniformVec:
+					device->currentShader = static_cast<ShaderImpl*>(command.object);
+					device->currentShader->SetUniform(command.location, Color(command.v[0], command.v[1], command.v[2], command.v[3]));
+					break;
+				case RecordedCommandType::DrawMesh:
+					t = DrawMesh(command.object);
+					break;
+				}
+				if (result == ErrorCode::RES_NO_ERROR)
+					result = t;
+			});
+		}
+		return result;
+	}
+}
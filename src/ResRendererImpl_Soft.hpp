@@ -0,0 +1,55 @@
+#pragma once
+#include <ResRenderer.hpp>
+#include <cstdint>
+#include <vector>
+//This header places types shared by the software backend.
+
+namespace ResRenderer {
+
+	//Tiles are square, binned triangles of a tile are rasterized by one thread in submit order.
+	static const int SoftTileSize = 64;
+	static const int SoftSubPixelBits = 4;
+	static const int SoftSubPixelScale = 1 << SoftSubPixelBits;
+
+	//Color is always stored as RGBA8, rows are bottom-up like OpenGL.
+	class FrameBufferImpl {
+	public:
+		FrameBufferImpl(int width, int height) {
+			Resize(width, height);
+		}
+
+		void Resize(int _width, int _height) {
+			width = _width > 0 ? _width : 1;
+			height = _height > 0 ? _height : 1;
+			tilesX = (width + SoftTileSize - 1) / SoftTileSize;
+			tilesY = (height + SoftTileSize - 1) / SoftTileSize;
+			color.assign(static_cast<size_t>(width) * height, 0);
+		}
+
+		int TileCount() const {
+			return tilesX * tilesY;
+		}
+
+		int width = 0, height = 0;
+		int tilesX = 0, tilesY = 0;
+		std::vector<uint32_t> color;
+	};
+
+	//Triangle after setup. Edge i is the one opposite to vertex i, evaluated as A * x + B * y + C in sub-pixel units.
+	struct SoftTriangle {
+		int minX, minY, maxX, maxY;
+		int64_t edgeA[3], edgeB[3], edgeC[3];
+		float invArea;
+		float z[3];
+		float invW[3];
+		float color[3][4];	//Premultiplied by invW, for perspective correct interpolation.
+	};
+
+	inline uint32_t PackColorRGBA8(float r, float g, float b, float a) {
+		auto toByte = [](float v) -> uint32_t {
+			v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+			return static_cast<uint32_t>(v * 255.0f + 0.5f);
+		};
+		return toByte(r) | (toByte(g) << 8) | (toByte(b) << 16) | (toByte(a) << 24);
+	}
+}
@@ -0,0 +1,245 @@
+#include <ResRenderer.hpp>
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Backend independent, variants are ordinary shaders compiled through the immediate API.
+
+namespace ResRenderer {
+
+	struct ShaderVariant {
+		Shader shader = nullptr;
+		ShaderCompileStatus status = ShaderCompileStatus::None;
+		std::string log;
+	};
+
+	class ShaderVariantsImpl {
+	public:
+		explicit ShaderVariantsImpl(const char* _source) : source(_source) {
+			//Every identifier the source mentions, keywords outside of it can't change preprocessed source.
+			for (size_t i = 0; i < source.size();)
+			{
+				if (IsIdentifierStart(source[i])) {
+					size_t end = i + 1;
+					while (end < source.size() && IsIdentifierChar(source[end]))
+						end++;
+					identifiers.insert(source.substr(i, end - i));
+					i = end;
+				}
+				else if (IsIdentifierChar(source[i])) {
+					//Rest of a number like 1.0f.
+					while (i < source.size() && IsIdentifierChar(source[i]))
+						i++;
+				}
+				else {
+					i++;
+				}
+			}
+		}
+
+		~ShaderVariantsImpl() {
+			for (auto& variant : variants)
+			{
+				Wait(*variant.second);
+				DestroyShader(variant.second->shader);
+			}
+		}
+
+		//Requested keyword string to program key, parsing only once per distinct string.
+		ErrorCode Resolve(const char* keywords, std::string* outKey) {
+			std::string requested = keywords != nullptr ? keywords : "";
+			auto ite = keys.find(requested);
+			if (ite != keys.end()) {
+				*outKey = ite->second;
+				return ErrorCode::RES_NO_ERROR;
+			}
+
+			std::set<std::string> used;
+			for (size_t i = 0; i < requested.size();)
+			{
+				if (isspace(static_cast<unsigned char>(requested[i]))) {
+					i++;
+					continue;
+				}
+				size_t end = i;
+				while (end < requested.size() && !isspace(static_cast<unsigned char>(requested[end])))
+					end++;
+				auto keyword = requested.substr(i, end - i);
+				if (!IsIdentifierStart(keyword[0]) || !std::all_of(keyword.begin(), keyword.end(), IsIdentifierChar))
+					return ErrorCode::SHADER_KEYWORD_INVALID;
+				if (identifiers.count(keyword) != 0)
+					used.insert(keyword);
+				i = end;
+			}
+			//Sorted by std::set, so order in the request doesn't matter.
+			std::string key;
+			for (auto& keyword : used)
+			{
+				key += keyword;
+				key += ' ';
+			}
+			keys.insert(std::pair<std::string, std::string>(requested, key));
+			if (variants.count(key) != 0)
+				stats.shared++;
+			*outKey = key;
+			return ErrorCode::RES_NO_ERROR;
+		}
+
+		//Created and started compiling if it's new.
+		ShaderVariant& Get(const std::string& key, bool async) {
+			auto ite = variants.find(key);
+			if (ite != variants.end())
+				return *ite->second;
+
+			std::unique_ptr<ShaderVariant> variant(new ShaderVariant());
+			auto& t = *variant;
+			variants.insert(std::make_pair(key, std::move(variant)));
+			stats.programs++;
+
+			std::string variantSource;
+			for (size_t i = 0; i < key.size(); i = key.find(' ', i) + 1)
+				variantSource += "#define " + key.substr(i, key.find(' ', i) - i) + "\n";
+			//Keeps line numbers of compile errors matching the source.
+			variantSource += "#line 1\n" + source;
+
+			if (CreateShader(&t.shader) != ErrorCode::RES_NO_ERROR) {
+				t.shader = nullptr;
+				t.status = ShaderCompileStatus::Failed;
+				t.log = "CreateShader failed";
+				return t;
+			}
+			if (async) {
+				if (CompileShaderAsync(t.shader, variantSource.c_str()) != ErrorCode::RES_NO_ERROR) {
+					t.status = ShaderCompileStatus::Failed;
+					t.log = "CompileShaderAsync failed";
+					return t;
+				}
+				t.status = ShaderCompileStatus::Compiling;
+			}
+			else {
+				char log[4096];
+				size_t length = 0;
+				auto result = CompileShader(t.shader, variantSource.c_str(), log, sizeof(log), &length);
+				Finish(t, result == ErrorCode::RES_NO_ERROR ? ShaderCompileStatus::Succeeded : ShaderCompileStatus::Failed, log, length);
+			}
+			return t;
+		}
+
+		//True if it's done.
+		bool Poll(ShaderVariant& variant) {
+			if (variant.status != ShaderCompileStatus::Compiling)
+				return true;
+			char log[4096];
+			size_t length = 0;
+			ShaderCompileStatus status;
+			PollShaderCompile(variant.shader, &status, log, sizeof(log), &length);
+			if (status == ShaderCompileStatus::Compiling)
+				return false;
+			Finish(variant, status, log, length);
+			return true;
+		}
+
+		void Wait(ShaderVariant& variant) {
+			while (!Poll(variant))
+				std::this_thread::yield();
+		}
+
+		int Pending() {
+			int pending = 0;
+			for (auto& variant : variants)
+			{
+				if (!Poll(*variant.second))
+					pending++;
+			}
+			return pending;
+		}
+
+		ShaderVariantStats stats;
+
+	private:
+		static bool IsIdentifierStart(char c) {
+			return isalpha(static_cast<unsigned char>(c)) || c == '_';
+		}
+
+		static bool IsIdentifierChar(char c) {
+			return isalnum(static_cast<unsigned char>(c)) || c == '_';
+		}
+
+		static void Finish(ShaderVariant& variant, ShaderCompileStatus status, const char* log, size_t length) {
+			variant.status = status;
+			if (status == ShaderCompileStatus::Failed)
+				variant.log.assign(log, length);
+		}
+
+		std::string source;
+		std::set<std::string> identifiers;
+		std::map<std::string, std::string> keys;
+		std::map<std::string, std::unique_ptr<ShaderVariant>> variants;
+	};
+
+	ErrorCode RES_RENDERER_API CreateShaderVariants(const char* source, ShaderVariants* outVariants) {
+		if (source == nullptr)
+			return ErrorCode::INTERNAL_ERROR;
+		*outVariants = static_cast<ShaderVariants>(new ShaderVariantsImpl(source));
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API GetShaderVariant(ShaderVariants variants, const char* keywords, Shader* outShader,
+		char* compileErrorLog, size_t compileErrorMaxLength, size_t* compileErrorLength) {
+		auto pVariants = static_cast<ShaderVariantsImpl*>(variants);
+		std::string key;
+		auto t = pVariants->Resolve(keywords, &key);
+		if (t != ErrorCode::RES_NO_ERROR)
+			return t;
+		pVariants->stats.lookups++;
+		auto& variant = pVariants->Get(key, false);
+		pVariants->Wait(variant);
+
+		size_t length = 0;
+		if (variant.status == ShaderCompileStatus::Failed && compileErrorLog != nullptr && compileErrorMaxLength > 0) {
+			length = std::min(variant.log.size(), compileErrorMaxLength - 1);
+			variant.log.copy(compileErrorLog, length);
+			compileErrorLog[length] = '\0';
+		}
+		if (compileErrorLength != nullptr)
+			*compileErrorLength = length;
+		if (variant.status == ShaderCompileStatus::Failed)
+			return ErrorCode::INTERNAL_ERROR;
+		*outShader = variant.shader;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API PrewarmShaderVariants(ShaderVariants variants, const char* const* keywordSets, int count) {
+		auto pVariants = static_cast<ShaderVariantsImpl*>(variants);
+		for (int i = 0; i < count; i++)
+		{
+			std::string key;
+			auto t = pVariants->Resolve(keywordSets[i], &key);
+			if (t != ErrorCode::RES_NO_ERROR)
+				return t;
+			pVariants->Get(key, true);
+		}
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API PollShaderVariants(ShaderVariants variants, int* outPending) {
+		*outPending = static_cast<ShaderVariantsImpl*>(variants)->Pending();
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API GetShaderVariantStats(ShaderVariants variants, ShaderVariantStats* outStats) {
+		*outStats = static_cast<ShaderVariantsImpl*>(variants)->stats;
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	ErrorCode RES_RENDERER_API DestroyShaderVariants(ShaderVariants variants) {
+		//Waits for prewarmed compiles, shaders can't be destroyed while compiling.
+		delete static_cast<ShaderVariantsImpl*>(variants);
+		return ErrorCode::RES_NO_ERROR;
+	}
+}
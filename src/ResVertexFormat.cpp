@@ -0,0 +1,346 @@
+#include <ResVertexFormat.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define RES_VERTEX_PACK_AVX2
+#endif
+
+//Backend independent. Conversions round to nearest even and clamp to the format's range(NaN becomes its lowest value,
+//half floats keep NaN), the vectorized kernels give the same bytes as the scalar ones. Kernels work on flat component streams,
+//interleaved destinations go through a small chunk buffer.
+
+namespace ResRenderer {
+
+	//Integer formats: clamped to [lo, hi], scaled, rounded.
+	struct IntegerRange {
+		float lo, hi, scale;
+	};
+
+	static IntegerRange GetIntegerRange(int bits, bool isSigned, bool normalize) {
+		float max = static_cast<float>((1 << (isSigned ? bits - 1 : bits)) - 1);
+		if (normalize)
+			return IntegerRange{ isSigned ? -1.0f : 0.0f, 1.0f, max };
+		return IntegerRange{ isSigned ? -max - 1.0f : 0.0f, max, 1.0f };
+	}
+
+	static int PackInteger(float f, const IntegerRange& range) {
+		f = f > range.lo ? f : range.lo;
+		f = f < range.hi ? f : range.hi;
+		return static_cast<int>(std::nearbyint(f * range.scale));
+	}
+
+	static float UnpackInteger(int i, const IntegerRange& range) {
+		//GL maps the most negative value to -1 too.
+		float f = i / range.scale;
+		return f > range.lo ? f : range.lo;
+	}
+
+	//Round to nearest even, overflow becomes infinity. NaN is quieted and keeps the top of its payload, like F16C.
+	static std::uint16_t FloatToHalf(float f) {
+		std::uint32_t x;
+		memcpy(&x, &f, sizeof(x));
+		std::uint16_t sign = static_cast<std::uint16_t>((x >> 16) & 0x8000);
+		x &= 0x7FFFFFFF;
+		if (x >= 0x47800000)
+			return sign | (x > 0x7F800000 ? static_cast<std::uint16_t>(0x7E00 | ((x >> 13) & 0x3FF)) : 0x7C00);
+		if (x < 0x38800000) {
+			//Subnormal half, let float addition do the rounding.
+			const std::uint32_t magicBits = 0x3F000000;
+			float magic;
+			memcpy(&magic, &magicBits, sizeof(magic));
+			float t;
+			memcpy(&t, &x, sizeof(t));
+			t += magic;
+			memcpy(&x, &t, sizeof(x));
+			return sign | static_cast<std::uint16_t>(x - magicBits);
+		}
+		std::uint32_t odd = (x >> 13) & 1;
+		x += 0xC8000FFF + odd;
+		return sign | static_cast<std::uint16_t>(x >> 13);
+	}
+
+	static float HalfToFloat(std::uint16_t h) {
+		std::uint32_t sign = static_cast<std::uint32_t>(h & 0x8000) << 16;
+		std::uint32_t exponent = (h >> 10) & 0x1F;
+		std::uint32_t mantissa = h & 0x3FF;
+		if (exponent == 0) {
+			float f = std::ldexp(static_cast<float>(mantissa), -24);
+			return sign != 0 ? -f : f;
+		}
+		std::uint32_t x = sign | (exponent == 0x1F ? 0x7F800000 | (mantissa << 13) : ((exponent + 112) << 23) | (mantissa << 13));
+		float f;
+		memcpy(&f, &x, sizeof(f));
+		return f;
+	}
+
+	static const int PackedShifts[] = { 0, 10, 20, 30 };
+	static const int PackedBits[] = { 10, 10, 10, 2 };
+
+	//Kernels return how many components(vertices for PackPacked) they converted, scalar code does the rest.
+#ifdef RES_VERTEX_PACK_AVX2
+	static bool HasAVX2() {
+		static const bool has = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+		return has;
+	}
+
+	__attribute__((target("avx2,f16c")))
+	static size_t PackHalfAVX2(const float* src, size_t n, std::uint16_t* dst) {
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+		return i;
+	}
+
+	__attribute__((target("avx2")))
+	static inline __m256i ConvertAVX2(const float* src, __m256 lo, __m256 hi, __m256 scale) {
+		//max returns its second operand for NaN, so NaN clamps to lo like PackInteger.
+		auto x = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src), lo), hi);
+		return _mm256_cvtps_epi32(_mm256_mul_ps(x, scale));
+	}
+
+	//16 floats to 16 int16 in order, packs works within 128 bit lanes.
+	__attribute__((target("avx2")))
+	static inline __m256i ConvertShortsAVX2(const float* src, __m256 lo, __m256 hi, __m256 scale) {
+		auto packed = _mm256_packs_epi32(ConvertAVX2(src, lo, hi, scale), ConvertAVX2(src + 8, lo, hi, scale));
+		return _mm256_permute4x64_epi64(packed, 0xD8);
+	}
+
+	__attribute__((target("avx2")))
+	static size_t PackShortAVX2(const float* src, size_t n, const IntegerRange& range, std::int16_t* dst) {
+		auto lo = _mm256_set1_ps(range.lo), hi = _mm256_set1_ps(range.hi), scale = _mm256_set1_ps(range.scale);
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16)
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), ConvertShortsAVX2(src + i, lo, hi, scale));
+		return i;
+	}
+
+	__attribute__((target("avx2")))
+	static size_t PackByteAVX2(const float* src, size_t n, const IntegerRange& range, bool isSigned, std::uint8_t* dst) {
+		auto lo = _mm256_set1_ps(range.lo), hi = _mm256_set1_ps(range.hi), scale = _mm256_set1_ps(range.scale);
+		size_t i = 0;
+		for (; i + 32 <= n; i += 32)
+		{
+			auto a = ConvertShortsAVX2(src + i, lo, hi, scale);
+			auto b = ConvertShortsAVX2(src + i + 16, lo, hi, scale);
+			auto packed = isSigned ? _mm256_packs_epi16(a, b) : _mm256_packus_epi16(a, b);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permute4x64_epi64(packed, 0xD8));
+		}
+		return i;
+	}
+
+	//Two vertices per iteration, each 4 lane group is or-ed together after shifting its components in place.
+	__attribute__((target("avx2")))
+	static size_t PackPackedAVX2(const float* src, size_t vertCount, const IntegerRange* ranges, std::uint32_t* dst) {
+		auto lo = _mm256_setr_ps(ranges[0].lo, ranges[1].lo, ranges[2].lo, ranges[3].lo, ranges[0].lo, ranges[1].lo, ranges[2].lo, ranges[3].lo);
+		auto hi = _mm256_setr_ps(ranges[0].hi, ranges[1].hi, ranges[2].hi, ranges[3].hi, ranges[0].hi, ranges[1].hi, ranges[2].hi, ranges[3].hi);
+		auto scale = _mm256_setr_ps(ranges[0].scale, ranges[1].scale, ranges[2].scale, ranges[3].scale,
+			ranges[0].scale, ranges[1].scale, ranges[2].scale, ranges[3].scale);
+		auto mask = _mm256_setr_epi32(0x3FF, 0x3FF, 0x3FF, 0x3, 0x3FF, 0x3FF, 0x3FF, 0x3);
+		auto shifts = _mm256_setr_epi32(0, 10, 20, 30, 0, 10, 20, 30);
+		size_t v = 0;
+		for (; v + 2 <= vertCount; v += 2)
+		{
+			auto x = _mm256_sllv_epi32(_mm256_and_si256(ConvertAVX2(src + v * 4, lo, hi, scale), mask), shifts);
+			x = _mm256_or_si256(x, _mm256_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+			x = _mm256_or_si256(x, _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+			dst[v] = static_cast<std::uint32_t>(_mm256_extract_epi32(x, 0));
+			dst[v + 1] = static_cast<std::uint32_t>(_mm256_extract_epi32(x, 4));
+		}
+		return v;
+	}
+#endif
+
+	static void PackHalf(const float* src, size_t n, std::uint16_t* dst) {
+		size_t i = 0;
+#ifdef RES_VERTEX_PACK_AVX2
+		if (HasAVX2())
+			i = PackHalfAVX2(src, n, dst);
+#endif
+		for (; i < n; i++)
+			dst[i] = FloatToHalf(src[i]);
+	}
+
+	static void PackShort(const float* src, size_t n, const IntegerRange& range, std::int16_t* dst) {
+		size_t i = 0;
+#ifdef RES_VERTEX_PACK_AVX2
+		if (HasAVX2())
+			i = PackShortAVX2(src, n, range, dst);
+#endif
+		for (; i < n; i++)
+			dst[i] = static_cast<std::int16_t>(PackInteger(src[i], range));
+	}
+
+	static void PackByte(const float* src, size_t n, const IntegerRange& range, bool isSigned, std::uint8_t* dst) {
+		size_t i = 0;
+#ifdef RES_VERTEX_PACK_AVX2
+		if (HasAVX2())
+			i = PackByteAVX2(src, n, range, isSigned, dst);
+#endif
+		for (; i < n; i++)
+			dst[i] = static_cast<std::uint8_t>(PackInteger(src[i], range));
+	}
+
+	static void PackPacked(const float* src, size_t vertCount, bool normalize, std::uint32_t* dst) {
+		IntegerRange ranges[4];
+		for (int c = 0; c < 4; c++)
+			ranges[c] = GetIntegerRange(PackedBits[c], true, normalize);
+		size_t v = 0;
+#ifdef RES_VERTEX_PACK_AVX2
+		if (HasAVX2())
+			v = PackPackedAVX2(src, vertCount, ranges, dst);
+#endif
+		for (; v < vertCount; v++)
+		{
+			std::uint32_t packed = 0;
+			for (int c = 0; c < 4; c++)
+			{
+				auto bits = static_cast<std::uint32_t>(PackInteger(src[v * 4 + c], ranges[c])) & ((1u << PackedBits[c]) - 1);
+				packed |= bits << PackedShifts[c];
+			}
+			dst[v] = packed;
+		}
+	}
+
+	//Tightly packed destination.
+	static void PackComponents(const VertexAttribDescription& desc, const float* src, size_t vertCount, void* dst) {
+		auto n = vertCount * desc.count;
+		switch (desc.type)
+		{
+		case VertexAttribType::ResFloat:
+			memcpy(dst, src, n * sizeof(float));
+			break;
+		case VertexAttribType::ResHalfFloat:
+			PackHalf(src, n, static_cast<std::uint16_t*>(dst));
+			break;
+		case VertexAttribType::ResShort:
+			PackShort(src, n, GetIntegerRange(16, true, desc.normalize), static_cast<std::int16_t*>(dst));
+			break;
+		case VertexAttribType::ResUnsignedByte:
+			PackByte(src, n, GetIntegerRange(8, false, desc.normalize), false, static_cast<std::uint8_t*>(dst));
+			break;
+		case VertexAttribType::ResByte:
+			PackByte(src, n, GetIntegerRange(8, true, desc.normalize), true, static_cast<std::uint8_t*>(dst));
+			break;
+		case VertexAttribType::ResInt10_10_10_2:
+			PackPacked(src, vertCount, desc.normalize, static_cast<std::uint32_t*>(dst));
+			break;
+		default:
+			break;
+		}
+	}
+
+	//Fixed size copies compile to single moves, a memcpy call per vertex would cost more than the conversion.
+	template<size_t Size>
+	static void Scatter(const unsigned char* chunk, size_t count, unsigned char* out, size_t stride) {
+		for (size_t v = 0; v < count; v++)
+			memcpy(out + v * stride, chunk + v * Size, Size);
+	}
+
+	static void Scatter(const unsigned char* chunk, size_t count, size_t size, unsigned char* out, size_t stride) {
+		switch (size)
+		{
+		case 2:
+			Scatter<2>(chunk, count, out, stride);
+			break;
+		case 4:
+			Scatter<4>(chunk, count, out, stride);
+			break;
+		case 8:
+			Scatter<8>(chunk, count, out, stride);
+			break;
+		case 12:
+			Scatter<12>(chunk, count, out, stride);
+			break;
+		case 16:
+			Scatter<16>(chunk, count, out, stride);
+			break;
+		default:
+			for (size_t v = 0; v < count; v++)
+				memcpy(out + v * stride, chunk + v * size, size);
+			break;
+		}
+	}
+
+	ErrorCode RES_RENDERER_API PackVertexAttrib(const VertexAttribDescription* desc, const float* src, size_t vertCount, void* dst, size_t dstStride) {
+		auto size = desc->count * GetVertexAttribSize(desc->type);
+		if (desc->count < 1 || desc->count > 4 || size == 0 || (desc->type == VertexAttribType::ResInt10_10_10_2 && desc->count != 4))
+			return ErrorCode::MESH_DATA_BROKEN;
+		if (dstStride != 0 && dstStride < size)
+			return ErrorCode::MESH_DATA_BROKEN;
+		if (dstStride == 0 || dstStride == size) {
+			PackComponents(*desc, src, vertCount, dst);
+			return ErrorCode::RES_NO_ERROR;
+		}
+
+		const size_t chunkVertices = 256;
+		unsigned char chunk[chunkVertices * 4 * sizeof(float)];
+		auto out = static_cast<unsigned char*>(dst);
+		for (size_t first = 0; first < vertCount; first += chunkVertices)
+		{
+			auto count = std::min(chunkVertices, vertCount - first);
+			PackComponents(*desc, src + first * desc->count, count, chunk);
+			Scatter(chunk, count, size, out + first * dstStride, dstStride);
+		}
+		return ErrorCode::RES_NO_ERROR;
+	}
+
+	void UnpackVertexAttrib(const VertexAttribDescription& desc, const void* src, float* out) {
+		switch (desc.type)
+		{
+		case VertexAttribType::ResFloat:
+			memcpy(out, src, desc.count * sizeof(float));
+			break;
+		case VertexAttribType::ResHalfFloat:
+			for (int c = 0; c < desc.count; c++)
+			{
+				std::uint16_t h;
+				memcpy(&h, static_cast<const unsigned char*>(src) + c * sizeof(h), sizeof(h));
+				out[c] = HalfToFloat(h);
+			}
+			break;
+		case VertexAttribType::ResShort:
+		{
+			auto range = GetIntegerRange(16, true, desc.normalize);
+			for (int c = 0; c < desc.count; c++)
+			{
+				std::int16_t i;
+				memcpy(&i, static_cast<const unsigned char*>(src) + c * sizeof(i), sizeof(i));
+				out[c] = UnpackInteger(i, range);
+			}
+			break;
+		}
+		case VertexAttribType::ResUnsignedByte:
+		{
+			auto range = GetIntegerRange(8, false, desc.normalize);
+			for (int c = 0; c < desc.count; c++)
+				out[c] = UnpackInteger(static_cast<const std::uint8_t*>(src)[c], range);
+			break;
+		}
+		case VertexAttribType::ResByte:
+		{
+			auto range = GetIntegerRange(8, true, desc.normalize);
+			for (int c = 0; c < desc.count; c++)
+				out[c] = UnpackInteger(static_cast<const std::int8_t*>(src)[c], range);
+			break;
+		}
+		case VertexAttribType::ResInt10_10_10_2:
+		{
+			std::uint32_t packed;
+			memcpy(&packed, src, sizeof(packed));
+			for (int c = 0; c < 4; c++)
+			{
+				//Sign extends the field.
+				auto bits = PackedBits[c];
+				auto field = static_cast<std::int32_t>(packed << (32 - bits - PackedShifts[c])) >> (32 - bits);
+				out[c] = UnpackInteger(field, GetIntegerRange(bits, true, desc.normalize));
+			}
+			break;
+		}
+		default:
+			break;
+		}
+	}
+}
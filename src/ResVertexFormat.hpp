@@ -0,0 +1,8 @@
+#pragma once
+#include <ResRenderer.hpp>
+
+namespace ResRenderer {
+
+	//Reads one attribute of one vertex as floats the way GL would, to out[0, desc.count).
+	void UnpackVertexAttrib(const VertexAttribDescription& desc, const void* src, float* out);
+}
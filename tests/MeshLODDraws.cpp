@@ -0,0 +1,90 @@
+#include <ResRenderer.hpp>
+#include <ResRendererNull.hpp>
+#include <cmath>
+#include <vector>
+#include "ResTest.hpp"
+
+using namespace std;
+using namespace ResRenderer;
+
+//Draws other than DrawMeshLOD must keep to the full mesh of a mesh uploaded with UploadMeshDataWithLODs, not every level
+//stored after it. Null backend only, it counts drawn indices.
+
+static const int Side = 64;
+
+static unsigned long long DrawnIndices() {
+	NullBackendStats stats;
+	GetNullBackendStats(&stats);
+	ResetNullBackendStats();
+	return stats.drawnIndices;
+}
+
+int main() {
+	Init();
+
+	//Bumpy grid, so there is something to simplify.
+	vector<float> vertices;
+	for (int y = 0; y <= Side; y++)
+	{
+		for (int x = 0; x <= Side; x++)
+		{
+			vertices.push_back(static_cast<float>(x));
+			vertices.push_back(0.3f * sin(x * 0.4f) * cos(y * 0.3f));
+			vertices.push_back(static_cast<float>(y));
+		}
+	}
+	vector<VertexIndex_t> indicies;
+	for (int y = 0; y < Side; y++)
+	{
+		for (int x = 0; x < Side; x++)
+		{
+			VertexIndex_t i = y * (Side + 1) + x;
+			VertexIndex_t quad[] = { i, i + Side + 1, i + 1, i + 1, i + Side + 1, i + Side + 2 };
+			indicies.insert(indicies.end(), quad, quad + 6);
+		}
+	}
+	MeshData meshData;
+	MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 3, false);
+	meshData.data = vertices.data();
+	meshData.dataSize = vertices.size() * sizeof(float);
+	meshData.vertCount = static_cast<int>(vertices.size() / 3);
+	meshData.indicies = indicies.data();
+	meshData.indiciesCount = indicies.size();
+
+	Mesh mesh;
+	CreateMesh(&mesh);
+	Expect(UploadMeshDataWithLODs(mesh, &meshData) == ErrorCode::RES_NO_ERROR, "UploadMeshDataWithLODs");
+	auto full = static_cast<unsigned long long>(indicies.size());
+	ResetNullBackendStats();
+
+	DrawMeshLOD(mesh, 1e6f);
+	Expect(DrawnIndices() == full, "DrawMeshLOD at full detail draws the full mesh");
+	DrawMeshLOD(mesh, 1.0f);
+	Expect(DrawnIndices() < full, "DrawMeshLOD far away draws a simplified level");
+
+	DrawMesh(mesh);
+	Expect(DrawnIndices() == full, "DrawMesh draws the full mesh only");
+
+	InstanceData instanceData;
+	InstanceDataAppendAttrib(&instanceData, VertexAttribType::ResFloat, 4, false);
+	float offsets[8] = {};
+	instanceData.data = offsets;
+	instanceData.dataSize = sizeof(offsets);
+	instanceData.instanceCount = 2;
+	InstanceBuffer instances;
+	CreateInstanceBuffer(&instances);
+	UploadInstanceData(instances, &instanceData);
+	ResetNullBackendStats();
+	DrawMeshInstanced(mesh, instances, 2);
+	Expect(DrawnIndices() == full * 2, "DrawMeshInstanced draws the full mesh only");
+
+	IndexRange inside = { 0, static_cast<unsigned int>(full) };
+	Expect(DrawMeshRanges(mesh, &inside, 1) == ErrorCode::RES_NO_ERROR, "DrawMeshRanges over the full mesh");
+	IndexRange past = { static_cast<unsigned int>(full), 3 };
+	Expect(DrawMeshRanges(mesh, &past, 1) == ErrorCode::MESH_DATA_LENGTH_ERROR, "DrawMeshRanges past the full mesh fails");
+
+	DestroyInstanceBuffer(instances);
+	DestroyMesh(mesh);
+	Terminate();
+	return TestResult();
+}
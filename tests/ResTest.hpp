@@ -0,0 +1,20 @@
+#pragma once
+#include <iostream>
+
+//Checks shared by the tests, every test is an executable of its own. Expect reports a failed check and carries on,
+//main ends with return TestResult().
+
+static int failures = 0;
+
+static inline void Expect(bool condition, const char* what) {
+	if (!condition) {
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+static inline int TestResult() {
+	if (failures == 0)
+		std::cout << "passed" << std::endl;
+	return failures == 0 ? 0 : 1;
+}
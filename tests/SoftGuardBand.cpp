@@ -0,0 +1,72 @@
+#include <ResRenderer.hpp>
+#include <ResRendererSoftware.hpp>
+#include <iostream>
+#include <vector>
+#include "ResTest.hpp"
+
+using namespace std;
+using namespace ResRenderer;
+
+//Near horizontal edges of triangles reaching out to the guard band, like the horizon of a ground plane, must still
+//cover the viewport. Software backend only, it counts covered pixels.
+
+static const int Side = 256;
+
+//Draws one triangle with clip space corners at w = 1 and returns the covered pixel count.
+static unsigned long long CoveredPixels(Window window, const float (&corners)[3][2]) {
+	vector<float> vertices;
+	vector<VertexIndex_t> indices;
+	for (int v = 0; v < 3; v++)
+	{
+		vertices.push_back(corners[v][0]);
+		vertices.push_back(corners[v][1]);
+		vertices.push_back(0.5f);
+		indices.push_back(static_cast<VertexIndex_t>(v));
+	}
+	MeshData meshData;
+	MeshDataAppendAttrib(&meshData, VertexAttribType::ResFloat, 3, false);
+	meshData.data = vertices.data();
+	meshData.dataSize = vertices.size() * sizeof(float);
+	meshData.vertCount = 3;
+	meshData.indicies = indices.data();
+	meshData.indiciesCount = indices.size();
+
+	Mesh mesh;
+	CreateMesh(&mesh);
+	UploadMeshData(mesh, &meshData);
+	Clear(Color(0.0f, 0.0f, 0.0f, 1.0f), ClearType::ColorAndDepth);
+	ResetRasterizerStats();
+	DrawMesh(mesh);
+	SwapBuffer(window);
+	RasterizerStats stats;
+	GetRasterizerStats(&stats);
+	DestroyMesh(mesh);
+	return stats.pixels;
+}
+
+int main() {
+	if (!Init()) {
+		cerr << "Init failed" << endl;
+		return 1;
+	}
+	Window window;
+	if (CreateResWindow(Side, Side, "SoftGuardBand", &window) != ErrorCode::RES_NO_ERROR) {
+		cerr << "Window creation failed" << endl;
+		return 1;
+	}
+
+	const unsigned long long all = static_cast<unsigned long long>(Side) * Side;
+	const float slanted[3][2] = { { -250.0f, -250.0f }, { 250.0f, -249.9995f }, { 0.0f, 250.0f } };
+	const float slantedReversed[3][2] = { { -250.0f, -250.0f }, { 0.0f, 250.0f }, { 250.0f, -249.9995f } };
+	const float steeper[3][2] = { { -250.0f, -250.0f }, { 250.0f, -249.99f }, { 0.0f, 250.0f } };
+	const float flat[3][2] = { { -250.0f, -250.0f }, { 250.0f, -250.0f }, { 0.0f, 250.0f } };
+	const float slantedDown[3][2] = { { -250.0f, 250.0f }, { 0.0f, -250.0f }, { 250.0f, 249.9995f } };
+	Expect(CoveredPixels(window, slanted) == all, "Near horizontal edge at the guard band covers the viewport");
+	Expect(CoveredPixels(window, slantedReversed) == all, "Near horizontal edge, other winding, covers the viewport");
+	Expect(CoveredPixels(window, steeper) == all, "Slanted edge at the guard band covers the viewport");
+	Expect(CoveredPixels(window, flat) == all, "Horizontal edge at the guard band covers the viewport");
+	Expect(CoveredPixels(window, slantedDown) == all, "Near horizontal top edge at the guard band covers the viewport");
+
+	Terminate();
+	return TestResult();
+}
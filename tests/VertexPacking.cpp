@@ -0,0 +1,64 @@
+#include <ResRenderer.hpp>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "ResTest.hpp"
+
+using namespace std;
+using namespace ResRenderer;
+
+//PackVertexAttrib converts whole groups with vector kernels where the CPU has them and the rest one by one, both must
+//write the same bytes, NaN included. CPU only, runs with any backend.
+
+static float FromBits(uint32_t x) {
+	float f;
+	memcpy(&f, &x, sizeof(f));
+	return f;
+}
+
+static VertexAttribDescription Describe(VertexAttribType type, bool normalize) {
+	MeshData t;
+	MeshDataAppendAttrib(&t, type, 1, normalize);
+	return t.attribDescriptions[0];
+}
+
+//Packs the values as one stream, then each value alone, which never reaches the vector kernels.
+static bool SameAsScalar(const VertexAttribDescription& desc, const vector<float>& values, size_t size) {
+	vector<unsigned char> whole(values.size() * size), single(size);
+	PackVertexAttrib(&desc, values.data(), values.size(), whole.data());
+	for (size_t i = 0; i < values.size(); i++)
+	{
+		PackVertexAttrib(&desc, &values[i], 1, single.data());
+		if (memcmp(single.data(), &whole[i * size], size) != 0)
+			return false;
+	}
+	return true;
+}
+
+int main() {
+	const float quietNaN = FromBits(0x7FC00000), payloadNaN = FromBits(0x7FC02000);
+	const float signalingNaN = FromBits(0x7F802000), negativeNaN = FromBits(0xFFC00000), lowPayloadNaN = FromBits(0x7F800001);
+	vector<float> values;
+	for (int i = 0; i < 4; i++)
+	{
+		float group[] = { quietNaN, payloadNaN, signalingNaN, negativeNaN, lowPayloadNaN, -0.5f, 1.0f, 70000.0f };
+		values.insert(values.end(), group, group + 8);
+	}
+
+	auto half = Describe(VertexAttribType::ResHalfFloat, false);
+	Expect(SameAsScalar(half, values, sizeof(uint16_t)), "Half floats match the scalar path");
+	Expect(SameAsScalar(Describe(VertexAttribType::ResShort, true), values, sizeof(int16_t)), "snorm16 matches the scalar path");
+	Expect(SameAsScalar(Describe(VertexAttribType::ResUnsignedByte, true), values, sizeof(uint8_t)), "unorm8 matches the scalar path");
+	Expect(SameAsScalar(Describe(VertexAttribType::ResByte, true), values, sizeof(int8_t)), "snorm8 matches the scalar path");
+
+	uint16_t packed[8];
+	PackVertexAttrib(&half, values.data(), 8, packed);
+	Expect(packed[0] == 0x7E00, "Quiet NaN packs to the quiet half NaN");
+	Expect(packed[1] == 0x7E01, "NaN keeps the top of its payload");
+	Expect(packed[2] == 0x7E01, "Signaling NaN is quieted");
+	Expect(packed[3] == 0xFE00, "NaN keeps its sign");
+	Expect(packed[4] == 0x7E00, "NaN with only low payload bits stays NaN");
+	Expect(packed[7] == 0x7C00, "Overflow packs to infinity");
+
+	return TestResult();
+}